@@ -1,145 +1,531 @@
 #include "alarms.h"
 #include "metrics.h"
+#include "snapshot.h"
 #include "config.h"
 #include <syslog.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <fnmatch.h>
 
-#include "fanmonitor.h"
-
-/* SNMP 관련 헤더 */
-#include <net-snmp/net-snmp-config.h>
-#include <net-snmp/net-snmp-includes.h>
+#include "trapq.h"
+#include "rules.h"
 
 #define RAID_OID ".1.3.6.1.4.1.8072.2.3.0.9"
 #define SSD0_OID ".1.3.6.1.4.1.8072.2.3.0.10"
 #define SSD1_OID ".1.3.6.1.4.1.8072.2.3.0.11"
 #define FAN_OID  ".1.3.6.1.4.1.8072.2.3.0.8"
 #define POWER_OID ".1.3.6.1.4.1.8072.2.3.0.7"
+#define RAID_PROBE_OID ".1.3.6.1.4.1.8072.2.3.0.21"
+#define PD_OID ".1.3.6.1.4.1.8072.2.3.0.22"
+#define PD_PREDICTIVE_OID ".1.3.6.1.4.1.8072.2.3.0.23"
+#define MOUNT_RO_OID ".1.3.6.1.4.1.8072.2.3.0.15"
+#define SENSOR_OID ".1.3.6.1.4.1.8072.2.3.0.24"
+#define HW_HELPER_OID ".1.3.6.1.4.1.8072.2.3.0.25"
+#define AER_OID ".1.3.6.1.4.1.8072.2.3.0.26"
+#define EDAC_OID ".1.3.6.1.4.1.8072.2.3.0.27"
+#define SCSI_IOERR_OID ".1.3.6.1.4.1.8072.2.3.0.28"
+
+/* 알람 상태. OK -> PENDING (ALARM_TRIGGER_SAMPLES번 연속) -> RAISED -> CLEARING (ALARM_CLEAR_SAMPLES번 연속) -> OK.
+   syslog와 트랩은 RAISED로 갈 때, warning에서 critical로 올라갈 때, OK로 돌아갈 때,
+   ALARM_RENOTIFY_PERIOD마다 한 번씩만 보낸다 */
+enum { ALARM_STATE_OK = 0, ALARM_STATE_PENDING, ALARM_STATE_RAISED, ALARM_STATE_CLEARING };
+enum { ALARM_NONE = 0, ALARM_RAISE, ALARM_CLEAR, ALARM_REPEAT, ALARM_ESCALATE };
+
+#define MAX_ALARM_ENTRIES 256
+
+/* 알람 OID와 대상(마운트, 장치, 인터페이스 등)마다 하나. OK가 되면 지운다 */
+typedef struct {
+    char oid[64];                 /* 규칙은 설정을 다시 읽으면 바뀌므로 복사해 둔다 */
+    char instance[128];
+    int state;                    /* ALARM_STATE_* */
+    int severity;                 /* RULE_LEVEL_*. 발생 중에는 올라가기만 한다 */
+    int count;                    /* 현재 상태에서 연속으로 본 샘플 수 */
+    unsigned long id;             /* RAISED가 될 때 정한다. 해제 트랩도 같은 ID */
+    time_t last_notify;
+    unsigned long seen;           /* 마지막으로 판정한 검사 번호 (cycle) */
+    char name[48];                /* 대상이 사라져 해제할 때 쓰는 알람 이름 */
+} alarm_entry_t;
+
+static alarm_entry_t entries[MAX_ALARM_ENTRIES];
+static int entry_count;
+static unsigned long next_alarm_id;
+static time_t cycle_time;             /* 이번 검사의 스냅샷 시각 */
+static unsigned long cycle;           /* 검사 번호 */
 
-/* SNMP 트랩 전송 함수 (SNMPv2c, 커뮤니티 "public") */
-void send_snmp_trap(const char *trap_oid, const char *message) {
-    if (global_config.snmp_trap_enable != 1){
+/* 보고 주기 동안 모은 알람. 주기가 끝나면 한 TRAP2로 큐에 넣는다 */
+static TrapAlarm pending[TRAP_BATCH_MAX];
+static int pending_count;
+
+static void flush_traps(void) {
+    if (pending_count == 0)
         return;
-    }
-    
-    char dest[128];
-    snprintf(dest, sizeof(dest), "%s:%d", global_config.snmp_trap_dest, global_config.snmp_trap_port);
-
-    struct snmp_session session, *ss;
-    struct snmp_pdu *pdu;
-    oid objid[MAX_OID_LEN];
-    size_t objid_len = MAX_OID_LEN;
-
-    snmp_sess_init(&session);
-    /* 매크로로 정의된 대상 주소 사용 */
-    session.peername = strdup(dest);
-    session.version = SNMP_VERSION_2c;
-    session.community = (u_char *)global_config.snmp_trap_community;
-    session.community_len = strlen(global_config.snmp_trap_community);
-
-    ss = snmp_open(&session);
-    if (!ss) {
-        snmp_perror("snmp_open");
-        free(session.peername);
+    trapq_send(pending, pending_count);
+    pending_count = 0;
+}
+
+/* 보낼 알람 자리를 잡는다. 가득 차면 먼저 보낸다 */
+static TrapAlarm *queue_trap(const char *trap_oid, const char *message) {
+    if (global_config.snmp_trap_enable != 1)
+        return NULL;
+    if (pending_count >= TRAP_BATCH_MAX)
+        flush_traps();
+    TrapAlarm *t = &pending[pending_count++];
+    snprintf(t->oid, sizeof(t->oid), "%s", trap_oid);
+    snprintf(t->message, sizeof(t->message), "%s", message);
+    t->type = TRAP_VALUE_NONE;
+    t->alarm_id = 0;
+    t->alarm_state = NULL;
+    t->severity = NULL;
+    return t;
+}
+
+static unsigned long to_gauge(double v) {
+    if (v <= 0)
+        return 0;
+    if (v >= 4294967295.0)
+        return 4294967295UL;
+    return (unsigned long)(v + 0.5);
+}
+
+/* 숫자 측정값과 임계치는 Gauge32 (반올림) */
+static void send_snmp_trap_value(const char *trap_oid, const char *message, double value, double threshold) {
+    TrapAlarm *t = queue_trap(trap_oid, message);
+    if (!t)
         return;
+    t->type = TRAP_VALUE_GAUGE;
+    t->value = to_gauge(value);
+    t->threshold = to_gauge(threshold);
+}
+
+/* 주기 검사와 별개로 이벤트가 발생한 즉시 알람을 보낸다 (syslog + SNMP 트랩) */
+void raise_event_alarm(const char *trap_oid, const char *trap_message, const char *fmt, ...) {
+    if (global_config.syslog_enable) {
+        va_list ap;
+        va_start(ap, fmt);
+        vsyslog(LOG_ALERT, fmt, ap);
+        va_end(ap);
     }
-    free(session.peername);
+    /* 보고 주기 밖에서 불리므로 모아 둔 것 없이 바로 큐에 넣는다 */
+    queue_trap(trap_oid, trap_message);
+    flush_traps();
+}
 
-    pdu = snmp_pdu_create(SNMP_MSG_TRAP2);
-    if (!snmp_parse_oid(trap_oid, objid, &objid_len)) {
-        snmp_perror(trap_oid);
-        snmp_close(ss);
-        return;
+static alarm_entry_t *find_entry(const char *oid, const char *instance) {
+    for (int i = 0; i < entry_count; i++)
+        if (strcmp(entries[i].oid, oid) == 0 && strcmp(entries[i].instance, instance) == 0)
+            return &entries[i];
+    return NULL;
+}
+
+static alarm_entry_t *add_entry(const char *oid, const char *instance) {
+    if (entry_count >= MAX_ALARM_ENTRIES) {
+        syslog(LOG_WARNING, "Too many active alarms, ignoring %s %s", oid, instance);
+        return NULL;
     }
-    snmp_add_var(pdu, objid, objid_len, 's', message);
+    alarm_entry_t *e = &entries[entry_count++];
+    memset(e, 0, sizeof(*e));
+    snprintf(e->oid, sizeof(e->oid), "%s", oid);
+    snprintf(e->instance, sizeof(e->instance), "%s", instance);
+    return e;
+}
 
-    if (snmp_send(ss, pdu) == 0) {
-        snmp_free_pdu(pdu);
+static void remove_entry(alarm_entry_t *e) {
+    *e = entries[--entry_count];
+}
+
+/* 재시작 뒤에도 NMS에서 ID가 겹치지 않도록 시작 시각에서 센다 */
+static unsigned long new_alarm_id(void) {
+    if (next_alarm_id == 0)
+        next_alarm_id = (unsigned long)time(NULL) & 0x7fffffff;
+    return ++next_alarm_id;
+}
+
+static int renotify_due(alarm_entry_t *e) {
+    if (global_config.alarm_renotify_period <= 0 ||
+        difftime(cycle_time, e->last_notify) < global_config.alarm_renotify_period)
+        return ALARM_NONE;
+    e->last_notify = cycle_time;
+    return ALARM_REPEAT;
+}
+
+/* 발생 중인 알람: 단계가 올라갔으면 바로, 아니면 다시 알릴 때가 됐을 때만 알린다 */
+static int still_raised(alarm_entry_t *e, int level) {
+    if (level > e->severity) {
+        e->severity = level;
+        e->last_notify = cycle_time;
+        return ALARM_ESCALATE;
     }
-    snmp_close(ss);
+    return renotify_due(e);
 }
 
-/* 알람 조건 검사 및 알람 전송 */
-void check_and_alarm(void) {
-    float cpu_usage = get_cpu_usage();
-    float mem_usage = get_memory_usage();
-    float disk_usage = get_disk_usage();
-    float cpu_temp = get_cpu_temperature();
-    float rx_rate = 0, tx_rate = 0;
-    get_network_traffic(&rx_rate, &tx_rate);
+/* 샘플 하나를 상태에 반영한다. level: 발생 조건을 만족한 단계 (RULE_LEVEL_*, 0이면 정상),
+   cleared: 해제 조건 (히스테리시스로 level == 0이면서 거짓일 수 있다).
+   알려야 할 변화가 있으면 ALARM_RAISE/CLEAR/REPEAT/ESCALATE와 함께 *entry를 돌려준다 */
+static int alarm_step(const char *oid, const char *instance, int level, int cleared, alarm_entry_t **entry) {
+    alarm_entry_t *e = find_entry(oid, instance);
+    if (!e) {
+        if (!level || !(e = add_entry(oid, instance)))
+            return ALARM_NONE;
+    }
+    *entry = e;
+    e->seen = cycle;
 
-    if (cpu_usage > global_config.cpu_usage_threshold) {
-        if (global_config.syslog_enable)
-            syslog(LOG_ALERT, "ALARM: CPU usage high: %.1f%%", cpu_usage);
-        send_snmp_trap(".1.3.6.1.4.1.8072.2.3.0.1", "CPU usage high alarm triggered");
+    switch (e->state) {
+    case ALARM_STATE_OK:
+        e->state = ALARM_STATE_PENDING;
+        e->count = 0;
+        /* fall through */
+    case ALARM_STATE_PENDING:
+        if (!level) {
+            remove_entry(e);
+            return ALARM_NONE;
+        }
+        if (++e->count < global_config.alarm_trigger_samples)
+            return ALARM_NONE;
+        e->state = ALARM_STATE_RAISED;
+        e->severity = level;
+        e->id = new_alarm_id();
+        e->last_notify = cycle_time;
+        return ALARM_RAISE;
+    case ALARM_STATE_RAISED:
+        if (!cleared)
+            return still_raised(e, level);
+        e->state = ALARM_STATE_CLEARING;
+        e->count = 0;
+        /* fall through */
+    case ALARM_STATE_CLEARING:
+        if (!cleared) {
+            e->state = ALARM_STATE_RAISED;
+            return still_raised(e, level);
+        }
+        if (++e->count < global_config.alarm_clear_samples)
+            return ALARM_NONE;
+        /* 트랩을 만들 때까지 ID가 필요하므로 지우는 건 notify_transition()에서 */
+        e->state = ALARM_STATE_OK;
+        return ALARM_CLEAR;
     }
-    if (mem_usage > global_config.mem_usage_threshold) {
-        if (global_config.syslog_enable)
-            syslog(LOG_ALERT, "ALARM: Memory usage high: %.1f%%", mem_usage);
-        send_snmp_trap(".1.3.6.1.4.1.8072.2.3.0.2", "Memory usage high alarm triggered");
+    return ALARM_NONE;
+}
+
+/* 상태가 바뀐 알람을 syslog로 남기고 트랩 자리를 잡는다. 값은 호출한 쪽이 채운다 (트랩을 안 보내면 NULL) */
+static TrapAlarm *notify_transition(int tr, alarm_entry_t *e, const char *name, const char *detail) {
+    static const char *const trap_suffix[] = { "", "alarm triggered", "alarm cleared", "alarm still active",
+                                               "alarm escalated" };
+    static const char *const state_names[] = { "", "raised", "cleared", "repeat", "escalated" };
+    static const char *const severity_names[] = { "", "warning", "critical" };
+    char message[128];
+
+    if (global_config.syslog_enable) {
+        int priority = (e->severity == RULE_LEVEL_WARNING) ? LOG_WARNING : LOG_ALERT;
+        const char *tag = (e->severity == RULE_LEVEL_WARNING) ? "WARNING" : "ALARM";
+        if (tr == ALARM_CLEAR)
+            syslog(LOG_NOTICE, "CLEAR: %s: %s (alarm %lu)", name, detail, e->id);
+        else if (tr == ALARM_REPEAT)
+            syslog(priority, "%s: %s: %s (alarm %lu still active)", tag, name, detail, e->id);
+        else
+            syslog(priority, "%s: %s: %s (alarm %lu)", tag, name, detail, e->id);
     }
-    if (disk_usage > global_config.disk_usage_threshold) {
-        if (global_config.syslog_enable)
-            syslog(LOG_ALERT, "ALARM: Disk usage high: %.1f%%", disk_usage);
-        send_snmp_trap(".1.3.6.1.4.1.8072.2.3.0.3", "Disk usage high alarm triggered");
+    snprintf(e->name, sizeof(e->name), "%s", name);
+    snprintf(message, sizeof(message), "%s %s", name, trap_suffix[tr]);
+    TrapAlarm *t = queue_trap(e->oid, message);
+    if (t) {
+        t->alarm_id = e->id;
+        t->alarm_state = state_names[tr];
+        t->severity = severity_names[e->severity];
     }
-    if (cpu_temp > global_config.cpu_temp_threshold) {
-        if (global_config.syslog_enable)
-            syslog(LOG_ALERT, "ALARM: CPU temperature high: %.1f°C", cpu_temp);
-        send_snmp_trap(".1.3.6.1.4.1.8072.2.3.0.4", "CPU temperature high alarm triggered");
+    if (tr == ALARM_CLEAR)
+        remove_entry(e);
+    return t;
+}
+
+/* 상태 알람: bad이면 발생, 정상이면 해제. 트랩 값은 현재 상태와 기대하는 정상 값 */
+static void state_alarm(const char *oid, const char *instance, const char *name, int bad,
+                        const char *detail, const char *value, const char *expected) {
+    alarm_entry_t *e;
+    int tr = alarm_step(oid, instance, bad ? RULE_LEVEL_CRITICAL : RULE_LEVEL_NONE, !bad, &e);
+    if (tr == ALARM_NONE)
+        return;
+    TrapAlarm *t = notify_transition(tr, e, name, detail);
+    if (t) {
+        t->type = TRAP_VALUE_STRING;
+        snprintf(t->value_str, sizeof(t->value_str), "%s", value);
+        snprintf(t->threshold_str, sizeof(t->threshold_str), "%s", expected);
     }
-    if (rx_rate > global_config.net_rx_threshold) {
-        if (global_config.syslog_enable)
-            syslog(LOG_ALERT, "ALARM: Network RX high: %.1f bytes/sec", rx_rate);
-        send_snmp_trap(".1.3.6.1.4.1.8072.2.3.0.5", "Network RX high alarm triggered");
+}
+
+/* 임계치 규칙 (rules.c) 판정 결과 하나 */
+static void rule_alarm(const RuleSample *s) {
+    alarm_entry_t *e;
+    int tr = alarm_step(s->rule->oid, s->instance, s->level, s->cleared, &e);
+    if (tr == ALARM_NONE)
+        return;
+
+    double threshold = (tr == ALARM_CLEAR) ? s->clear_threshold : s->threshold;
+    char detail[192];
+    snprintf(detail, sizeof(detail), "%s%s%.1f%s (threshold %.1f%s)",
+             s->instance, s->instance[0] ? " " : "", s->value, s->unit, threshold, s->unit);
+    TrapAlarm *t = notify_transition(tr, e, s->rule->name, detail);
+    if (t) {
+        t->type = TRAP_VALUE_GAUGE;
+        t->value = to_gauge(s->value);
+        t->threshold = to_gauge(threshold);
     }
-    if (tx_rate > global_config.net_tx_threshold) {
-        if (global_config.syslog_enable)
-            syslog(LOG_ALERT, "ALARM: Network TX high: %.1f bytes/sec", tx_rate);
-        send_snmp_trap(".1.3.6.1.4.1.8072.2.3.0.6", "Network TX high alarm triggered");
+}
+
+/* MOUNT_RO_EXPECTED(쉼표 구분 glob)에 있는 마운트는 읽기 전용이 정상 */
+static int ro_expected(const char *mountpoint) {
+    char buf[sizeof(global_config.mount_ro_expected)];
+    char *save = NULL;
+
+    snprintf(buf, sizeof(buf), "%s", global_config.mount_ro_expected);
+    for (char *pat = strtok_r(buf, ", \t", &save); pat; pat = strtok_r(NULL, ", \t", &save)) {
+        if (fnmatch(pat, mountpoint, 0) == 0)
+            return 1;
     }
+    return 0;
+}
 
-    RaidInfo raidInfo = get_raid_info();
-    /* RAID 상태 알람: RAID 상태가 "Optimal"이 아니면 알람 */
-    if(strcasecmp(raidInfo.raid_state, "Optimal") != 0) {
-        if(global_config.syslog_enable)
-            syslog(LOG_ALERT, "ALARM: RAID state abnormal: %s, Level: %s", raidInfo.raid_state, raidInfo.raid_level);
-        send_snmp_trap(RAID_OID, "RAID state alarm triggered");
+/* 읽기 전용 마운트 알람: 다시 마운트된 경우뿐 아니라 시작할 때부터 ro였거나
+   ro로 새로 붙은 마운트도 알람. rw가 되면 해제 */
+static void check_mount_alarms(const snapshot_t *snap) {
+    for (int i = 0; i < snap->mounts.count; i++) {
+        const MountUsage *m = &snap->mounts.mounts[i];
+        char detail[192];
+        snprintf(detail, sizeof(detail), "%s (%s) is %s", m->mountpoint, m->fstype,
+                 m->readonly ? "read-only" : "read-write");
+        state_alarm(MOUNT_RO_OID, m->mountpoint, "Filesystem read-only",
+                    m->readonly && !ro_expected(m->mountpoint), detail,
+                    m->readonly ? "ro" : "rw", "rw");
     }
+}
 
-    /* SSD 슬롯 상태 알람 */
-    if (strcasecmp(raidInfo.ssd0_status, "Online") != 0) {
-        if (global_config.syslog_enable)
-            syslog(LOG_ALERT, "ALARM: SSD0 status abnormal: %s", raidInfo.ssd0_status);
-        send_snmp_trap(SSD0_OID, "SSD0 status alarm triggered");
+/* mountinfo 변경으로 rw에서 ro로 바뀐 마운트는 보고 주기를 기다리지 않고 바로 발생시킨다
+   (ALARM_TRIGGER_SAMPLES 없이). 해제는 주기 검사가 이어받아 판정한다 */
+void raise_mount_ro_alarm(const char *mountpoint, const char *fstype) {
+    if (ro_expected(mountpoint))
+        return;
+    alarm_entry_t *e = find_entry(MOUNT_RO_OID, mountpoint);
+    if (e && (e->state == ALARM_STATE_RAISED || e->state == ALARM_STATE_CLEARING))
+        return;
+    if (!e && !(e = add_entry(MOUNT_RO_OID, mountpoint)))
+        return;
+    e->state = ALARM_STATE_RAISED;
+    e->severity = RULE_LEVEL_CRITICAL;
+    e->id = new_alarm_id();
+    e->last_notify = time(NULL);
+    e->seen = cycle;
+
+    char detail[192];
+    snprintf(detail, sizeof(detail), "%s (%s) remounted read-only", mountpoint, fstype);
+    TrapAlarm *t = notify_transition(ALARM_RAISE, e, "Filesystem read-only", detail);
+    if (t) {
+        t->type = TRAP_VALUE_STRING;
+        snprintf(t->value_str, sizeof(t->value_str), "ro");
+        snprintf(t->threshold_str, sizeof(t->threshold_str), "rw");
     }
-    if (strcasecmp(raidInfo.ssd1_status, "Online") != 0) {
-        if (global_config.syslog_enable)
-            syslog(LOG_ALERT, "ALARM: SSD1 status abnormal: %s", raidInfo.ssd1_status);
-        send_snmp_trap(SSD1_OID, "SSD1 status alarm triggered");
+    /* 보고 주기 밖에서 불리므로 바로 큐에 넣는다 */
+    flush_traps();
+}
+
+/* 이번 검사에서 판정하지 못한 (점검 실패 등) OID의 알람은 그대로 둔다 */
+static void keep_alarms(const char *oid) {
+    for (int i = 0; i < entry_count; i++)
+        if (strcmp(entries[i].oid, oid) == 0)
+            entries[i].seen = cycle;
+}
+
+/* 이번 검사에서 판정하지 않은 대상(사라진 마운트, 인터페이스, 센서, 드라이브 등)의 알람을 정리한다.
+   발생 중이면 해제를 알리고 아직 발생 전이면 조용히 지운다. 대상이 없는 호스트 알람은 두고 본다 */
+static void sweep_gone_alarms(void) {
+    for (int i = entry_count - 1; i >= 0; i--) {
+        alarm_entry_t *e = &entries[i];
+        if (e->seen == cycle || e->instance[0] == '\0')
+            continue;
+        if (e->state == ALARM_STATE_RAISED || e->state == ALARM_STATE_CLEARING) {
+            char name[sizeof(e->name)], detail[192];
+            snprintf(name, sizeof(name), "%s", e->name);
+            snprintf(detail, sizeof(detail), "%s no longer reported", e->instance);
+            e->state = ALARM_STATE_OK;
+            notify_transition(ALARM_CLEAR, e, name, detail);
+        } else {
+            remove_entry(e);
+        }
     }
+}
 
+/* 팬/전원 알람 (보조 프로세스 또는 Redfish 결과) */
+static void check_hw_alarms(const snapshot_t *snap) {
+    /* 팬/전원 보조 프로세스가 결과를 내지 못하면 지연 알람만 내고 오래된 값은 판정하지 않는다 */
+    char stale_detail[128];
+    if (snap->hw_age >= 0)
+        snprintf(stale_detail, sizeof(stale_detail), "last hardware result %d s ago (limit %d s)",
+                 snap->hw_age, hw_stale_limit());
+    else
+        snprintf(stale_detail, sizeof(stale_detail), "no hardware result yet (limit %d s)", hw_stale_limit());
+    state_alarm(HW_HELPER_OID, "", "Hardware helper stale", snap->hw_stale, stale_detail,
+                snap->hw_stale ? "stale" : "ok", "ok");
+    if (snap->hw_stale || !snap->hw_updated)
+        return;
 
-    /* 팬 상태 알람 */
-    FanInfo fanInfo = get_fan_info();
-    if (fanInfo.cpuFan <= 0 || fanInfo.auxFan <= 0 || 
-        fanInfo.fan1 <= 0 || fanInfo.fan2 <= 0 || fanInfo.fan3 <= 0) {
-        if (global_config.syslog_enable)
-            syslog(LOG_ALERT, "ALARM: Fan speed abnormal: CPU Fan=%d, Aux Fan=%d, FAN1=%d, FAN2=%d, FAN3=%d",
-                   fanInfo.cpuFan, fanInfo.auxFan, fanInfo.fan1, fanInfo.fan2, fanInfo.fan3);
-        send_snmp_trap(FAN_OID, "Fan speed alarm triggered");
+    /* 팬 상태 알람. Redfish 팬은 센서 알람(Status.Health, 하한)으로 판정한다 */
+    const FanSpeeds *fanInfo = &snap->fan;
+    if (strcmp(global_config.hw_source, "redfish") != 0) {
+        /* 값은 가장 낮은 팬 회전수 */
+        int lowest = fanInfo->cpuFan;
+        const int others[] = { fanInfo->auxFan, fanInfo->fan1, fanInfo->fan2, fanInfo->fan3 };
+        for (int i = 0; i < 4; i++)
+            if (others[i] < lowest)
+                lowest = others[i];
+        alarm_entry_t *e;
+        int tr = alarm_step(FAN_OID, "", lowest <= 0 ? RULE_LEVEL_CRITICAL : RULE_LEVEL_NONE, lowest > 0, &e);
+        if (tr != ALARM_NONE) {
+            char detail[128];
+            snprintf(detail, sizeof(detail), "CPU Fan=%d, Aux Fan=%d, FAN1=%d, FAN2=%d, FAN3=%d",
+                     fanInfo->cpuFan, fanInfo->auxFan, fanInfo->fan1, fanInfo->fan2, fanInfo->fan3);
+            TrapAlarm *t = notify_transition(tr, e, "Fan speed", detail);
+            if (t) {
+                t->type = TRAP_VALUE_GAUGE;
+                t->value = to_gauge(lowest);
+                t->threshold = 0;
+            }
+        }
     }
 
     /* 전원(Power) 상태 알람 */
-    PowerInfo powerInfo = get_power_info();
+    const PowerInfo *powerInfo = &snap->power;
     /* 두 채널 모두 "OK"여야 정상. 하나라도 "OK"가 아니면 알람 발생 */
-    if (strcasecmp(powerInfo.power1, "OK") != 0 || strcasecmp(powerInfo.power2, "OK") != 0) {
+    char detail[128], value[64];
+    snprintf(detail, sizeof(detail), "Power1=%s, Power2=%s", powerInfo->power1, powerInfo->power2);
+    snprintf(value, sizeof(value), "%s/%s", powerInfo->power1, powerInfo->power2);
+    state_alarm(POWER_OID, "", "Power state",
+                strcasecmp(powerInfo->power1, "OK") != 0 || strcasecmp(powerInfo->power2, "OK") != 0,
+                detail, value, "OK/OK");
+}
+
+/* 알람 조건 검사 및 알람 전송 (주기 스냅샷 기준) */
+void check_and_alarm(const snapshot_t *snap) {
+    cycle_time = snap->timestamp;
+    cycle++;
+
+    /* CPU, 메모리, 마운트, 블록 장치, 온도, 네트워크 임계치 (*_THRESHOLD와 ALARM_RULE) */
+    rules_evaluate(snap, rule_alarm);
+    check_mount_alarms(snap);
+    /* hwmon 센서 알람: 커널 *_alarm 또는 crit/min 한계 */
+    for (int i = 0; i < snap->sensors.count; i++) {
+        const Sensor *s = &snap->sensors.sensors[i];
+        /* nvme "Composite"나 소켓별 coretemp "Core 0"처럼 chip과 label이 겹치므로 hwmon 장치를 붙인다 */
+        char instance[112];
+        snprintf(instance, sizeof(instance), "%s%s%s %s", s->device, s->device[0] ? " " : "", s->chip, s->label);
+        alarm_entry_t *e;
+        int tr = alarm_step(SENSOR_OID, instance, s->alarm ? RULE_LEVEL_CRITICAL : RULE_LEVEL_NONE, !s->alarm, &e);
+        if (tr == ALARM_NONE)
+            continue;
+        char detail[192], value[64], limit[64];
+        snprintf(detail, sizeof(detail), "%s %.2f %s (min %.2f, max %.2f, crit %.2f)",
+                 instance, s->value, sensor_units[s->type], s->min, s->max, s->crit);
+        /* 하한 아래면 min, 아니면 crit을 넘은 임계치로 보낸다 */
+        snprintf(value, sizeof(value), "%.2f %s", s->value, sensor_units[s->type]);
+        snprintf(limit, sizeof(limit), "%.2f %s",
+                 (s->min != 0 && s->value < s->min) ? s->min : s->crit, sensor_units[s->type]);
+        TrapAlarm *t = notify_transition(tr, e, "Hardware sensor", detail);
+        if (t) {
+            t->type = TRAP_VALUE_STRING;
+            snprintf(t->value_str, sizeof(t->value_str), "%s", value);
+            snprintf(t->threshold_str, sizeof(t->threshold_str), "%s", limit);
+        }
+    }
+    /* 하드웨어 오류 카운터 증가 알람. 스냅샷에는 직전 보고 이후 늘어난 양이 모여 있다 */
+    for (int i = 0; i < snap->hwerr.count; i++) {
+        const HwErrEvent *e = &snap->hwerr.events[i];
+        int correctable = (e->kind == HWERR_AER_CORRECTABLE || e->kind == HWERR_EDAC_CE);
+        if (correctable && e->delta < (unsigned long long)global_config.hwerr_correctable_threshold)
+            continue;
         if (global_config.syslog_enable)
-            syslog(LOG_ALERT, "ALARM: Power state abnormal: Power1=%s, Power2=%s", 
-                   powerInfo.power1, powerInfo.power2);
-        send_snmp_trap(POWER_OID, "Power state alarm triggered");
+            syslog(LOG_ALERT, "ALARM: %s errors increased: %s +%llu (total %llu)",
+                   hwerr_kind_names[e->kind], e->device, e->delta, e->total);
+        double limit = correctable ? global_config.hwerr_correctable_threshold : 1;
+        if (e->kind == HWERR_EDAC_CE || e->kind == HWERR_EDAC_UE)
+            send_snmp_trap_value(EDAC_OID, "Memory error alarm triggered", e->delta, limit);
+        else if (e->kind == HWERR_SCSI_IOERR)
+            send_snmp_trap_value(SCSI_IOERR_OID, "Disk I/O error alarm triggered", e->delta, limit);
+        else
+            send_snmp_trap_value(AER_OID, "PCIe error alarm triggered", e->delta, limit);
     }
+    /* RAID 점검이 멈췄거나 시간 초과로 끝났으면 상태 알람과 별개로 점검 지연 알람 */
+    char probe_detail[128];
+    if (snap->raid.updated)
+        snprintf(probe_detail, sizeof(probe_detail), "RAID probe %s RAID_PROBE_TIMEOUT %d s (last result %.0f s ago)",
+                 snap->raid.probe_timeout ? "exceeded" : "within", global_config.raid_probe_timeout,
+                 difftime(snap->timestamp, snap->raid.updated));
+    else
+        snprintf(probe_detail, sizeof(probe_detail), "RAID probe %s RAID_PROBE_TIMEOUT %d s (no result yet)",
+                 snap->raid.probe_timeout ? "exceeded" : "within", global_config.raid_probe_timeout);
+    state_alarm(RAID_PROBE_OID, "", "RAID probe timeout", snap->raid.probe_timeout, probe_detail,
+                snap->raid.probe_timeout ? "timeout" : "ok", "ok");
+
+    /* 아직 점검 결과가 없으면 RAID 상태는 판정하지 않는다.
+       점검이 실패했으면 드라이브 목록이 비어 있을 수 있으므로 드라이브 알람은 그대로 둔다 */
+    const RaidInfo *raidInfo = &snap->raid.info;
+    if (strcmp(raidInfo->raid_state, "Unknown") == 0) {
+        keep_alarms(RAID_OID);
+        keep_alarms(SSD0_OID);
+        keep_alarms(SSD1_OID);
+        keep_alarms(PD_OID);
+        keep_alarms(PD_PREDICTIVE_OID);
+    }
+    if (snap->raid.updated != 0) {
+        char instance[64], detail[192];
+        /* VD별 상태 알람: "Optimal"이 아니면 알람 */
+        for (int i = 0; i < raidInfo->vd_count; i++) {
+            const RaidVd *vd = &raidInfo->vds[i];
+            snprintf(instance, sizeof(instance), "adapter %d VD %d", vd->adapter, vd->id);
+            snprintf(detail, sizeof(detail), "%s %s, Level: %s", instance, vd->state, vd->level);
+            state_alarm(RAID_OID, instance, "RAID state", strcasecmp(vd->state, "Optimal") != 0,
+                        detail, vd->state, "Optimal");
+        }
+        if (raidInfo->vd_count == 0) {
+            snprintf(detail, sizeof(detail), "%s, Level: %s", raidInfo->raid_state, raidInfo->raid_level);
+            state_alarm(RAID_OID, "", "RAID state", strcasecmp(raidInfo->raid_state, "Optimal") != 0,
+                        detail, raidInfo->raid_state, "Optimal");
+        }
+
+        /* 드라이브별 상태 알람. 슬롯 0/1은 기존 SSD0/SSD1 OID를 유지한다 */
+        for (int i = 0; i < raidInfo->pd_count; i++) {
+            const RaidPd *pd = &raidInfo->pds[i];
+            snprintf(instance, sizeof(instance), "adapter %d enclosure %d slot %d%s%s",
+                     pd->adapter, pd->enclosure, pd->slot, pd->device[0] ? " device " : "", pd->device);
+            snprintf(detail, sizeof(detail), "%s: %s", instance, pd->state);
+            if (pd->slot == 0)
+                state_alarm(SSD0_OID, instance, "SSD0 status", !raid_pd_ok(pd), detail, pd->state, "Online");
+            else if (pd->slot == 1)
+                state_alarm(SSD1_OID, instance, "SSD1 status", !raid_pd_ok(pd), detail, pd->state, "Online");
+            else
+                state_alarm(PD_OID, instance, "Drive status", !raid_pd_ok(pd), detail, pd->state, "Online");
+
+            alarm_entry_t *e;
+            int tr = alarm_step(PD_PREDICTIVE_OID, instance,
+                                pd->predictive_failures > 0 ? RULE_LEVEL_CRITICAL : RULE_LEVEL_NONE,
+                                pd->predictive_failures == 0, &e);
+            if (tr != ALARM_NONE) {
+                snprintf(detail, sizeof(detail), "%s: count=%u, media errors=%u",
+                         instance, pd->predictive_failures, pd->media_errors);
+                TrapAlarm *t = notify_transition(tr, e, "Drive predictive failure", detail);
+                if (t) {
+                    t->type = TRAP_VALUE_GAUGE;
+                    t->value = pd->predictive_failures;
+                    t->threshold = 0;
+                }
+            }
+        }
+    }
+
+    /* 팬/전원 */
+    check_hw_alarms(snap);
+
+    sweep_gone_alarms();
 
+    /* 이번 주기의 알람을 한 번에 보낸다 */
+    flush_traps();
 }
@@ -1,6 +1,11 @@
 #ifndef ALARMS_H
 #define ALARMS_H
 
-void check_and_alarm(void);
+#include "snapshot.h"
+
+void check_and_alarm(const snapshot_t *snap);
+void raise_event_alarm(const char *trap_oid, const char *trap_message, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+void raise_mount_ro_alarm(const char *mountpoint, const char *fstype);
 
 #endif // ALARMS_H
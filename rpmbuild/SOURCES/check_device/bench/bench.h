@@ -0,0 +1,44 @@
+#ifndef BENCH_BENCH_H
+#define BENCH_BENCH_H
+
+/* make bench용 공통 도구: 단조 시계와 결과 한 줄 출력. 소스 디렉터리에서 실행한다 */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static inline double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* 반복 한 번의 평균 시간을 µs로 출력한다 */
+static inline void bench_report(const char *name, int iterations, double elapsed) {
+    printf("%-40s %8d iterations %12.2f us/iter\n", name, iterations, elapsed * 1e6 / iterations);
+}
+
+/* 파일 전체를 읽는다. 파서가 버퍼를 자르므로 호출하는 쪽이 반복마다 복사해 쓴다 */
+static inline char *bench_load(const char *path, size_t *len) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        perror(path);
+        exit(2);
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    rewind(fp);
+    char *buf = malloc(size + 1);
+    if (!buf || fread(buf, 1, size, fp) != (size_t)size) {
+        fprintf(stderr, "%s: read failed\n", path);
+        exit(2);
+    }
+    buf[size] = '\0';
+    fclose(fp);
+    if (len)
+        *len = size;
+    return buf;
+}
+
+#endif // BENCH_BENCH_H
@@ -0,0 +1,216 @@
+/* /proc 파싱 비용: 예전 fopen + fgets + sscanf 코드와 지금의 procfile + procparse.
+   큰 서버를 흉내 낸 파일 (CPU 512개의 /proc/stat, 인터페이스 2000개의 /proc/net/dev, meminfo)을
+   임시 디렉터리에 만들어 두 구현이 같은 파일을 읽는다. 진짜 /proc은 읽을 때마다 내용 전체를 만들므로
+   첫 줄만 읽는 예전 /proc/stat 코드는 여기서 실제보다 유리하게 나온다 */
+
+#include "bench.h"
+#include "procfile.h"
+#include "procparse.h"
+#include <unistd.h>
+
+#define NCPUS 512
+#define NIFACES 2000
+#define ITERATIONS 2000
+
+static char dir[] = "/tmp/bench_procparse.XXXXXX";
+static char stat_path[64], meminfo_path[64], net_dev_path[64];
+static procfile_t proc_stat, proc_meminfo, proc_net_dev;
+
+static FILE *create(char *path, const char *name) {
+    snprintf(path, 64, "%s/%s", dir, name);
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        perror(path);
+        exit(2);
+    }
+    return fp;
+}
+
+static void make_fixtures(void) {
+    unsigned long long base = 123456789ULL;
+    FILE *fp;
+
+    if (!mkdtemp(dir)) {
+        perror(dir);
+        exit(2);
+    }
+    fp = create(stat_path, "stat");
+    fprintf(fp, "cpu  %llu %llu %llu %llu %llu %llu %llu %llu 0 0\n",
+            base * NCPUS, base, base * 3, base * 40, base / 7, 0ULL, base / 9, 0ULL);
+    for (int i = 0; i < NCPUS; i++)
+        fprintf(fp, "cpu%d %llu %llu %llu %llu %llu %llu %llu %llu 0 0\n",
+                i, base + i, base / 100, base / 3 + i, base * 40 + i, base / 7, 0ULL, base / 9, 0ULL);
+    fprintf(fp, "intr 98765432101 27 0 0 0 0 0 0 0 1 0 0 0\nctxt 1234567890123\nbtime 1760000000\n"
+                "processes 9876543\nprocs_running 12\nprocs_blocked 0\nsoftirq 2345678901 0 1 2 3 4 5 6 7 8 9\n");
+    fclose(fp);
+
+    fp = create(net_dev_path, "net_dev");
+    fprintf(fp, "Inter-|   Receive                                                |  Transmit\n"
+                " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+                "    lo: 987654321 1234567 0 0 0 0 0 0 987654321 1234567 0 0 0 0 0 0\n");
+    for (int i = 0; i < NIFACES; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), i % 2 ? "veth%04x" : "eth0.%d", i);
+        fprintf(fp, "%12s: %llu %llu 0 0 0 0 0 %d %llu %llu 0 0 0 0 0 0\n",
+                name, base * (i + 1), base / 1000 + i, i, base * 2 + i, base / 2000 + i);
+    }
+    fclose(fp);
+
+    static const char *const keys[] = {
+        "MemTotal", "MemFree", "MemAvailable", "Buffers", "Cached", "SwapCached", "Active", "Inactive",
+        "Active(anon)", "Inactive(anon)", "Active(file)", "Inactive(file)", "Unevictable", "Mlocked",
+        "SwapTotal", "SwapFree", "Dirty", "Writeback", "AnonPages", "Mapped", "Shmem", "KReclaimable",
+        "Slab", "SReclaimable", "SUnreclaim", "KernelStack", "PageTables", "NFS_Unstable", "Bounce",
+        "WritebackTmp", "CommitLimit", "Committed_AS", "VmallocTotal", "VmallocUsed", "VmallocChunk",
+        "Percpu", "HardwareCorrupted", "AnonHugePages", "ShmemHugePages", "ShmemPmdMapped",
+        "HugePages_Total", "HugePages_Free", "HugePages_Rsvd", "HugePages_Surp", "Hugepagesize",
+        "Hugetlb", "DirectMap4k", "DirectMap2M", "DirectMap1G",
+    };
+    fp = create(meminfo_path, "meminfo");
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++)
+        fprintf(fp, "%s:%*llu kB\n", keys[i], (int)(23 - strlen(keys[i])), 1056000000ULL - i * 1000);
+    fclose(fp);
+
+    procfile_init(&proc_stat, stat_path);
+    procfile_init(&proc_meminfo, meminfo_path);
+    procfile_init(&proc_net_dev, net_dev_path);
+}
+
+static void remove_fixtures(void) {
+    procfile_close(&proc_stat);
+    procfile_close(&proc_meminfo);
+    procfile_close(&proc_net_dev);
+    unlink(stat_path);
+    unlink(meminfo_path);
+    unlink(net_dev_path);
+    rmdir(dir);
+}
+
+/* ---- 예전 코드 (user-006 이전 metrics.c) ---- */
+
+static unsigned long long sscanf_stat(void) {
+    unsigned long long v[8] = {0};
+    char buffer[256];
+    FILE *fp = fopen(stat_path, "r");
+    if (!fp || !fgets(buffer, sizeof(buffer), fp))
+        exit(2);
+    fclose(fp);
+    sscanf(buffer, "cpu  %llu %llu %llu %llu %llu %llu %llu %llu",
+           &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]);
+    return v[0] + v[3];
+}
+
+static unsigned long long sscanf_meminfo(void) {
+    unsigned long long memTotal = 0, memAvailable = 0;
+    char line[256];
+    FILE *fp = fopen(meminfo_path, "r");
+    if (!fp)
+        exit(2);
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "MemTotal: %llu kB", &memTotal) == 1) { }
+        else if (sscanf(line, "MemAvailable: %llu kB", &memAvailable) == 1) { }
+        if (memTotal && memAvailable)
+            break;
+    }
+    fclose(fp);
+    return memTotal - memAvailable;
+}
+
+static unsigned long long sscanf_net_dev(void) {
+    unsigned long long rx = 0, tx = 0;
+    char line[512];
+    FILE *fp = fopen(net_dev_path, "r");
+    if (!fp)
+        exit(2);
+    fgets(line, sizeof(line), fp);
+    fgets(line, sizeof(line), fp);
+    while (fgets(line, sizeof(line), fp)) {
+        char iface[32];
+        unsigned long long r, t;
+        if (sscanf(line, " %[^:]: %llu %*s %*s %*s %*s %*s %*s %*s %llu", iface, &r, &t) == 3) {
+            if (strcmp(iface, "lo") != 0) {
+                rx += r;
+                tx += t;
+            }
+        }
+    }
+    fclose(fp);
+    return rx + tx;
+}
+
+/* ---- procfile + procparse (지금 metrics.c, user-006의 net/dev 파싱) ---- */
+
+static unsigned long long procparse_stat(void) {
+    unsigned long long v[8] = {0};
+    char *cursor = procfile_read(&proc_stat, NULL);
+    char *line = cursor ? parse_next_line(&cursor) : NULL;
+    if (!line || strncmp(line, "cpu ", 4) != 0)
+        exit(2);
+    parse_u64_fields(line + 4, v, 8);
+    return v[0] + v[3];
+}
+
+static unsigned long long procparse_meminfo(void) {
+    unsigned long long memTotal = 0, memAvailable = 0;
+    parse_field_t fields[] = {
+        { "MemTotal", &memTotal, 0 },
+        { "MemAvailable", &memAvailable, 0 },
+    };
+    char *buf = procfile_read(&proc_meminfo, NULL);
+    if (!buf)
+        exit(2);
+    parse_keyed_u64(buf, fields, 2);
+    return memTotal - memAvailable;
+}
+
+static unsigned long long procparse_net_dev(void) {
+    unsigned long long rx = 0, tx = 0;
+    char *cursor = procfile_read(&proc_net_dev, NULL);
+    char *line;
+    if (!cursor)
+        exit(2);
+    while ((line = parse_next_line(&cursor)) != NULL) {
+        char *colon = strchr(line, ':');
+        if (!colon)
+            continue;
+        *colon = '\0';
+        char *name = parse_next_token(&line);
+        if (!name || strcmp(name, "lo") == 0)
+            continue;
+        unsigned long long v[9];
+        if (parse_u64_fields(colon + 1, v, 9) == 9) {
+            rx += v[0];
+            tx += v[8];
+        }
+    }
+    return rx + tx;
+}
+
+static void run(const char *name, unsigned long long (*fn)(void), unsigned long long expected) {
+    volatile unsigned long long sink = 0;
+    unsigned long long got = fn();
+    if (got != expected) {
+        fprintf(stderr, "%s: result %llu, expected %llu\n", name, got, expected);
+        remove_fixtures();
+        exit(1);
+    }
+    double start = bench_now();
+    for (int i = 0; i < ITERATIONS; i++)
+        sink += fn();
+    bench_report(name, ITERATIONS, bench_now() - start);
+    (void)sink;
+}
+
+int main(void) {
+    make_fixtures();
+
+    /* 두 구현이 같은 값을 내는지 먼저 맞춰 본다 */
+    run("/proc/stat (512 CPUs): sscanf", sscanf_stat, procparse_stat());
+    run("/proc/stat (512 CPUs): procparse", procparse_stat, sscanf_stat());
+    run("/proc/meminfo: sscanf", sscanf_meminfo, procparse_meminfo());
+    run("/proc/meminfo: procparse", procparse_meminfo, sscanf_meminfo());
+    run("/proc/net/dev (2000 ifaces): sscanf", sscanf_net_dev, procparse_net_dev());
+    run("/proc/net/dev (2000 ifaces): procparse", procparse_net_dev, sscanf_net_dev());
+    remove_fixtures();
+    return 0;
+}
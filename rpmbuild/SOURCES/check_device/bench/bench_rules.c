@@ -0,0 +1,88 @@
+/* 규칙 엔진 한 주기 비용: ALARM_RULE 수를 늘려 가며 rules_evaluate()를 잰다.
+   스냅샷은 표가 꽉 찬 큰 서버 (마운트 32, 디스크 32, 인터페이스 64) */
+
+#include "bench.h"
+#include "rules.h"
+#include "config.h"
+
+#define CYCLES 200
+
+static long samples, raised;
+
+static void on_sample(const RuleSample *s) {
+    samples++;
+    if (s->level != RULE_LEVEL_NONE)
+        raised++;
+}
+
+static void fill_snapshot(snapshot_t *snap) {
+    snap->cpu_usage = 72.5f;
+    snap->mem_usage = 91.0f;
+    snap->cpu_temp = 68.0f;
+    snap->fan.cpuFan = 5400;
+    snap->mounts.count = MAX_MOUNTS;
+    for (int i = 0; i < MAX_MOUNTS; i++) {
+        snprintf(snap->mounts.mounts[i].mountpoint, sizeof(snap->mounts.mounts[i].mountpoint), "/data%d", i);
+        snap->mounts.mounts[i].block_usage = (float)(i * 3);
+        snap->mounts.mounts[i].inode_usage = (float)i;
+    }
+    snap->diskio.count = MAX_DISKS;
+    for (int i = 0; i < MAX_DISKS; i++) {
+        snprintf(snap->diskio.disks[i].name, sizeof(snap->diskio.disks[i].name), "sd%c%c",
+                 'a' + i / 26, 'a' + i % 26);
+        snap->diskio.disks[i].util = (float)(i * 3);
+        snap->diskio.disks[i].await_ms = (float)i;
+    }
+    snap->net.count = MAX_NET_IFACES;
+    for (int i = 0; i < MAX_NET_IFACES; i++) {
+        snprintf(snap->net.ifaces[i].name, sizeof(snap->net.ifaces[i].name), "eth%d", i);
+        snap->net.ifaces[i].rx_rate = i * 1e6f;
+        snap->net.ifaces[i].rx_util = (float)i;
+    }
+}
+
+/* 호스트, 마운트, 디스크, 인터페이스 규칙을 섞는다. 대상 glob도 절반쯤 쓴다 */
+static void make_rules(int count) {
+    static const char *const metrics[] = {
+        "cpu.usage", "mem.free", "psi.io", "fan.cpu",
+        "disk.usage@/data1*", "inode.usage", "disk.util@sd*", "disk.await",
+        "net.if_rx_rate@eth1*", "net.rx_util",
+    };
+    int n = sizeof(metrics) / sizeof(metrics[0]);
+    for (int i = 0; i < count; i++) {
+        snprintf(global_config.alarm_rules[i], ALARM_RULE_LEN, "%s %s %d %d .1.3.6.1.4.1.8072.2.4.%d",
+                 metrics[i % n], (i % n == 3) ? "<" : ">",
+                 (i % n == 3) ? 1000 : 50 + i % 40, (i % n == 3) ? 500 : 95, i);
+    }
+    global_config.alarm_rule_count = count;
+}
+
+int main(void) {
+    static snapshot_t snap;
+    static const int sizes[] = { 0, 64, 256, 1024, MAX_ALARM_RULES };
+    char name[64];
+
+    global_config.alarm_hysteresis = 5;
+    global_config.cpu_usage_threshold = 90;
+    global_config.mem_usage_threshold = 90;
+    fill_snapshot(&snap);
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        make_rules(sizes[s]);
+        int compiled = rules_compile();
+        samples = raised = 0;
+        rules_evaluate(&snap, on_sample);
+        long per_cycle = samples, raised_per_cycle = raised;
+
+        double start = bench_now();
+        for (int i = 0; i < CYCLES; i++)
+            rules_evaluate(&snap, on_sample);
+        double elapsed = bench_now() - start;
+
+        snprintf(name, sizeof(name), "rules_evaluate, %d rules", compiled);
+        bench_report(name, CYCLES, elapsed);
+        printf("%-40s %8ld samples/cycle, %ld raised, %.1f ns/sample\n", "", per_cycle,
+               raised_per_cycle, per_cycle ? elapsed * 1e9 / CYCLES / per_cycle : 0);
+    }
+    return 0;
+}
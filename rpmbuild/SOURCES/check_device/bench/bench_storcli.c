@@ -0,0 +1,88 @@
+/* RAID 점검 한 주기 비용: 예전 popen+grep+awk 파이프라인과 storcli JSON 파서.
+   컨트롤러가 없으므로 MegaCli64/storcli64 대신 cat이 같은 fixture를 출력한다 */
+
+#include "bench.h"
+#include "storcli.h"
+#include "executor.h"
+
+#define ITERATIONS 200
+#define PARSE_ITERATIONS 20000
+
+#define SHOW_ALL    "tests/fixtures/storcli_show_all.json"
+#define DRIVES      "tests/fixtures/storcli_drives_show_all.json"
+
+/* 예전 get_raid_info(): 셸 파이프라인 두 개를 popen으로 읽는다 */
+static const char *raid_cmd =
+    "cat tests/fixtures/megacli_ldpdinfo.txt | grep -A 7 \"Virtual Drive\" | "
+    "awk \"{ if(\\$0 ~ /State/) { stat=\\$NF } else if(\\$0 ~ /RAID Level/) { raid=\\$NF } } "
+    "END { print stat, raid }\"";
+static const char *pd_cmd =
+    "cat tests/fixtures/megacli_pdlist.txt | grep -E \"Slot Number:|Firmware state:\" | "
+    "awk '{ if($0 ~ /Slot Number:/) { slot=$3 } else if($0 ~ /Firmware state:/) { print \"Slot \" slot \": \" $3, substr($0, index($0,$4)) } }'";
+
+static int popen_awk(void) {
+    char line[256];
+    int lines = 0;
+    const char *cmds[] = { raid_cmd, pd_cmd };
+    for (int i = 0; i < 2; i++) {
+        FILE *fp = popen(cmds[i], "r");
+        if (!fp)
+            return -1;
+        while (fgets(line, sizeof(line), fp))
+            lines++;
+        pclose(fp);
+    }
+    return lines;
+}
+
+/* 지금 storcli_get_info(): 셸 없이 두 번 실행하고 JSON을 파싱한다 */
+static int exec_storcli(void) {
+    static char output[1024 * 1024];
+    char *const show_argv[] = { "/bin/cat", SHOW_ALL, NULL };
+    char *const pd_argv[] = { "/bin/cat", DRIVES, NULL };
+    exec_result_t res;
+    RaidInfo info;
+
+    memset(&info, 0, sizeof(info));
+    if (exec_run(show_argv, 5000, output, sizeof(output), &res) != 0 || storcli_parse(output, &info) != 0)
+        return -1;
+    if (exec_run(pd_argv, 5000, output, sizeof(output), &res) != 0 || storcli_parse(output, &info) != 0)
+        return -1;
+    return info.pd_count;
+}
+
+int main(void) {
+    size_t show_len, drives_len;
+    char *show = bench_load(SHOW_ALL, &show_len);
+    char *drives = bench_load(DRIVES, &drives_len);
+    char *buf = malloc(show_len + drives_len + 2);
+    static RaidInfo info;
+    double start;
+
+    if (popen_awk() <= 0 || exec_storcli() != 9) {
+        fprintf(stderr, "bench_storcli: fixture check failed\n");
+        return 1;
+    }
+
+    start = bench_now();
+    for (int i = 0; i < ITERATIONS; i++)
+        popen_awk();
+    bench_report("popen + grep + awk (2 pipelines)", ITERATIONS, bench_now() - start);
+
+    start = bench_now();
+    for (int i = 0; i < ITERATIONS; i++)
+        exec_storcli();
+    bench_report("exec_run + storcli_parse (2 runs)", ITERATIONS, bench_now() - start);
+
+    /* 프로세스 생성을 뺀 파서 자체 비용 */
+    start = bench_now();
+    for (int i = 0; i < PARSE_ITERATIONS; i++) {
+        memset(&info, 0, sizeof(info));
+        memcpy(buf, show, show_len + 1);
+        storcli_parse(buf, &info);
+        memcpy(buf, drives, drives_len + 1);
+        storcli_parse(buf, &info);
+    }
+    bench_report("storcli_parse only (2 documents)", PARSE_ITERATIONS, bench_now() - start);
+    return 0;
+}
@@ -5,7 +5,8 @@
 #include <syslog.h>
 #include <ctype.h>
 
-#define MAX_LINE 256
+/* 값 필드(최대 256자)와 키, 주석을 넉넉히 담는 길이. 넘는 줄은 경고하고 건너뛴다 */
+#define MAX_LINE 1024
 
 #define CONFIG_FILE "/etc/check_device/check_device.conf"
 
@@ -17,16 +18,64 @@ static void set_default_config(config_t *config) {
     config->cpu_usage_threshold = 80.0;
     config->mem_usage_threshold = 90.0;
     config->disk_usage_threshold = 95.0;
+    config->inode_usage_threshold = 90.0;
+    strncpy(config->disk_mounts, "/", sizeof(config->disk_mounts) - 1);
+    config->disk_mount_thresholds[0] = '\0';
+    config->inode_mount_thresholds[0] = '\0';
+    config->mount_ro_expected[0] = '\0';
     config->cpu_temp_threshold  = 75.0;
+    config->hwmon_enable = 1;
+    config->hwerr_correctable_threshold = 1;
+    config->kmsg_enable = 1;
+    config->kmsg_rate_limit = 60;
+    config->kmsg_extra_pattern[0] = '\0';
+    config->disk_util_threshold = 90.0;
+    config->disk_await_threshold = 100.0;
+    strncpy(config->diskstats_devices, "*", sizeof(config->diskstats_devices) - 1);
+    strncpy(config->diskstats_exclude, "loop*,ram*,zram*,sr*,fd*", sizeof(config->diskstats_exclude) - 1);
+    config->diskstats_include_partitions = 0;
+    config->diskstats_include_dm = 0;
+    config->diskstats_include_md = 1;
+    strncpy(config->raid_backend, "auto", sizeof(config->raid_backend) - 1);
+    strncpy(config->hw_source, "libaxio", sizeof(config->hw_source) - 1);
+    config->hw_helper_timeout = 0;     /* 0이면 수집 주기와 같게 */
+    config->redfish_verify_tls = 1;
+    config->redfish_timeout = 10;
+    config->raid_cache_ttl = 600;
+    config->raid_probe_timeout = 60;
+    config->psi_enable = 1;
+    strncpy(config->psi_cpu_trigger, "some 500000 1000000", sizeof(config->psi_cpu_trigger) - 1);
+    strncpy(config->psi_memory_trigger, "some 150000 1000000", sizeof(config->psi_memory_trigger) - 1);
+    strncpy(config->psi_io_trigger, "some 150000 1000000", sizeof(config->psi_io_trigger) - 1);
     config->net_rx_threshold    = 1000000.0;
     config->net_tx_threshold    = 1000000.0;
+    config->net_rx_util_threshold = 90.0;
+    config->net_tx_util_threshold = 90.0;
     config->snmp_trap_enable    = 1;
     strncpy(config->snmp_trap_dest, "localhost", sizeof(config->snmp_trap_dest) - 1);
     config->snmp_trap_port      = 162;
     config->syslog_enable       = 1;
-    strncpy(config->net_interface, "eth0", sizeof(config->net_interface) - 1);
+    strncpy(config->net_interface, "*", sizeof(config->net_interface) - 1);
     config->csv_retention_days  = 7;
     strncpy(config->snmp_trap_community, "public", sizeof(config->snmp_trap_community) - 1);
+    config->snmp_trap_rate      = 12;
+    config->snmp_trap_burst     = 10;
+    strncpy(config->snmp_trap_type, "trap", sizeof(config->snmp_trap_type) - 1);
+    config->alarm_trigger_samples = 3;
+    config->alarm_clear_samples = 3;
+    config->alarm_hysteresis    = 5.0;
+    config->alarm_renotify_period = 0;
+    config->alarm_rule_count    = 0;
+    config->cpu_interval        = 0;
+    config->mem_interval        = 0;
+    config->disk_interval       = 0;
+    config->diskio_interval     = 0;
+    config->temp_interval       = 0;
+    config->psi_interval        = 0;
+    config->net_interval        = 0;
+    config->raid_interval       = 0;
+    config->fan_interval        = 0;
+    config->power_interval      = 0;
 }
 
 //문자열 양쪽의 공백(whitespace)을 제거
@@ -50,7 +99,20 @@ int check_config(const char *conf_path, config_t *config) {
         return -1;
     }
     char line[MAX_LINE];
+    int lineno = 0;
     while (fgets(line, sizeof(line), fp)) {
+        lineno++;
+        /* 잘린 나머지를 새 줄로 읽으면 엉뚱한 키가 되므로 줄 전체를 버린다 */
+        if (strchr(line, '\n') == NULL && !feof(fp)) {
+            int c = fgetc(fp);
+            if (c != EOF && c != '\n') {
+                syslog(LOG_WARNING, "%s:%d: line longer than %d characters, ignored",
+                       conf_path, lineno, MAX_LINE - 2);
+                while ((c = fgetc(fp)) != EOF && c != '\n')
+                    ;
+                continue;
+            }
+        }
         char *p = trim(line);
         if (p[0] == '#' || p[0] == '\0')
             continue;
@@ -68,12 +130,78 @@ int check_config(const char *conf_path, config_t *config) {
             config->mem_usage_threshold = atof(value);
         else if (strcmp(key, "DISK_USAGE_THRESHOLD") == 0)
             config->disk_usage_threshold = atof(value);
+        else if (strcmp(key, "INODE_USAGE_THRESHOLD") == 0)
+            config->inode_usage_threshold = atof(value);
+        else if (strcmp(key, "DISK_MOUNTS") == 0)
+            strncpy(config->disk_mounts, value, sizeof(config->disk_mounts)-1);
+        else if (strcmp(key, "DISK_MOUNT_THRESHOLDS") == 0)
+            strncpy(config->disk_mount_thresholds, value, sizeof(config->disk_mount_thresholds)-1);
+        else if (strcmp(key, "INODE_MOUNT_THRESHOLDS") == 0)
+            strncpy(config->inode_mount_thresholds, value, sizeof(config->inode_mount_thresholds)-1);
+        else if (strcmp(key, "MOUNT_RO_EXPECTED") == 0)
+            strncpy(config->mount_ro_expected, value, sizeof(config->mount_ro_expected)-1);
         else if (strcmp(key, "CPU_TEMP_THRESHOLD") == 0)
             config->cpu_temp_threshold = atof(value);
+        else if (strcmp(key, "HWMON_ENABLE") == 0)
+            config->hwmon_enable = atoi(value);
+        else if (strcmp(key, "HWERR_CORRECTABLE_THRESHOLD") == 0)
+            config->hwerr_correctable_threshold = atoi(value);
+        else if (strcmp(key, "KMSG_ENABLE") == 0)
+            config->kmsg_enable = atoi(value);
+        else if (strcmp(key, "KMSG_RATE_LIMIT") == 0)
+            config->kmsg_rate_limit = atoi(value);
+        else if (strcmp(key, "KMSG_EXTRA_PATTERN") == 0)
+            strncpy(config->kmsg_extra_pattern, value, sizeof(config->kmsg_extra_pattern)-1);
+        else if (strcmp(key, "DISK_UTIL_THRESHOLD") == 0)
+            config->disk_util_threshold = atof(value);
+        else if (strcmp(key, "DISK_AWAIT_THRESHOLD") == 0)
+            config->disk_await_threshold = atof(value);
+        else if (strcmp(key, "DISKSTATS_DEVICES") == 0)
+            strncpy(config->diskstats_devices, value, sizeof(config->diskstats_devices)-1);
+        else if (strcmp(key, "DISKSTATS_EXCLUDE") == 0)
+            strncpy(config->diskstats_exclude, value, sizeof(config->diskstats_exclude)-1);
+        else if (strcmp(key, "DISKSTATS_INCLUDE_PARTITIONS") == 0)
+            config->diskstats_include_partitions = atoi(value);
+        else if (strcmp(key, "DISKSTATS_INCLUDE_DM") == 0)
+            config->diskstats_include_dm = atoi(value);
+        else if (strcmp(key, "DISKSTATS_INCLUDE_MD") == 0)
+            config->diskstats_include_md = atoi(value);
+        else if (strcmp(key, "RAID_BACKEND") == 0)
+            strncpy(config->raid_backend, value, sizeof(config->raid_backend)-1);
+        else if (strcmp(key, "HW_SOURCE") == 0)
+            strncpy(config->hw_source, value, sizeof(config->hw_source)-1);
+        else if (strcmp(key, "HW_HELPER_TIMEOUT") == 0)
+            config->hw_helper_timeout = atoi(value);
+        else if (strcmp(key, "REDFISH_URL") == 0)
+            strncpy(config->redfish_url, value, sizeof(config->redfish_url)-1);
+        else if (strcmp(key, "REDFISH_USER") == 0)
+            strncpy(config->redfish_user, value, sizeof(config->redfish_user)-1);
+        else if (strcmp(key, "REDFISH_PASSWORD") == 0)
+            strncpy(config->redfish_password, value, sizeof(config->redfish_password)-1);
+        else if (strcmp(key, "REDFISH_VERIFY_TLS") == 0)
+            config->redfish_verify_tls = atoi(value);
+        else if (strcmp(key, "REDFISH_TIMEOUT") == 0)
+            config->redfish_timeout = atoi(value);
+        else if (strcmp(key, "RAID_CACHE_TTL") == 0)
+            config->raid_cache_ttl = atoi(value);
+        else if (strcmp(key, "RAID_PROBE_TIMEOUT") == 0)
+            config->raid_probe_timeout = atoi(value);
+        else if (strcmp(key, "PSI_ENABLE") == 0)
+            config->psi_enable = atoi(value);
+        else if (strcmp(key, "PSI_CPU_TRIGGER") == 0)
+            strncpy(config->psi_cpu_trigger, value, sizeof(config->psi_cpu_trigger)-1);
+        else if (strcmp(key, "PSI_MEMORY_TRIGGER") == 0)
+            strncpy(config->psi_memory_trigger, value, sizeof(config->psi_memory_trigger)-1);
+        else if (strcmp(key, "PSI_IO_TRIGGER") == 0)
+            strncpy(config->psi_io_trigger, value, sizeof(config->psi_io_trigger)-1);
         else if (strcmp(key, "NET_RX_THRESHOLD") == 0)
             config->net_rx_threshold = atof(value);
         else if (strcmp(key, "NET_TX_THRESHOLD") == 0)
             config->net_tx_threshold = atof(value);
+        else if (strcmp(key, "NET_RX_UTIL_THRESHOLD") == 0)
+            config->net_rx_util_threshold = atof(value);
+        else if (strcmp(key, "NET_TX_UTIL_THRESHOLD") == 0)
+            config->net_tx_util_threshold = atof(value);
         else if (strcmp(key, "SNMP_TRAP_ENABLE") == 0)
             config->snmp_trap_enable = atoi(value);
         else if (strcmp(key, "SNMP_TRAP_DEST") == 0)
@@ -88,11 +216,84 @@ int check_config(const char *conf_path, config_t *config) {
             config->csv_retention_days = atoi(value);
         else if (strcmp(key, "SNMP_TRAP_COMMUNITY") == 0)
             strncpy(config->snmp_trap_community, value, sizeof(config->snmp_trap_community)-1);
+        else if (strcmp(key, "SNMP_TRAP_RATE") == 0)
+            config->snmp_trap_rate = atoi(value);
+        else if (strcmp(key, "SNMP_TRAP_BURST") == 0)
+            config->snmp_trap_burst = atoi(value);
+        else if (strcmp(key, "SNMP_TRAP_TYPE") == 0)
+            strncpy(config->snmp_trap_type, value, sizeof(config->snmp_trap_type)-1);
+        else if (strcmp(key, "ALARM_TRIGGER_SAMPLES") == 0)
+            config->alarm_trigger_samples = atoi(value);
+        else if (strcmp(key, "ALARM_CLEAR_SAMPLES") == 0)
+            config->alarm_clear_samples = atoi(value);
+        else if (strcmp(key, "ALARM_HYSTERESIS") == 0)
+            config->alarm_hysteresis = atof(value);
+        else if (strcmp(key, "ALARM_RENOTIFY_PERIOD") == 0)
+            config->alarm_renotify_period = atoi(value);
+        else if (strcmp(key, "ALARM_RULE") == 0) {
+            /* 여러 줄을 쓸 수 있다 */
+            if (config->alarm_rule_count < MAX_ALARM_RULES)
+                strncpy(config->alarm_rules[config->alarm_rule_count++], value, ALARM_RULE_LEN - 1);
+            else
+                syslog(LOG_WARNING, "Too many ALARM_RULE lines, ignoring %s", value);
+        }
+        else if (strcmp(key, "CPU_INTERVAL") == 0)
+            config->cpu_interval = atoi(value);
+        else if (strcmp(key, "MEM_INTERVAL") == 0)
+            config->mem_interval = atoi(value);
+        else if (strcmp(key, "DISK_INTERVAL") == 0)
+            config->disk_interval = atoi(value);
+        else if (strcmp(key, "DISKIO_INTERVAL") == 0)
+            config->diskio_interval = atoi(value);
+        else if (strcmp(key, "PSI_INTERVAL") == 0)
+            config->psi_interval = atoi(value);
+        else if (strcmp(key, "TEMP_INTERVAL") == 0)
+            config->temp_interval = atoi(value);
+        else if (strcmp(key, "NET_INTERVAL") == 0)
+            config->net_interval = atoi(value);
+        else if (strcmp(key, "RAID_INTERVAL") == 0)
+            config->raid_interval = atoi(value);
+        else if (strcmp(key, "FAN_INTERVAL") == 0)
+            config->fan_interval = atoi(value);
+        else if (strcmp(key, "POWER_INTERVAL") == 0)
+            config->power_interval = atoi(value);
+        else if (strcmp(key, "REDFISH_INTERVAL") == 0)
+            config->redfish_interval = atoi(value);
+        else if (strcmp(key, "HWERR_INTERVAL") == 0)
+            config->hwerr_interval = atoi(value);
     }
     fclose(fp);
+
+    /* 팬/전원 결과는 수집 주기마다 한 번 갱신되므로 그보다 짧은 유효 시간은 쓰지 않는다 */
+    int period = hw_poll_period(config);
+    if (config->hw_helper_timeout <= 0) {
+        config->hw_helper_timeout = period;
+    } else if (config->hw_helper_timeout < period) {
+        syslog(LOG_WARNING, "HW_HELPER_TIMEOUT %d is shorter than the fan/power poll period %d, using %d",
+               config->hw_helper_timeout, period, period);
+        config->hw_helper_timeout = period;
+    }
     return 0;
 }
 
+/* 팬/전원 수집 주기 (초). libaxio는 FAN/POWER_INTERVAL 중 짧은 쪽, redfish는 REDFISH_INTERVAL */
+int hw_poll_period(const config_t *config) {
+    if (strcmp(config->hw_source, "redfish") == 0)
+        return config->redfish_interval > 0 ? config->redfish_interval : config->interval_seconds;
+    int fan = config->fan_interval > 0 ? config->fan_interval : config->interval_seconds;
+    int power = config->power_interval > 0 ? config->power_interval : config->interval_seconds;
+    return fan < power ? fan : power;
+}
+
+/* 팬/전원 결과가 이보다 오래되면 stale (초). 결과는 수집 주기마다 쓰이고 감독과 보고는
+   INTERVAL_SECONDS마다 보므로 둘 중 긴 쪽에 HW_HELPER_TIMEOUT을 더한다 */
+int hw_stale_limit(void) {
+    int period = hw_poll_period(&global_config);
+    if (period < global_config.interval_seconds)
+        period = global_config.interval_seconds;
+    return period + global_config.hw_helper_timeout;
+}
+
 
 /* 초기화 시 설정 파일을 읽어 전역 변수에 저장 */
 void init_config(void) {
@@ -100,4 +301,63 @@ void init_config(void) {
         syslog(LOG_ERR, "Failed to read configuration file: %s", CONFIG_FILE);
         /* 실패시 기본값을 설정하거나 종료 처리할 수 있음 */
     }
-}
\ No newline at end of file
+}
+
+/* SIGHUP에 바로 적용하는 항목: 임계치, 알람, 트랩, 기록 설정.
+   이 항목은 메인(스케줄러) 스레드만 읽고, 트랩 송신 스레드는 trapq_reload()로 사본을 받는다 */
+static void copy_reloadable(config_t *dst, const config_t *src) {
+    dst->cpu_usage_threshold = src->cpu_usage_threshold;
+    dst->mem_usage_threshold = src->mem_usage_threshold;
+    dst->disk_usage_threshold = src->disk_usage_threshold;
+    dst->inode_usage_threshold = src->inode_usage_threshold;
+    memcpy(dst->disk_mount_thresholds, src->disk_mount_thresholds, sizeof(dst->disk_mount_thresholds));
+    memcpy(dst->inode_mount_thresholds, src->inode_mount_thresholds, sizeof(dst->inode_mount_thresholds));
+    memcpy(dst->mount_ro_expected, src->mount_ro_expected, sizeof(dst->mount_ro_expected));
+    dst->cpu_temp_threshold = src->cpu_temp_threshold;
+    dst->hwerr_correctable_threshold = src->hwerr_correctable_threshold;
+    dst->kmsg_rate_limit = src->kmsg_rate_limit;
+    dst->disk_util_threshold = src->disk_util_threshold;
+    dst->disk_await_threshold = src->disk_await_threshold;
+    dst->hw_helper_timeout = src->hw_helper_timeout;
+    dst->net_rx_threshold = src->net_rx_threshold;
+    dst->net_tx_threshold = src->net_tx_threshold;
+    dst->net_rx_util_threshold = src->net_rx_util_threshold;
+    dst->net_tx_util_threshold = src->net_tx_util_threshold;
+    dst->snmp_trap_enable = src->snmp_trap_enable;
+    memcpy(dst->snmp_trap_dest, src->snmp_trap_dest, sizeof(dst->snmp_trap_dest));
+    dst->snmp_trap_port = src->snmp_trap_port;
+    dst->syslog_enable = src->syslog_enable;
+    dst->csv_retention_days = src->csv_retention_days;
+    memcpy(dst->snmp_trap_community, src->snmp_trap_community, sizeof(dst->snmp_trap_community));
+    dst->snmp_trap_rate = src->snmp_trap_rate;
+    dst->snmp_trap_burst = src->snmp_trap_burst;
+    memcpy(dst->snmp_trap_type, src->snmp_trap_type, sizeof(dst->snmp_trap_type));
+    dst->alarm_trigger_samples = src->alarm_trigger_samples;
+    dst->alarm_clear_samples = src->alarm_clear_samples;
+    dst->alarm_hysteresis = src->alarm_hysteresis;
+    dst->alarm_renotify_period = src->alarm_renotify_period;
+    memcpy(dst->alarm_rules, src->alarm_rules, sizeof(dst->alarm_rules));
+    dst->alarm_rule_count = src->alarm_rule_count;
+}
+
+/* SIGHUP: 설정 파일을 다시 읽는다. 읽기에 실패하면 기존 설정을 유지한다.
+   메인 스레드에서 호출한다. 수집 주기, 감시 대상 목록, RAID/Redfish 설정처럼 다른 스레드가
+   읽거나 시작할 때만 쓰는 항목은 바꾸지 않고 재시작해야 바뀐다고 알린다 */
+int reload_config(void) {
+    static config_t config;
+    memset(&config, 0, sizeof(config));
+    if (check_config(CONFIG_FILE, &config) != 0) {
+        syslog(LOG_ERR, "Failed to reload configuration file: %s", CONFIG_FILE);
+        return -1;
+    }
+    copy_reloadable(&global_config, &config);
+
+    /* 유효 시간은 새 파일이 아니라 지금 쓰는 수집 주기에 맞춘다 */
+    int period = hw_poll_period(&global_config);
+    if (global_config.hw_helper_timeout < period)
+        global_config.hw_helper_timeout = period;
+
+    if (memcmp(&global_config, &config, sizeof(config)) != 0)
+        syslog(LOG_NOTICE, "Some changed settings (intervals, monitored targets, RAID/Redfish) take effect after restart");
+    return 0;
+}
@@ -1,25 +1,88 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+/* ALARM_RULE 줄 최대 개수와 길이 */
+#define MAX_ALARM_RULES 2048
+#define ALARM_RULE_LEN 128
+
 typedef struct {
     int interval_seconds;
     float cpu_usage_threshold;
     float mem_usage_threshold;
     float disk_usage_threshold;
+    float inode_usage_threshold;
+    char disk_mounts[256];            /* 감시할 마운트 지점 (쉼표 구분, glob 패턴) */
+    char disk_mount_thresholds[256];  /* 마운트별 임계치 "패턴:값,..." */
+    char inode_mount_thresholds[256];
+    char mount_ro_expected[256];      /* 읽기 전용이 정상인 마운트 (쉼표 구분, glob 패턴) */
     float cpu_temp_threshold;
+    int hwmon_enable;                 /* /sys/class/hwmon 센서 수집 */
+    int hwerr_correctable_threshold;  /* 수집 주기당 정정 가능 오류(AER correctable, EDAC CE) 증가 알람 기준 */
+    int kmsg_enable;                  /* /dev/kmsg 커널 로그 감시 */
+    int kmsg_rate_limit;              /* 같은 패턴 알람 최소 간격 (초) */
+    char kmsg_extra_pattern[128];     /* 추가로 감시할 확장 정규식 */
+    float disk_util_threshold;        /* 블록 장치 %util */
+    float disk_await_threshold;       /* 블록 장치 평균 대기 (ms) */
+    char diskstats_devices[256];      /* I/O 통계를 볼 장치 (쉼표 구분, glob 패턴) */
+    char diskstats_exclude[256];
+    int diskstats_include_partitions;
+    int diskstats_include_dm;
+    int diskstats_include_md;
+    char raid_backend[16];            /* auto, megacli, storcli, md, redfish, none */
+    char hw_source[16];               /* 팬/전원 정보 출처: libaxio, redfish */
+    int hw_helper_timeout;            /* 수집 주기가 지난 뒤 팬/전원 결과를 더 기다리는 시간 (초, 수집 주기 이상) */
+    char redfish_url[256];            /* BMC 주소 (예: https://10.0.0.10), 빈 값이면 사용 안 함 */
+    char redfish_user[64];
+    char redfish_password[128];
+    int redfish_verify_tls;
+    int redfish_timeout;              /* 요청당 제한 (초) */
+    int raid_cache_ttl;               /* RAID 점검 결과 유효 시간 (초) */
+    int raid_probe_timeout;           /* RAID 점검 지연 알람 기준 (초) */
+    int psi_enable;
+    char psi_cpu_trigger[64];         /* 예: "some 150000 1000000" (빈 값이면 사용 안 함) */
+    char psi_memory_trigger[64];
+    char psi_io_trigger[64];
     float net_rx_threshold;
     float net_tx_threshold;
+    float net_rx_util_threshold;   /* 링크 속도 대비 % */
+    float net_tx_util_threshold;
     int snmp_trap_enable;
-    char snmp_trap_dest[64];
+    char snmp_trap_dest[256];         /* 쉼표 구분 "host[:port]" 목록 */
     int snmp_trap_port;
     int syslog_enable;
-    char net_interface[64];
+    char net_interface[256];   /* 쉼표로 구분한 이름 또는 glob 패턴 */
     int csv_retention_days;
     char snmp_trap_community[64];
+    int snmp_trap_rate;               /* 반복/이벤트 트랩 OID별 시간당 허용 수 (0이면 제한 없음) */
+    int snmp_trap_burst;              /* 트랩 OID별 연속 허용 수 */
+    char snmp_trap_type[16];          /* "trap" 또는 "inform" */
+    int alarm_trigger_samples;        /* 연속 이 횟수만큼 넘어야 알람 발생 */
+    int alarm_clear_samples;          /* 연속 이 횟수만큼 해제 조건이어야 해제 */
+    float alarm_hysteresis;           /* 해제 임계치 = 임계치보다 이 % 낮은 값 */
+    int alarm_renotify_period;        /* 발생 중인 알람을 다시 알리는 간격 (초, 0이면 안 함) */
+    char alarm_rules[MAX_ALARM_RULES][ALARM_RULE_LEN];  /* ALARM_RULE 줄 (rules.c가 컴파일) */
+    int alarm_rule_count;
+    /* 수집기별 주기 (초, 0이면 interval_seconds) */
+    int cpu_interval;
+    int mem_interval;
+    int disk_interval;
+    int diskio_interval;
+    int temp_interval;
+    int psi_interval;
+    int net_interval;
+    int raid_interval;
+    int fan_interval;
+    int power_interval;
+    int redfish_interval;
+    int hwerr_interval;
 } config_t;
 
 extern config_t global_config;
 
 int check_config(const char *conf_path, config_t *config);
+void init_config(void);
+int reload_config(void);
+int hw_poll_period(const config_t *config);
+int hw_stale_limit(void);
 
 #endif // CONFIG_H
@@ -0,0 +1,149 @@
+#include "executor.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* 자식 프로세스 그룹 전체를 종료하고 회수한다 */
+static void kill_and_reap(pid_t pid, int *status) {
+    kill(-pid, SIGKILL);
+    while (waitpid(pid, status, 0) < 0 && errno == EINTR)
+        ;
+}
+
+/* 셸 없이 argv[0]을 실행하고 표준 출력을 out에 담는다 (NUL로 끝남).
+   posix_spawn(glibc에서는 vfork 방식)으로 띄우고 자식은 자기 프로세스 그룹을 갖는다.
+   timeout_ms가 지나면 프로세스 그룹 전체를 SIGKILL로 종료한다.
+   출력이 out_size를 넘으면 나머지는 읽어서 버린다. */
+int exec_run(char *const argv[], int timeout_ms, char *out, size_t out_size, exec_result_t *res) {
+    int pipefd[2];
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t sigs;
+    pid_t pid;
+    int status = 0;
+
+    memset(res, 0, sizeof(*res));
+    res->exit_status = -1;
+    if (out_size > 0)
+        out[0] = '\0';
+
+    if (pipe2(pipefd, O_CLOEXEC) != 0)
+        return -1;
+    fcntl(pipefd[0], F_SETFL, O_NONBLOCK);
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, pipefd[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    /* 새 프로세스 그룹, 기본 시그널 처리, 빈 시그널 마스크로 시작 */
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setpgroup(&attr, 0);
+    sigemptyset(&sigs);
+    posix_spawnattr_setsigmask(&attr, &sigs);
+    sigaddset(&sigs, SIGPIPE);
+    sigaddset(&sigs, SIGCHLD);
+    posix_spawnattr_setsigdefault(&attr, &sigs);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK |
+                                    POSIX_SPAWN_SETSIGDEF);
+
+    long long start = now_ms();
+    int err = posix_spawn(&pid, argv[0], &actions, &attr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    close(pipefd[1]);
+    if (err != 0) {
+        close(pipefd[0]);
+        syslog(LOG_ERR, "Failed to execute %s: %s", argv[0], strerror(err));
+        return -1;
+    }
+
+    long long deadline = start + timeout_ms;
+    int eof = 0;
+    while (!eof) {
+        long long remaining = deadline - now_ms();
+        if (remaining <= 0) {
+            res->timed_out = 1;
+            break;
+        }
+        struct pollfd pfd = { .fd = pipefd[0], .events = POLLIN };
+        int ready = poll(&pfd, 1, (int)remaining);
+        if (ready < 0 && errno != EINTR)
+            break;
+        if (ready <= 0)
+            continue;
+
+        for (;;) {
+            char discard[4096];
+            char *dst = discard;
+            size_t room = sizeof(discard);
+            if (res->output_len + 1 < out_size) {
+                dst = out + res->output_len;
+                room = out_size - 1 - res->output_len;
+            }
+            ssize_t n = read(pipefd[0], dst, room);
+            if (n > 0) {
+                if (dst == discard)
+                    res->truncated = 1;
+                else
+                    res->output_len += (size_t)n;
+                continue;
+            }
+            if (n == 0)
+                eof = 1;
+            else if (errno == EINTR)
+                continue;
+            break;
+        }
+    }
+    close(pipefd[0]);
+    if (out_size > 0)
+        out[res->output_len] = '\0';
+
+    /* 출력이 끝난 뒤에도 남은 시간 안에서만 종료를 기다린다.
+       WNOWAIT로 좀비 상태를 유지해 두면 프로세스 그룹 번호가 재사용되지 않는다.
+       EOF 직후에는 곧 끝나므로 1ms부터 10ms까지 늘려 가며 확인한다 */
+    long pause_ms = 1;
+    while (!res->timed_out) {
+        siginfo_t info;
+        memset(&info, 0, sizeof(info));
+        if (waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT) < 0 && errno != EINTR)
+            break;
+        if (info.si_pid == pid)
+            break;
+        if (now_ms() >= deadline) {
+            res->timed_out = 1;
+            break;
+        }
+        struct timespec pause = { 0, pause_ms * 1000000 };
+        nanosleep(&pause, NULL);
+        pause_ms = pause_ms * 2 < 10 ? pause_ms * 2 : 10;
+    }
+    /* 자식이 남긴 손자 프로세스까지 프로세스 그룹째 정리하고 회수 */
+    kill_and_reap(pid, &status);
+    if (res->timed_out)
+        syslog(LOG_WARNING, "%s timed out after %d ms, killed", argv[0], timeout_ms);
+
+    res->runtime = (now_ms() - start) / 1000.0;
+    if (WIFEXITED(status))
+        res->exit_status = WEXITSTATUS(status);
+    else if (WIFSIGNALED(status))
+        res->term_signal = WTERMSIG(status);
+    return 0;
+}
@@ -0,0 +1,18 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <stddef.h>
+
+/* 외부 명령 실행 결과 */
+typedef struct {
+    int exit_status;         /* 정상 종료 시 종료 코드, 아니면 -1 */
+    int term_signal;         /* 시그널로 끝났으면 그 번호 */
+    int timed_out;           /* 시간 초과로 프로세스 그룹을 종료시킴 */
+    int truncated;           /* 출력이 버퍼보다 길어 잘림 */
+    size_t output_len;
+    double runtime;          /* 초 */
+} exec_result_t;
+
+int exec_run(char *const argv[], int timeout_ms, char *out, size_t out_size, exec_result_t *res);
+
+#endif // EXECUTOR_H
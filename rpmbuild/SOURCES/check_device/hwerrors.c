@@ -0,0 +1,151 @@
+#include "hwerrors.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <unistd.h>
+#include <syslog.h>
+
+#define MAX_HWERR_COUNTERS 2048
+/* 이만큼의 카운터만 fd를 열어 두고 나머지는 읽을 때마다 연다 (RLIMIT_NOFILE 보호) */
+#define HWERR_CACHED_FDS 256
+
+const char *const hwerr_kind_names[HWERR_KINDS] = {
+    "PCIe AER correctable", "PCIe AER nonfatal", "PCIe AER fatal",
+    "EDAC CE", "EDAC UE", "SCSI I/O error",
+};
+
+/* 감시 대상 카운터 파일. 시작할 때 한 번 만든다 */
+typedef struct {
+    char path[128];
+    char device[64];
+    int kind;
+    int fd;                       /* -1이면 열지 않음 */
+    int primed;                   /* 이전 값이 있음 */
+    unsigned long long last;
+} hwerr_counter_t;
+
+static hwerr_counter_t counters[MAX_HWERR_COUNTERS];
+static int counter_count;
+
+static void add_counter(const char *path, const char *device, int kind) {
+    if (counter_count >= MAX_HWERR_COUNTERS)
+        return;
+    if (access(path, R_OK) != 0)
+        return;
+    hwerr_counter_t *c = &counters[counter_count++];
+    snprintf(c->path, sizeof(c->path), "%s", path);
+    snprintf(c->device, sizeof(c->device), "%s", device);
+    c->kind = kind;
+    c->fd = -1;
+    c->primed = 0;
+}
+
+/* 패턴에 맞는 파일마다 카운터를 더한다. 장치 이름은 경로의 dev_index번째 요소 */
+static void add_glob(const char *pattern, int dev_index, int kind) {
+    glob_t g;
+    if (glob(pattern, 0, NULL, &g) != 0)
+        return;
+    for (size_t i = 0; i < g.gl_pathc; i++) {
+        char device[64] = "";
+        const char *p = g.gl_pathv[i];
+        for (int part = 0; part <= dev_index && p; part++) {
+            p = strchr(p, '/');
+            if (p)
+                p++;
+        }
+        if (p)
+            snprintf(device, sizeof(device), "%.*s", (int)strcspn(p, "/"), p);
+        add_counter(g.gl_pathv[i], device, kind);
+    }
+    globfree(&g);
+}
+
+/* aer_dev_*는 "이름 값" 줄 목록이고 최신 커널은 TOTAL_ERR_* 합계 줄이 있다.
+   합계 줄이 없으면 모두 더한다. ioerr_cnt 같은 단일 값은 0x 접두어 16진수도 받는다 */
+static int parse_counter(char *buf, unsigned long long *out) {
+    unsigned long long sum = 0;
+    int lines = 0;
+    char *save = NULL;
+    for (char *line = strtok_r(buf, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        char *value = strrchr(line, ' ');
+        value = value ? value + 1 : line;
+        unsigned long long v = strtoull(value, NULL, 0);
+        if (strncmp(line, "TOTAL_ERR_", 10) == 0) {
+            *out = v;
+            return 0;
+        }
+        sum += v;
+        lines++;
+    }
+    if (lines == 0)
+        return -1;
+    *out = sum;
+    return 0;
+}
+
+static int read_counter(hwerr_counter_t *c, unsigned long long *value) {
+    char buf[1024];
+    int keep = (c - counters) < HWERR_CACHED_FDS;
+
+    if (c->fd < 0) {
+        c->fd = open(c->path, O_RDONLY | O_CLOEXEC);
+        if (c->fd < 0)
+            return -1;
+    }
+    ssize_t n = pread(c->fd, buf, sizeof(buf) - 1, 0);
+    if (n < 0 && (errno == ENODEV || errno == ESTALE)) {
+        /* 장치가 빠졌다 다시 붙었으면 새로 연다 */
+        close(c->fd);
+        c->fd = open(c->path, O_RDONLY | O_CLOEXEC);
+        n = (c->fd < 0) ? -1 : pread(c->fd, buf, sizeof(buf) - 1, 0);
+    }
+    if (!keep && c->fd >= 0) {
+        close(c->fd);
+        c->fd = -1;
+    }
+    if (n <= 0)
+        return -1;
+    buf[n] = '\0';
+    return parse_counter(buf, value);
+}
+
+/* 카운터 파일을 한 번만 찾아 둔다. 수집 때는 이 표만 읽는다 */
+int hwerrors_init(void) {
+    add_glob("/sys/bus/pci/devices/*/aer_dev_correctable", 4, HWERR_AER_CORRECTABLE);
+    add_glob("/sys/bus/pci/devices/*/aer_dev_nonfatal", 4, HWERR_AER_NONFATAL);
+    add_glob("/sys/bus/pci/devices/*/aer_dev_fatal", 4, HWERR_AER_FATAL);
+    add_glob("/sys/devices/system/edac/mc/mc*/ce_count", 5, HWERR_EDAC_CE);
+    add_glob("/sys/devices/system/edac/mc/mc*/ue_count", 5, HWERR_EDAC_UE);
+    add_glob("/sys/block/*/device/ioerr_cnt", 2, HWERR_SCSI_IOERR);
+    syslog(LOG_INFO, "hwerrors: watching %d error counters", counter_count);
+    return counter_count;
+}
+
+/* 모든 카운터를 읽고 지난 수집 이후 늘어난 것만 돌려준다.
+   첫 읽기와 카운터가 줄어든 경우(장치 재설정)는 기준값만 잡는다.
+   MAX_HWERR_EVENTS를 넘어 싣지 못한 증가는 기준값을 두어 다음 수집에서 보고한다 */
+int get_hwerr_info(HwErrInfo *info) {
+    memset(info, 0, sizeof(*info));
+    info->counters = counter_count;
+    for (int i = 0; i < counter_count; i++) {
+        hwerr_counter_t *c = &counters[i];
+        unsigned long long value;
+        if (read_counter(c, &value) != 0)
+            continue;
+        if (c->primed && value > c->last) {
+            if (info->count >= MAX_HWERR_EVENTS)
+                continue;
+            HwErrEvent *e = &info->events[info->count++];
+            snprintf(e->device, sizeof(e->device), "%s", c->device);
+            e->kind = c->kind;
+            e->total = value;
+            e->delta = value - c->last;
+        }
+        c->last = value;
+        c->primed = 1;
+    }
+    return info->count;
+}
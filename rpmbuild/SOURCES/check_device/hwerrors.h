@@ -0,0 +1,36 @@
+#ifndef HWERRORS_H
+#define HWERRORS_H
+
+#define MAX_HWERR_EVENTS 64
+
+/* 하드웨어 오류 카운터 종류 */
+enum {
+    HWERR_AER_CORRECTABLE = 0,
+    HWERR_AER_NONFATAL,
+    HWERR_AER_FATAL,
+    HWERR_EDAC_CE,
+    HWERR_EDAC_UE,
+    HWERR_SCSI_IOERR,
+    HWERR_KINDS
+};
+
+/* 이번 수집 주기에 늘어난 카운터 */
+typedef struct {
+    char device[64];              /* PCI 주소, mcN, 블록 장치 이름 */
+    int kind;
+    unsigned long long total;
+    unsigned long long delta;
+} HwErrEvent;
+
+typedef struct {
+    int counters;                 /* 감시 중인 카운터 수 */
+    int count;
+    HwErrEvent events[MAX_HWERR_EVENTS];
+} HwErrInfo;
+
+extern const char *const hwerr_kind_names[HWERR_KINDS];
+
+int hwerrors_init(void);
+int get_hwerr_info(HwErrInfo *info);
+
+#endif // HWERRORS_H
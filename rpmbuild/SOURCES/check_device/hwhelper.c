@@ -0,0 +1,216 @@
+#include "hwhelper.h"
+#include "config.h"
+#include "scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+#include "fanmonitor.h"
+
+extern char **environ;
+
+/* 데몬과 보조 프로세스가 함께 매핑하는 결과 영역.
+   seq가 홀수인 동안은 쓰는 중이고, 읽는 쪽은 seq가 앞뒤로 같을 때만 값을 쓴다 (seqlock) */
+typedef struct {
+    unsigned int seq;
+    FanSpeeds fan;
+    PowerInfo power;
+    long long updated_ms;   /* CLOCK_MONOTONIC, 0이면 아직 결과 없음 */
+} hw_shared_t;
+
+static hw_shared_t *shared;
+static int shm_fd = -1;
+static pid_t helper_pid;
+static pid_t killed_pid;        /* SIGKILL을 보냈지만 아직 거두지 못한 보조 프로세스 */
+static long long helper_started_ms;
+static long long first_started_ms;   /* 결과가 한 번도 없을 때 지연 판정 기준 */
+
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* 보조 프로세스 본체: 벤더 라이브러리를 부르고 결과를 공유 메모리에 쓴다.
+   데몬이 없어지면 함께 끝난다. */
+int hw_helper_main(int argc, char *argv[]) {
+    if (argc < 3)
+        return 1;
+    int fd = atoi(argv[2]);
+    hw_shared_t *shm = mmap(NULL, sizeof(hw_shared_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (shm == MAP_FAILED) {
+        syslog(LOG_ERR, "hw helper: mmap failed: %s", strerror(errno));
+        return 1;
+    }
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    if (getppid() == 1)
+        return 0;
+
+    for (;;) {
+        FanInfo raw = get_fan_info();
+        FanSpeeds fan = { raw.cpuFan, raw.auxFan, raw.fan1, raw.fan2, raw.fan3 };
+        PowerInfo power = get_power_info();
+
+        /* 이전 보조 프로세스가 쓰는 도중 죽었으면 seq가 이미 홀수다 */
+        unsigned int seq = __atomic_load_n(&shm->seq, __ATOMIC_RELAXED) | 1;
+        __atomic_store_n(&shm->seq, seq, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        shm->fan = fan;
+        shm->power = power;
+        shm->updated_ms = monotonic_ms();
+        __atomic_store_n(&shm->seq, seq + 1, __ATOMIC_RELEASE);
+
+        sleep(hw_poll_period(&global_config));
+    }
+}
+
+static int spawn_helper(void) {
+    char fd_arg[16];
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t sigs;
+
+    /* memfd는 CLOEXEC이므로 다른 번호로 복제해 넘긴다 (dup2는 복제본의 CLOEXEC를 지운다) */
+    int target = (shm_fd == 3) ? 4 : 3;
+    snprintf(fd_arg, sizeof(fd_arg), "%d", target);
+    char *const argv[] = { "check_device", HW_HELPER_ARG, fd_arg, NULL };
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, shm_fd, target);
+
+    posix_spawnattr_init(&attr);
+    sigemptyset(&sigs);
+    posix_spawnattr_setsigmask(&attr, &sigs);
+    sigaddset(&sigs, SIGPIPE);
+    sigaddset(&sigs, SIGCHLD);
+    posix_spawnattr_setsigdefault(&attr, &sigs);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    int err = posix_spawn(&helper_pid, "/proc/self/exe", &actions, &attr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    if (err != 0) {
+        syslog(LOG_ERR, "Failed to start hw helper: %s", strerror(err));
+        helper_pid = 0;
+        return -1;
+    }
+    helper_started_ms = monotonic_ms();
+    syslog(LOG_INFO, "hw helper started (pid %d)", (int)helper_pid);
+    return 0;
+}
+
+/* 결과가 수집 주기 + HW_HELPER_TIMEOUT 넘게 갱신되지 않으면 보조 프로세스가 멈춘 것으로 본다 */
+static int helper_hung(long long now) {
+    long long last = __atomic_load_n(&shared->updated_ms, __ATOMIC_ACQUIRE);
+    if (last < helper_started_ms)
+        last = helper_started_ms;
+    return now - last > (long long)hw_stale_limit() * 1000;
+}
+
+/* 보조 프로세스 감독: 죽었으면 거두고 다시 띄우고, 멈췄으면 죽인다.
+   벤더 ioctl 안에서 멈춘 프로세스는 SIGKILL 후에도 바로 끝나지 않을 수 있으므로
+   기다리지 않고 다음 주기에 다시 거둔다. 거두기 전에는 새로 띄우지 않는다. */
+static void supervise(void *arg) {
+    (void)arg;
+    int status;
+
+    if (killed_pid > 0 && waitpid(killed_pid, &status, WNOHANG) == killed_pid)
+        killed_pid = 0;
+
+    if (helper_pid > 0) {
+        pid_t r = waitpid(helper_pid, &status, WNOHANG);
+        if (r == helper_pid) {
+            if (WIFSIGNALED(status))
+                syslog(LOG_ERR, "hw helper (pid %d) killed by signal %d, restarting",
+                       (int)helper_pid, WTERMSIG(status));
+            else
+                syslog(LOG_ERR, "hw helper (pid %d) exited with status %d, restarting",
+                       (int)helper_pid, WEXITSTATUS(status));
+            helper_pid = 0;
+        } else if (helper_hung(monotonic_ms())) {
+            syslog(LOG_ERR, "hw helper (pid %d) gave no result for %d seconds, killing",
+                   (int)helper_pid, hw_stale_limit());
+            kill(helper_pid, SIGKILL);
+            killed_pid = helper_pid;
+            helper_pid = 0;
+        }
+    }
+
+    if (helper_pid == 0 && killed_pid == 0)
+        spawn_helper();
+}
+
+/* 공유 메모리를 만들고 보조 프로세스를 띄운 뒤 감독 작업을 스케줄러에 등록한다 */
+int hw_helper_start(void) {
+    shm_fd = memfd_create("check_device-hw", MFD_CLOEXEC);
+    if (shm_fd < 0 || ftruncate(shm_fd, sizeof(hw_shared_t)) != 0) {
+        syslog(LOG_ERR, "hw helper: memfd_create failed: %s", strerror(errno));
+        return -1;
+    }
+    shared = mmap(NULL, sizeof(hw_shared_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if (shared == MAP_FAILED) {
+        shared = NULL;
+        syslog(LOG_ERR, "hw helper: mmap failed: %s", strerror(errno));
+        return -1;
+    }
+    first_started_ms = monotonic_ms();
+    spawn_helper();
+    return scheduler_add_task("hwhelper", global_config.interval_seconds, supervise, NULL);
+}
+
+/* 공유 메모리에서 최신 결과를 기다림 없이 읽는다 */
+void hw_helper_get(HwStatus *status) {
+    memset(status, 0, sizeof(*status));
+    if (shared == NULL) {
+        status->stale = 1;
+        return;
+    }
+
+    /* 쓰는 중이면 양보하며 다시 읽고, 끝내 못 읽으면 (보조 프로세스가 쓰다 죽은 경우 등)
+       마지막으로 온전히 읽은 값을 쓴다 */
+    static FanSpeeds good_fan;
+    static PowerInfo good_power;
+    static long long good_updated;
+    for (int tries = 0; tries < 100; tries++) {
+        unsigned int seq = __atomic_load_n(&shared->seq, __ATOMIC_ACQUIRE);
+        if (!(seq & 1)) {
+            FanSpeeds fan = shared->fan;
+            PowerInfo power = shared->power;
+            long long updated = shared->updated_ms;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&shared->seq, __ATOMIC_RELAXED) == seq) {
+                good_fan = fan;
+                good_power = power;
+                good_updated = updated;
+                break;
+            }
+        }
+        sched_yield();
+    }
+    status->fan = good_fan;
+    status->power = good_power;
+    long long updated = good_updated;
+
+    long long now = monotonic_ms();
+    long long limit = (long long)hw_stale_limit() * 1000;
+    status->updated = (updated != 0);
+    if (!status->updated) {
+        status->age = -1;
+        status->stale = (now - first_started_ms) > limit;
+        return;
+    }
+    status->age = (int)((now - updated) / 1000);
+    status->stale = (now - updated) > limit;
+}
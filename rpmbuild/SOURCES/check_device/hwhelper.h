@@ -0,0 +1,21 @@
+#ifndef HWHELPER_H
+#define HWHELPER_H
+
+#include "metrics.h"
+
+/* 보조 프로세스가 libaxio로 읽은 팬/전원 상태 */
+typedef struct {
+    FanSpeeds fan;
+    PowerInfo power;
+    int updated;       /* 결과가 한 번이라도 있었는지 */
+    int age;           /* 마지막 결과 이후 지난 시간 (초), 결과가 없으면 -1 */
+    int stale;         /* 수집 주기 + HW_HELPER_TIMEOUT 넘게 결과가 갱신되지 않음 (hw_stale_limit) */
+} HwStatus;
+
+#define HW_HELPER_ARG "--hw-helper"
+
+int hw_helper_main(int argc, char *argv[]);
+int hw_helper_start(void);
+void hw_helper_get(HwStatus *status);
+
+#endif // HWHELPER_H
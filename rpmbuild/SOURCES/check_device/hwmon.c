@@ -0,0 +1,296 @@
+#include "hwmon.h"
+#include "config.h"
+#include "scheduler.h"
+#include "procfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <syslog.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+#define HWMON_CLASS "/sys/class/hwmon"
+
+const char *const sensor_units[SENSOR_TYPES] = { "C", "RPM", "V", "W", "A" };
+
+/* 파일 이름 접두어와 sysfs 단위를 표시 단위로 바꾸는 배율 */
+static const struct { const char *prefix; double scale; } sensor_types[SENSOR_TYPES] = {
+    [SENSOR_TEMP]  = { "temp",  1000.0 },     /* m°C */
+    [SENSOR_FAN]   = { "fan",   1.0 },        /* RPM */
+    [SENSOR_IN]    = { "in",    1000.0 },     /* mV */
+    [SENSOR_POWER] = { "power", 1000000.0 },  /* µW */
+    [SENSOR_CURR]  = { "curr",  1000.0 },     /* mA */
+};
+
+/* 시작 시(와 hwmon 핫플러그 때) 만드는 센서 표. 값 파일과 알람 파일은 열어 둔다 */
+typedef struct {
+    char device[16];
+    char chip[32];
+    char label[48];
+    int type;
+    procfile_t input;
+    procfile_t alarm;        /* *_alarm (없으면 path가 빈 값) */
+    procfile_t crit_alarm;   /* temp*_crit_alarm */
+    double min, max, crit;
+} sensor_entry_t;
+
+static sensor_entry_t sensor_table[MAX_SENSORS];
+static int sensor_count;
+static int cpu_sensor = -1;     /* CPU 패키지 온도 센서 번호 */
+static int uevent_fd = -1;
+
+/* 한 번만 읽는 한계값/이름 파일. 실패하면 -1 */
+static int read_small(const char *path, char *buf, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    if (n < 0)
+        return -1;
+    buf[n] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+static double read_limit(const char *dir, const char *base, const char *suffix, double scale) {
+    char path[512], buf[32];
+    snprintf(path, sizeof(path), "%s/%s_%s", dir, base, suffix);
+    if (read_small(path, buf, sizeof(buf)) != 0)
+        return 0;
+    return atof(buf) / scale;
+}
+
+static void open_optional(procfile_t *pf, const char *dir, const char *base, const char *suffix) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s_%s", dir, base, suffix);
+    if (access(path, R_OK) == 0)
+        procfile_init(pf, path);
+    else
+        *pf = (procfile_t)PROCFILE_INIT("");
+}
+
+static void clear_table(void) {
+    for (int i = 0; i < sensor_count; i++) {
+        procfile_close(&sensor_table[i].input);
+        procfile_close(&sensor_table[i].alarm);
+        procfile_close(&sensor_table[i].crit_alarm);
+    }
+    sensor_count = 0;
+    cpu_sensor = -1;
+}
+
+/* "temp3_input" -> 종류 SENSOR_TEMP, base "temp3". 값 파일이 아니면 -1 */
+static int match_input(const char *name, char *base, size_t size) {
+    for (int t = 0; t < SENSOR_TYPES; t++) {
+        size_t plen = strlen(sensor_types[t].prefix);
+        if (strncmp(name, sensor_types[t].prefix, plen) != 0)
+            continue;
+        const char *p = name + plen;
+        if (*p < '0' || *p > '9')
+            continue;
+        while (*p >= '0' && *p <= '9')
+            p++;
+        /* 전력은 드라이버에 따라 power1_average만 있다 */
+        if (strcmp(p, "_input") != 0 &&
+            !(t == SENSOR_POWER && strcmp(p, "_average") == 0))
+            continue;
+        snprintf(base, size, "%.*s", (int)(p - name), name);
+        return t;
+    }
+    return -1;
+}
+
+/* CPU 패키지 온도로 쓸 센서: coretemp "Package id", k10temp "Tdie"/"Tctl" 순 */
+static int cpu_sensor_rank(const sensor_entry_t *e) {
+    if (e->type != SENSOR_TEMP)
+        return 0;
+    if (strcmp(e->chip, "coretemp") == 0 && strncmp(e->label, "Package id", 10) == 0)
+        return 3;
+    if ((strcmp(e->chip, "k10temp") == 0 || strcmp(e->chip, "zenpower") == 0) &&
+        strcmp(e->label, "Tdie") == 0)
+        return 2;
+    if ((strcmp(e->chip, "k10temp") == 0 || strcmp(e->chip, "zenpower") == 0) &&
+        strcmp(e->label, "Tctl") == 0)
+        return 1;
+    return 0;
+}
+
+static void scan_chip(const char *device, const char *dir) {
+    char path[512], chip[32];
+    snprintf(path, sizeof(path), "%s/name", dir);
+    if (read_small(path, chip, sizeof(chip)) != 0)
+        return;
+
+    DIR *d = opendir(dir);
+    if (!d)
+        return;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        char base[32];
+        int type = match_input(de->d_name, base, sizeof(base));
+        if (type < 0)
+            continue;
+        /* power1_input과 power1_average가 둘 다 있으면 input만 쓴다 */
+        if (type == SENSOR_POWER && strstr(de->d_name, "_average")) {
+            snprintf(path, sizeof(path), "%s/%s_input", dir, base);
+            if (access(path, R_OK) == 0)
+                continue;
+        }
+        if (sensor_count >= MAX_SENSORS) {
+            syslog(LOG_WARNING, "More than %d hwmon sensors, ignoring the rest", MAX_SENSORS);
+            break;
+        }
+
+        sensor_entry_t *e = &sensor_table[sensor_count];
+        memset(e, 0, sizeof(*e));
+        snprintf(e->device, sizeof(e->device), "%.*s", (int)sizeof(e->device) - 1, device);
+        snprintf(e->chip, sizeof(e->chip), "%s", chip);
+        e->type = type;
+        snprintf(path, sizeof(path), "%s/%s_label", dir, base);
+        if (read_small(path, e->label, sizeof(e->label)) != 0 || e->label[0] == '\0')
+            snprintf(e->label, sizeof(e->label), "%s", base);
+
+        snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+        procfile_init(&e->input, path);
+        open_optional(&e->alarm, dir, base, "alarm");
+        if (type == SENSOR_TEMP)
+            open_optional(&e->crit_alarm, dir, base, "crit_alarm");
+        else
+            e->crit_alarm = (procfile_t)PROCFILE_INIT("");
+
+        double scale = sensor_types[type].scale;
+        e->min = read_limit(dir, base, "min", scale);
+        e->max = read_limit(dir, base, "max", scale);
+        e->crit = read_limit(dir, base, "crit", scale);
+        if (type == SENSOR_POWER && e->max == 0)
+            e->max = read_limit(dir, base, "cap", scale);
+
+        if (cpu_sensor_rank(e) > (cpu_sensor >= 0 ? cpu_sensor_rank(&sensor_table[cpu_sensor]) : 0))
+            cpu_sensor = sensor_count;
+        sensor_count++;
+    }
+    closedir(d);
+}
+
+/* /sys/class/hwmon/hwmon* 을 훑어 센서 표를 다시 만든다 */
+static void scan_hwmon(void) {
+    clear_table();
+
+    DIR *d = opendir(HWMON_CLASS);
+    if (!d)
+        return;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        if (strncmp(de->d_name, "hwmon", 5) != 0)
+            continue;
+        char dir[512], name_path[600];
+        snprintf(dir, sizeof(dir), HWMON_CLASS "/%s", de->d_name);
+        /* 오래된 드라이버는 속성을 device/ 아래에 둔다 */
+        snprintf(name_path, sizeof(name_path), "%s/name", dir);
+        if (access(name_path, R_OK) != 0)
+            strncat(dir, "/device", sizeof(dir) - strlen(dir) - 1);
+        scan_chip(de->d_name, dir);
+    }
+    closedir(d);
+    syslog(LOG_INFO, "hwmon: %d sensors%s", sensor_count,
+           cpu_sensor >= 0 ? "" : ", no CPU package sensor (using thermal_zone0)");
+}
+
+/* 커널 uevent 중 hwmon 장치가 생기거나 없어진 것이 있으면 표를 다시 만든다 */
+static void on_uevent(int fd, short revents, void *arg) {
+    (void)revents;
+    (void)arg;
+    char buf[4096];
+    int changed = 0;
+    ssize_t n;
+
+    while ((n = recv(fd, buf, sizeof(buf) - 1, MSG_DONTWAIT)) > 0) {
+        buf[n] = '\0';
+        /* "ACTION@devpath\0KEY=VALUE\0..." */
+        for (char *p = buf; p < buf + n; p += strlen(p) + 1) {
+            if (strcmp(p, "SUBSYSTEM=hwmon") == 0) {
+                changed = 1;
+                break;
+            }
+        }
+    }
+    if (changed)
+        scan_hwmon();
+}
+
+/* 센서 표를 만들고 hwmon 핫플러그 알림(uevent)을 스케줄러에 등록한다 */
+int hwmon_init(void) {
+    if (!global_config.hwmon_enable)
+        return 0;
+    scan_hwmon();
+
+    uevent_fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                       NETLINK_KOBJECT_UEVENT);
+    if (uevent_fd < 0)
+        return -1;
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = 1;    /* 커널 uevent */
+    if (bind(uevent_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        syslog(LOG_WARNING, "hwmon: cannot listen for uevents, sensor hotplug is not tracked");
+        close(uevent_fd);
+        uevent_fd = -1;
+        return -1;
+    }
+    return scheduler_add_fd(uevent_fd, POLLIN, on_uevent, NULL);
+}
+
+static int read_value(procfile_t *pf, double *out) {
+    if (pf->path[0] == '\0')
+        return -1;
+    char *buf = procfile_read(pf, NULL);
+    if (!buf)
+        return -1;
+    *out = atof(buf);
+    return 0;
+}
+
+/* 센서 표의 값과 알람 파일을 한 번에 읽는다 */
+int get_sensor_info(SensorInfo *info) {
+    memset(info, 0, sizeof(*info));
+    for (int i = 0; i < sensor_count; i++) {
+        sensor_entry_t *e = &sensor_table[i];
+        double raw, flag;
+        /* 꺼진 센서는 EIO/ENODATA를 돌려준다 */
+        if (read_value(&e->input, &raw) != 0)
+            continue;
+
+        Sensor *s = &info->sensors[info->count++];
+        snprintf(s->device, sizeof(s->device), "%s", e->device);
+        snprintf(s->chip, sizeof(s->chip), "%s", e->chip);
+        snprintf(s->label, sizeof(s->label), "%s", e->label);
+        s->type = e->type;
+        s->value = raw / sensor_types[e->type].scale;
+        s->min = e->min;
+        s->max = e->max;
+        s->crit = e->crit;
+        if ((read_value(&e->alarm, &flag) == 0 && flag != 0) ||
+            (read_value(&e->crit_alarm, &flag) == 0 && flag != 0))
+            s->alarm = 1;
+        if (e->crit > 0 && s->value >= e->crit)
+            s->alarm = 1;
+        if (e->type == SENSOR_FAN && e->min > 0 && s->value < e->min)
+            s->alarm = 1;
+    }
+    return info->count;
+}
+
+/* CPU 패키지 온도 센서가 있으면 그 값을 돌려준다. 없으면 -1 */
+int hwmon_cpu_temperature(float *temp) {
+    double raw;
+    if (cpu_sensor < 0 || read_value(&sensor_table[cpu_sensor].input, &raw) != 0)
+        return -1;
+    *temp = (float)(raw / sensor_types[SENSOR_TEMP].scale);
+    return 0;
+}
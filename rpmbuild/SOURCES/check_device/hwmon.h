@@ -0,0 +1,33 @@
+#ifndef HWMON_H
+#define HWMON_H
+
+#define MAX_SENSORS 128
+
+/* hwmon 센서 종류 (sysfs 파일 이름 접두어) */
+enum { SENSOR_TEMP = 0, SENSOR_FAN, SENSOR_IN, SENSOR_POWER, SENSOR_CURR, SENSOR_TYPES };
+
+/* 센서 한 개의 현재 값과 커널이 알려 준 한계값. 한계값이 없으면 0 */
+typedef struct {
+    char device[16];       /* hwmon 디렉터리 (예: "hwmon3"). 같은 chip이 여러 개일 때 구분용, Redfish는 빈 값 */
+    char chip[32];         /* hwmon name (예: "coretemp", "nct6775") */
+    char label[48];        /* *_label, 없으면 "temp1" 같은 파일 이름 */
+    int type;
+    double value;          /* °C, RPM, V, W, A */
+    double min;
+    double max;
+    double crit;
+    int alarm;             /* 커널 *_alarm 또는 crit/min 한계를 넘음 */
+} Sensor;
+
+typedef struct {
+    int count;
+    Sensor sensors[MAX_SENSORS];
+} SensorInfo;
+
+extern const char *const sensor_units[SENSOR_TYPES];
+
+int hwmon_init(void);
+int get_sensor_info(SensorInfo *info);
+int hwmon_cpu_temperature(float *temp);
+
+#endif // HWMON_H
@@ -0,0 +1,198 @@
+#include "json.h"
+#include <string.h>
+#include <stdlib.h>
+
+typedef struct {
+    char *p;
+    json_fn fn;
+    void *arg;
+    int depth;
+    char in_array[JSON_MAX_DEPTH + 1];  /* 깊이별 컨테이너 종류 */
+    const char *keys[JSON_MAX_DEPTH + 1];
+} json_parser_t;
+
+static void skip_ws(json_parser_t *jp) {
+    while (*jp->p == ' ' || *jp->p == '\t' || *jp->p == '\n' || *jp->p == '\r')
+        jp->p++;
+}
+
+static int hex4(const char *s) {
+    int v = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = s[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= c - '0';
+        else if (c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+        else return -1;
+    }
+    return v;
+}
+
+/* 따옴표 문자열을 그 자리에서 풀어 NUL로 끝낸다. 풀린 결과는 원문보다 길지 않다. */
+static char *parse_string(json_parser_t *jp) {
+    char *src = ++jp->p;
+    char *dst = src;
+    char *start = src;
+    while (*src != '"') {
+        if (*src == '\0')
+            return NULL;
+        if (*src != '\\') {
+            *dst++ = *src++;
+            continue;
+        }
+        src++;
+        switch (*src) {
+        case '"': case '\\': case '/': *dst++ = *src; break;
+        case 'b': *dst++ = '\b'; break;
+        case 'f': *dst++ = '\f'; break;
+        case 'n': *dst++ = '\n'; break;
+        case 'r': *dst++ = '\r'; break;
+        case 't': *dst++ = '\t'; break;
+        case 'u': {
+            int cp = hex4(src + 1);
+            if (cp < 0)
+                return NULL;
+            src += 4;
+            /* 서로게이트 쌍은 풀지 않고 '?'로 둔다 (장치 이름/상태에는 나오지 않음) */
+            if (cp >= 0xD800 && cp <= 0xDFFF) {
+                *dst++ = '?';
+            } else if (cp < 0x80) {
+                *dst++ = (char)cp;
+            } else if (cp < 0x800) {
+                *dst++ = (char)(0xC0 | (cp >> 6));
+                *dst++ = (char)(0x80 | (cp & 0x3F));
+            } else {
+                *dst++ = (char)(0xE0 | (cp >> 12));
+                *dst++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                *dst++ = (char)(0x80 | (cp & 0x3F));
+            }
+            break;
+        }
+        default:
+            return NULL;
+        }
+        src++;
+    }
+    jp->p = src + 1;
+    *dst = '\0';
+    return start;
+}
+
+static int emit(json_parser_t *jp, json_type_t type, const char *key, const char *value) {
+    json_event_t ev = { type, jp->depth, key, value, jp->keys };
+    return jp->fn(&ev, jp->arg);
+}
+
+int json_parse(char *buf, json_fn fn, void *arg) {
+    json_parser_t jp;
+    memset(&jp, 0, sizeof(jp));
+    jp.p = buf;
+    jp.fn = fn;
+    jp.arg = arg;
+    int rc;
+    int expect_value = 1;   /* 컨테이너 시작 직후나 ',' 뒤 */
+    const char *key = NULL;
+
+    for (;;) {
+        skip_ws(&jp);
+        char c = *jp.p;
+
+        if (!expect_value) {
+            /* 값 다음: ',' 또는 컨테이너 닫기, 최상위면 끝 */
+            if (jp.depth == 0) {
+                return (c == '\0') ? 0 : -1;
+            }
+            if (c == ',') {
+                jp.p++;
+                expect_value = 1;
+            } else if (c == (jp.in_array[jp.depth] ? ']' : '}')) {
+                jp.p++;
+                jp.depth--;
+                if ((rc = emit(&jp, jp.in_array[jp.depth + 1] ? JSON_ARRAY_END : JSON_OBJECT_END,
+                               jp.keys[jp.depth], NULL)) != 0)
+                    return rc;
+                continue;
+            } else {
+                return -1;
+            }
+            skip_ws(&jp);
+            c = *jp.p;
+        }
+
+        /* 객체 안이면 "키": 를 먼저 읽는다 */
+        key = NULL;
+        if (jp.depth > 0 && !jp.in_array[jp.depth]) {
+            if (c == '}' && expect_value == 2) {
+                /* 빈 객체 */
+                jp.p++;
+                jp.depth--;
+                if ((rc = emit(&jp, JSON_OBJECT_END, jp.keys[jp.depth], NULL)) != 0)
+                    return rc;
+                expect_value = 0;
+                continue;
+            }
+            if (c != '"' || (key = parse_string(&jp)) == NULL)
+                return -1;
+            skip_ws(&jp);
+            if (*jp.p != ':')
+                return -1;
+            jp.p++;
+            skip_ws(&jp);
+            c = *jp.p;
+        } else if (jp.depth > 0 && c == ']' && expect_value == 2) {
+            /* 빈 배열 */
+            jp.p++;
+            jp.depth--;
+            if ((rc = emit(&jp, JSON_ARRAY_END, jp.keys[jp.depth], NULL)) != 0)
+                return rc;
+            expect_value = 0;
+            continue;
+        }
+
+        if (c == '{' || c == '[') {
+            if (jp.depth >= JSON_MAX_DEPTH)
+                return -1;
+            jp.p++;
+            jp.keys[jp.depth] = key;
+            if ((rc = emit(&jp, c == '{' ? JSON_OBJECT_BEGIN : JSON_ARRAY_BEGIN, key, NULL)) != 0)
+                return rc;
+            jp.depth++;
+            jp.in_array[jp.depth] = (c == '[');
+            jp.keys[jp.depth] = NULL;
+            expect_value = 2;
+            continue;
+        }
+
+        jp.keys[jp.depth] = key;
+        if (c == '"') {
+            char *s = parse_string(&jp);
+            if (s == NULL)
+                return -1;
+            rc = emit(&jp, JSON_STRING, key, s);
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            /* 숫자 뒤 구분자를 잠시 NUL로 바꿔 문자열로 넘긴다 */
+            char *start = jp.p;
+            while (*jp.p && strchr("+-0123456789.eE", *jp.p))
+                jp.p++;
+            char saved = *jp.p;
+            *jp.p = '\0';
+            rc = emit(&jp, JSON_NUMBER, key, start);
+            *jp.p = saved;
+        } else if (strncmp(jp.p, "true", 4) == 0) {
+            jp.p += 4;
+            rc = emit(&jp, JSON_TRUE, key, NULL);
+        } else if (strncmp(jp.p, "false", 5) == 0) {
+            jp.p += 5;
+            rc = emit(&jp, JSON_FALSE, key, NULL);
+        } else if (strncmp(jp.p, "null", 4) == 0) {
+            jp.p += 4;
+            rc = emit(&jp, JSON_NULL, key, NULL);
+        } else {
+            return -1;
+        }
+        if (rc != 0)
+            return rc;
+        expect_value = 0;
+    }
+}
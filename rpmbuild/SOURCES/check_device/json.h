@@ -0,0 +1,34 @@
+#ifndef JSON_H
+#define JSON_H
+
+/* 스트리밍(SAX 방식) JSON 파서. 입력 버퍼를 그 자리에서 잘라 쓰며 메모리를 할당하지 않는다. */
+
+#define JSON_MAX_DEPTH 32
+
+typedef enum {
+    JSON_OBJECT_BEGIN,
+    JSON_OBJECT_END,
+    JSON_ARRAY_BEGIN,
+    JSON_ARRAY_END,
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL
+} json_type_t;
+
+typedef struct {
+    json_type_t type;
+    int depth;                          /* 현재 값의 깊이 (최상위 값은 0) */
+    const char *key;                    /* 객체 멤버면 키, 배열 원소면 NULL */
+    const char *value;                  /* 문자열/숫자 값 (그 외에는 NULL) */
+    const char *const *keys;            /* keys[0..depth]: 깊이별 키 경로 */
+} json_event_t;
+
+/* 콜백이 0이 아닌 값을 돌려주면 파싱을 멈춘다 */
+typedef int (*json_fn)(const json_event_t *ev, void *arg);
+
+/* 성공 0, 문법 오류나 깊이 초과 -1, 콜백 중단은 콜백 반환값 */
+int json_parse(char *buf, json_fn fn, void *arg);
+
+#endif // JSON_H
@@ -0,0 +1,260 @@
+#include "kmsg.h"
+#include "config.h"
+#include "alarms.h"
+#include "scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <regex.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define KMSG_OID ".1.3.6.1.4.1.8072.2.3.0.29"
+
+#define KMSG_PATH "/dev/kmsg"
+#define KMSG_STATE_DIR "/var/lib/check_device"
+#define KMSG_STATE_FILE KMSG_STATE_DIR "/kmsg.seq"
+#define BOOT_ID_PATH "/proc/sys/kernel/random/boot_id"
+/* 읽은 위치 저장과 억제된 알람 요약 주기 (초) */
+#define KMSG_SAVE_PERIOD 10
+#define KMSG_MAX_PATTERNS 16
+
+/* 감시할 커널 메시지. 기본 패턴에 KMSG_EXTRA_PATTERN이 하나 더 붙는다 */
+typedef struct {
+    const char *name;
+    const char *regex;
+    regex_t re;
+    long long last_alarm_ms;      /* 0이면 아직 알람 없음 */
+    unsigned suppressed;          /* 제한 시간 안에 걸러진 건수 */
+    char last_msg[256];           /* 걸러진 것 중 마지막 메시지 */
+} kmsg_pattern_t;
+
+static kmsg_pattern_t patterns[KMSG_MAX_PATTERNS] = {
+    { "machine check", "\\[Hardware Error\\]|Machine [Cc]heck|mce: .*[Ee]rror" },
+    { "I/O error", "I/O error" },
+    { "filesystem error", "EXT[234]-fs (error|\\([^)]*\\): Remounting filesystem read-only)|XFS \\([^)]*\\): (Corruption|Filesystem has been shut down)|BTRFS (error|critical)" },
+    { "out of memory", "Out of memory|oom-kill:|invoked oom-killer" },
+    { "link down", "NIC Link is Down|[Ll]ink is [Dd]own|Link down$" },
+    { "NVMe timeout", "nvme[0-9]+.*(timeout|[Rr]eset|controller is down|Removing after probe failure)" },
+    { "hung task", "blocked for more than [0-9]+ seconds" },
+};
+static int pattern_count = 7;
+
+/* 패턴 중 하나라도 맞는지 먼저 본다. 대부분의 메시지는 여기서 걸러진다 */
+static regex_t prefilter;
+static int prefilter_ok;
+
+static int kmsg_fd = -1;
+static char boot_id[40];
+static unsigned long long skip_seq;   /* 재시작 전에 처리한 마지막 번호 (같은 부팅일 때만) */
+static unsigned long long last_seq;
+static unsigned long long saved_seq;
+static int have_seq;
+
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void read_boot_id(void) {
+    FILE *fp = fopen(BOOT_ID_PATH, "r");
+    boot_id[0] = '\0';
+    if (!fp)
+        return;
+    if (fgets(boot_id, sizeof(boot_id), fp))
+        boot_id[strcspn(boot_id, "\n")] = '\0';
+    fclose(fp);
+}
+
+/* 상태 파일: "<boot_id> <seq>". 같은 부팅이면 1 */
+static int load_state(unsigned long long *seq) {
+    char saved_boot[40];
+    FILE *fp = fopen(KMSG_STATE_FILE, "r");
+    if (!fp)
+        return -1;
+    int n = fscanf(fp, "%39s %llu", saved_boot, seq);
+    fclose(fp);
+    if (n != 2)
+        return -1;
+    return boot_id[0] != '\0' && strcmp(saved_boot, boot_id) == 0;
+}
+
+/* 임시 파일에 쓰고 rename 해서 중간에 죽어도 이전 상태가 남게 한다 */
+static void save_state(void) {
+    char line[80];
+    int len = snprintf(line, sizeof(line), "%s %llu\n", boot_id, last_seq);
+
+    if (mkdir(KMSG_STATE_DIR, 0755) != 0 && errno != EEXIST)
+        return;
+    int fd = open(KMSG_STATE_FILE ".tmp", O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        syslog(LOG_ERR, "kmsg: cannot write %s: %s", KMSG_STATE_FILE, strerror(errno));
+        return;
+    }
+    int ok = write(fd, line, len) == len;
+    close(fd);
+    if (ok && rename(KMSG_STATE_FILE ".tmp", KMSG_STATE_FILE) == 0)
+        saved_seq = last_seq;
+    else
+        unlink(KMSG_STATE_FILE ".tmp");
+}
+
+static void kmsg_alarm(kmsg_pattern_t *p, const char *msg, unsigned suppressed) {
+    char trap[256];
+    snprintf(trap, sizeof(trap), "Kernel %s: %.200s", p->name, msg);
+    if (suppressed)
+        raise_event_alarm(KMSG_OID, trap, "ALARM: kernel %s: %.400s (%u similar messages suppressed)",
+                          p->name, msg, suppressed);
+    else
+        raise_event_alarm(KMSG_OID, trap, "ALARM: kernel %s: %.400s", p->name, msg);
+}
+
+/* 패턴별 KMSG_RATE_LIMIT 초에 한 번만 알람. 걸러진 건수는 다음 알람에 붙인다 */
+static void match_message(const char *msg) {
+    if (prefilter_ok && regexec(&prefilter, msg, 0, NULL, 0) != 0)
+        return;
+    long long now = monotonic_ms();
+    long long limit_ms = (long long)global_config.kmsg_rate_limit * 1000;
+    for (int i = 0; i < pattern_count; i++) {
+        kmsg_pattern_t *p = &patterns[i];
+        if (regexec(&p->re, msg, 0, NULL, 0) != 0)
+            continue;
+        if (p->last_alarm_ms && now - p->last_alarm_ms < limit_ms) {
+            p->suppressed++;
+            snprintf(p->last_msg, sizeof(p->last_msg), "%s", msg);
+        } else {
+            kmsg_alarm(p, msg, p->suppressed);
+            p->suppressed = 0;
+            p->last_alarm_ms = now;
+        }
+        /* 한 메시지는 처음 맞은 패턴으로만 알린다 */
+        return;
+    }
+}
+
+/* 레코드: "우선순위,번호,시각(us),플래그[,...];메시지\n" 뒤에 " KEY=값" 줄이 붙을 수 있다 */
+static void handle_record(char *rec) {
+    unsigned pri;
+    unsigned long long seq;
+    char *msg = strchr(rec, ';');
+    if (!msg || sscanf(rec, "%u,%llu,", &pri, &seq) != 2)
+        return;
+    msg++;
+    msg[strcspn(msg, "\n")] = '\0';
+
+    if (have_seq && seq > last_seq + 1)
+        syslog(LOG_WARNING, "kmsg: %llu kernel messages lost before they could be read", seq - last_seq - 1);
+    last_seq = seq;
+    have_seq = 1;
+    if (seq <= skip_seq)
+        return;
+    /* 커널 facility만 본다. 사용자 공간이 /dev/kmsg에 쓴 메시지는 facility가 1 이상이다 */
+    if ((pri >> 3) != 0)
+        return;
+    match_message(msg);
+}
+
+/* 읽을 수 있는 레코드를 모두 처리한다 (read 한 번에 레코드 하나) */
+static void on_kmsg(int fd, short revents, void *arg) {
+    char rec[8192];
+    (void)revents;
+    (void)arg;
+
+    for (;;) {
+        ssize_t n = read(fd, rec, sizeof(rec) - 1);
+        if (n > 0) {
+            rec[n] = '\0';
+            handle_record(rec);
+            continue;
+        }
+        /* EPIPE: 읽기 전에 링 버퍼에서 밀려난 레코드가 있음. 다음 레코드부터 계속 */
+        if (n < 0 && errno == EPIPE)
+            continue;
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && errno != EAGAIN) {
+            syslog(LOG_ERR, "kmsg: read failed, disabling: %s", strerror(errno));
+            scheduler_remove_fd(fd);
+            close(fd);
+            kmsg_fd = -1;
+        }
+        return;
+    }
+}
+
+/* 제한 시간이 지난 억제 알람을 요약해서 보내고 읽은 위치를 저장한다 */
+static void kmsg_task(void *arg) {
+    (void)arg;
+    long long now = monotonic_ms();
+    long long limit_ms = (long long)global_config.kmsg_rate_limit * 1000;
+    for (int i = 0; i < pattern_count; i++) {
+        kmsg_pattern_t *p = &patterns[i];
+        if (p->suppressed && now - p->last_alarm_ms >= limit_ms) {
+            kmsg_alarm(p, p->last_msg, p->suppressed - 1);
+            p->suppressed = 0;
+            p->last_alarm_ms = now;
+        }
+    }
+    if (have_seq && last_seq != saved_seq)
+        save_state();
+}
+
+static int compile_patterns(void) {
+    char combined[2048] = "";
+    size_t len = 0;
+    int n = 0;
+
+    if (global_config.kmsg_extra_pattern[0] != '\0' && pattern_count < KMSG_MAX_PATTERNS) {
+        patterns[pattern_count].name = "custom pattern";
+        patterns[pattern_count].regex = global_config.kmsg_extra_pattern;
+        pattern_count++;
+    }
+    for (int i = 0; i < pattern_count; i++) {
+        if (regcomp(&patterns[i].re, patterns[i].regex, REG_EXTENDED | REG_NOSUB) != 0) {
+            syslog(LOG_ERR, "kmsg: invalid pattern \"%s\", ignored", patterns[i].regex);
+            continue;
+        }
+        if (len < sizeof(combined))
+            len += snprintf(combined + len, sizeof(combined) - len, "%s(%s)", n ? "|" : "", patterns[i].regex);
+        patterns[n++] = patterns[i];
+    }
+    pattern_count = n;
+    /* 합친 식이 너무 길면 사전 검사 없이 패턴을 하나씩 본다 */
+    if (n > 0 && len < sizeof(combined))
+        prefilter_ok = regcomp(&prefilter, combined, REG_EXTENDED | REG_NOSUB) == 0;
+    return n;
+}
+
+/* KMSG_ENABLE이면 /dev/kmsg를 비차단으로 열어 스케줄러에서 POLLIN을 기다린다.
+   같은 부팅에서 재시작했으면 저장한 번호 다음부터, 새 부팅이면 링 버퍼 처음부터,
+   저장한 상태가 없으면 지금 이후의 메시지부터 본다 */
+int kmsg_init(void) {
+    if (!global_config.kmsg_enable)
+        return 0;
+    if (compile_patterns() == 0)
+        return -1;
+
+    kmsg_fd = open(KMSG_PATH, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (kmsg_fd < 0) {
+        syslog(LOG_WARNING, "kmsg: cannot open %s: %s", KMSG_PATH, strerror(errno));
+        return -1;
+    }
+    read_boot_id();
+    unsigned long long seq = 0;
+    int same_boot = load_state(&seq);
+    if (same_boot == 1) {
+        skip_seq = seq;
+        saved_seq = seq;
+    } else if (same_boot < 0) {
+        lseek(kmsg_fd, 0, SEEK_END);
+    }
+
+    scheduler_add_task("kmsg", KMSG_SAVE_PERIOD, kmsg_task, NULL);
+    return scheduler_add_fd(kmsg_fd, POLLIN, on_kmsg, NULL);
+}
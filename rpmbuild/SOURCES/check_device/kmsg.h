@@ -0,0 +1,7 @@
+#ifndef KMSG_H
+#define KMSG_H
+
+/* /dev/kmsg 커널 로그 감시 (MCE, I/O 오류, 파일시스템 오류, OOM, 링크 다운 등) */
+int kmsg_init(void);
+
+#endif // KMSG_H
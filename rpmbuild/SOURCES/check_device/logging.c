@@ -1,5 +1,6 @@
 #include "logging.h"
 #include "metrics.h"
+#include "snapshot.h"
 #include "config.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,8 +10,8 @@
 #include <string.h>
 #include <dirent.h>
 #include <ctype.h>
-
-#include "fanmonitor.h"
+#include <ftw.h>
+#include <syslog.h>
 
 #define PROCESS_NAME "check_device"
 #define LOG_DIR "/var/log/check_device"
@@ -28,11 +29,37 @@ void ensure_log_dir(void) {
     }
 }
 
+/* 열 구성이 바뀌는 CSV(장치별 열 등)의 헤더를 관리한다.
+   새 파일이거나 마지막으로 쓴 헤더와 다르면 헤더 줄을 다시 쓴다.
+   재시작 직후에는 파일에 남은 마지막 헤더 줄과 비교한다. */
+static void write_header_if_changed(FILE *fp, const char *path, int is_new,
+                                    const char *header, char *last, size_t last_size) {
+    if (!is_new && last[0] == '\0') {
+        FILE *in = fopen(path, "r");
+        if (in) {
+            char *line = NULL;
+            size_t cap = 0;
+            ssize_t n;
+            while ((n = getline(&line, &cap, in)) > 0) {
+                if (strncmp(line, "Timestamp,", 10) == 0) {
+                    line[strcspn(line, "\n")] = '\0';
+                    snprintf(last, last_size, "%s", line);
+                }
+            }
+            free(line);
+            fclose(in);
+        }
+    }
+    if (is_new || strcmp(last, header) != 0) {
+        fprintf(fp, "%s\n", header);
+        snprintf(last, last_size, "%s", header);
+    }
+}
+
 /* CSV 파일에 기본 지표와 하드웨어 종속 지표를 분리하여 기록하는 함수 */
 /* Timestamp 형식(YYYY-MM-DDTHH:MM:SS)으로 기록 */
-void write_csv_log(void) {
-    time_t now = time(NULL);
-    struct tm *tm_info = localtime(&now);
+void write_csv_log(const snapshot_t *snap) {
+    struct tm *tm_info = localtime(&snap->timestamp);
     char timestamp[32];
     /* ISO 8601 형식의 Timestamp 생성: ex) 2025-03-21T17:56:51 */
     strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", tm_info);
@@ -50,20 +77,38 @@ void write_csv_log(void) {
     char basic_csv[512];
     snprintf(basic_csv, sizeof(basic_csv), "%s/basic_%04d%02d%02d.csv", 
              daily_dir, tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday);
-    int basic_header = (access(basic_csv, F_OK) != 0);
+    int basic_new = (access(basic_csv, F_OK) != 0);
     FILE *fp_basic = fopen(basic_csv, "a");
     if (fp_basic != NULL) {
-        if (basic_header) {
-            /* 헤더: Timestamp와 각 지표 및 단위 */
-            fprintf(fp_basic, "Timestamp,CPU Usage (%%),Memory Usage (%%),Disk Usage (%%),CPU Temp (°C),Net RX (bytes/sec),Net TX (bytes/sec)\n");
+        /* 헤더: Timestamp와 각 지표 및 단위, 이어서 블록 장치별 I/O 열 */
+        static char last_basic_header[8192];
+        char header[8192];
+        int len = snprintf(header, sizeof(header),
+                           "Timestamp,CPU Usage (%%),Memory Usage (%%),Disk Usage (%%),CPU Temp (°C),Net RX (bytes/sec),Net TX (bytes/sec),"
+                           "CPU PSI some avg10 (%%),Memory PSI some avg10 (%%),Memory PSI full avg10 (%%),"
+                           "IO PSI some avg10 (%%),IO PSI full avg10 (%%)");
+        for (int i = 0; i < snap->diskio.count && len < (int)sizeof(header); i++) {
+            const char *dev = snap->diskio.disks[i].name;
+            len += snprintf(header + len, sizeof(header) - len,
+                            ",%s IOPS,%s Read (bytes/sec),%s Write (bytes/sec),%s Await (ms),%s Util (%%)",
+                            dev, dev, dev, dev, dev);
         }
-        float cpu_usage = get_cpu_usage();
-        float mem_usage = get_memory_usage();
-        float disk_usage = get_disk_usage();
-        float cpu_temp = get_cpu_temperature();
-        float rx_rate = 0, tx_rate = 0;
-        get_network_traffic(&rx_rate, &tx_rate);
-        fprintf(fp_basic, "%s,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", timestamp, cpu_usage, mem_usage, disk_usage, cpu_temp, rx_rate, tx_rate);
+        write_header_if_changed(fp_basic, basic_csv, basic_new, header,
+                                last_basic_header, sizeof(last_basic_header));
+
+        fprintf(fp_basic, "%s,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f", timestamp,
+                snap->cpu_usage, snap->mem_usage, snap->disk_usage,
+                snap->cpu_temp, snap->net.rx_rate, snap->net.tx_rate);
+        fprintf(fp_basic, ",%.2f,%.2f,%.2f,%.2f,%.2f",
+                snap->psi.some_avg10[PSI_CPU], snap->psi.some_avg10[PSI_MEMORY],
+                snap->psi.full_avg10[PSI_MEMORY], snap->psi.some_avg10[PSI_IO],
+                snap->psi.full_avg10[PSI_IO]);
+        for (int i = 0; i < snap->diskio.count; i++) {
+            const DiskIo *io = &snap->diskio.disks[i];
+            fprintf(fp_basic, ",%.1f,%.1f,%.1f,%.1f,%.1f",
+                    io->iops, io->read_bps, io->write_bps, io->await_ms, io->util);
+        }
+        fprintf(fp_basic, "\n");
         fclose(fp_basic);
     }
 
@@ -71,38 +116,180 @@ void write_csv_log(void) {
     char hwinfo_csv[512];
     snprintf(hwinfo_csv, sizeof(hwinfo_csv), "%s/hwinfo_%04d%02d%02d.csv",
              daily_dir, tm_info->tm_year+1900, tm_info->tm_mon+1, tm_info->tm_mday);
-    int hwinfo_header = (access(hwinfo_csv, F_OK) == 0) ? 0 : 1;
+    int hwinfo_new = (access(hwinfo_csv, F_OK) != 0);
     FILE *fp_hwinfo = fopen(hwinfo_csv, "a");
     if (fp_hwinfo != NULL) {
-        if (hwinfo_header) {
-            /* 헤더 순서:
-               Timestamp, RAID State, RAID Level, Slot 0 Status, Slot 1 Status,
-               Power1, Power2,
-               CPU Fan (RPM), Aux Fan (RPM), FAN1 (RPM), FAN2 (RPM), FAN3 (RPM)
-            */
-            fprintf(fp_hwinfo, "Timestamp,RAID State,RAID Level,Slot 0 Status,Slot 1 Status,Power1,Power2,CPU Fan (RPM),Aux Fan (RPM),FAN1 (RPM),FAN2 (RPM),FAN3 (RPM)\n");
+        /* 헤더: 고정 열 뒤에 VD별 상태 열, 드라이브별(어댑터:인클로저:슬롯) 상태/오류 열 */
+        const RaidInfo *raidInfo = &snap->raid.info;
+        static char last_hwinfo_header[32768];
+        char header[32768];
+        int len = snprintf(header, sizeof(header),
+                           "Timestamp,RAID State,RAID Level,Power1,Power2,"
+                           "CPU Fan (RPM),Aux Fan (RPM),FAN1 (RPM),FAN2 (RPM),FAN3 (RPM),"
+                           "RAID Data Age (s),RAID Stale,HW Data Age (s),HW Stale");
+        for (int i = 0; i < raidInfo->vd_count && len < (int)sizeof(header); i++) {
+            const RaidVd *vd = &raidInfo->vds[i];
+            len += snprintf(header + len, sizeof(header) - len,
+                            ",VD %d/%d State,VD %d/%d Level",
+                            vd->adapter, vd->id, vd->adapter, vd->id);
+        }
+        for (int i = 0; i < raidInfo->pd_count && len < (int)sizeof(header); i++) {
+            const RaidPd *pd = &raidInfo->pds[i];
+            char id[48];
+            if (pd->device[0])
+                snprintf(id, sizeof(id), "%s", pd->device);
+            else
+                snprintf(id, sizeof(id), "%d:%d:%d", pd->adapter, pd->enclosure, pd->slot);
+            len += snprintf(header + len, sizeof(header) - len,
+                            ",PD %s Status,PD %s Media Errors,PD %s Predictive Failures",
+                            id, id, id);
         }
-        RaidInfo raidInfo = get_raid_info();
-        FanInfo fanInfo = get_fan_info();
+        write_header_if_changed(fp_hwinfo, hwinfo_csv, hwinfo_new, header,
+                                last_hwinfo_header, sizeof(last_hwinfo_header));
 
-        PowerInfo powerInfo = get_power_info();
+        long raid_age = snap->raid.updated ? (long)(snap->timestamp - snap->raid.updated) : -1;
+        const FanSpeeds *fanInfo = &snap->fan;
+        const PowerInfo *powerInfo = &snap->power;
 
-        fprintf(fp_hwinfo, "%s,%s,%s,%s,%s,%s,%s,%d,%d,%d,%d,%d\n",
+        fprintf(fp_hwinfo, "%s,%s,%s,%s,%s,%d,%d,%d,%d,%d,%ld,%d,%d,%d",
             timestamp,
-            raidInfo.raid_state,
-            raidInfo.raid_level,
-            raidInfo.ssd0_status,
-            raidInfo.ssd1_status,
-            powerInfo.power1,
-            powerInfo.power2,
-            fanInfo.cpuFan,
-            fanInfo.auxFan,
-            fanInfo.fan1,
-            fanInfo.fan2,
-            fanInfo.fan3);
+            raidInfo->raid_state,
+            raidInfo->raid_level,
+            powerInfo->power1,
+            powerInfo->power2,
+            fanInfo->cpuFan,
+            fanInfo->auxFan,
+            fanInfo->fan1,
+            fanInfo->fan2,
+            fanInfo->fan3,
+            raid_age,
+            snap->raid.stale,
+            snap->hw_age,
+            snap->hw_stale);
+        for (int i = 0; i < raidInfo->vd_count; i++)
+            fprintf(fp_hwinfo, ",%s,%s", raidInfo->vds[i].state, raidInfo->vds[i].level);
+        /* 드라이브 상태에는 ", Spun Up" 처럼 쉼표가 들어가므로 따옴표로 감싼다 */
+        for (int i = 0; i < raidInfo->pd_count; i++) {
+            const RaidPd *pd = &raidInfo->pds[i];
+            fprintf(fp_hwinfo, ",\"%s\",%u,%u", pd->state, pd->media_errors, pd->predictive_failures);
+        }
+        fprintf(fp_hwinfo, "\n");
         fclose(fp_hwinfo);
     }
 
+    /* 인터페이스별 네트워크 CSV 파일: netif_YYYYMMDD.csv (인터페이스당 한 줄) */
+    char netif_csv[sizeof(daily_dir) + 64];
+    snprintf(netif_csv, sizeof(netif_csv), "%s/netif_%04d%02d%02d.csv",
+             daily_dir, tm_info->tm_year+1900, tm_info->tm_mon+1, tm_info->tm_mday);
+    int netif_header = (access(netif_csv, F_OK) != 0);
+    FILE *fp_netif = fopen(netif_csv, "a");
+    if (fp_netif != NULL) {
+        if (netif_header) {
+            fprintf(fp_netif, "Timestamp,Interface,Speed (Mb/s),RX (bytes/sec),TX (bytes/sec),RX Util (%%),TX Util (%%),"
+                              "RX (packets/sec),TX (packets/sec),RX Errors,TX Errors,RX Drops,TX Drops\n");
+        }
+        for (int i = 0; i < snap->net.count; i++) {
+            const NetIface *nif = &snap->net.ifaces[i];
+            fprintf(fp_netif, "%s,%s,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%llu,%llu,%llu,%llu\n",
+                    timestamp, nif->name, nif->speed_mbps,
+                    nif->rx_rate, nif->tx_rate, nif->rx_util, nif->tx_util,
+                    nif->rx_pps, nif->tx_pps,
+                    nif->rx_errors, nif->tx_errors, nif->rx_dropped, nif->tx_dropped);
+        }
+        fclose(fp_netif);
+    }
+
+    /* 센서별 CSV 파일: sensors_YYYYMMDD.csv (센서당 한 줄) */
+    char sensors_csv[sizeof(daily_dir) + 64];
+    snprintf(sensors_csv, sizeof(sensors_csv), "%s/sensors_%04d%02d%02d.csv",
+             daily_dir, tm_info->tm_year+1900, tm_info->tm_mon+1, tm_info->tm_mday);
+    int sensors_header = (access(sensors_csv, F_OK) != 0);
+    FILE *fp_sensors = (snap->sensors.count > 0) ? fopen(sensors_csv, "a") : NULL;
+    if (fp_sensors != NULL) {
+        if (sensors_header) {
+            fprintf(fp_sensors, "Timestamp,Device,Chip,Sensor,Value,Unit,Min,Max,Crit,Alarm\n");
+        }
+        for (int i = 0; i < snap->sensors.count; i++) {
+            const Sensor *s = &snap->sensors.sensors[i];
+            fprintf(fp_sensors, "%s,%s,%s,\"%s\",%.3f,%s,%.3f,%.3f,%.3f,%d\n",
+                    timestamp, s->device, s->chip, s->label, s->value, sensor_units[s->type],
+                    s->min, s->max, s->crit, s->alarm);
+        }
+        fclose(fp_sensors);
+    }
+
+    /* 하드웨어 오류 CSV 파일: hwerrors_YYYYMMDD.csv (직전 보고 이후 늘어난 카운터당 한 줄) */
+    if (snap->hwerr.count > 0) {
+        char hwerr_csv[sizeof(daily_dir) + 64];
+        snprintf(hwerr_csv, sizeof(hwerr_csv), "%s/hwerrors_%04d%02d%02d.csv",
+                 daily_dir, tm_info->tm_year+1900, tm_info->tm_mon+1, tm_info->tm_mday);
+        int hwerr_header = (access(hwerr_csv, F_OK) != 0);
+        FILE *fp_hwerr = fopen(hwerr_csv, "a");
+        if (fp_hwerr != NULL) {
+            if (hwerr_header) {
+                fprintf(fp_hwerr, "Timestamp,Device,Counter,Increase,Total\n");
+            }
+            for (int i = 0; i < snap->hwerr.count; i++) {
+                const HwErrEvent *e = &snap->hwerr.events[i];
+                fprintf(fp_hwerr, "%s,%s,%s,%llu,%llu\n", timestamp, e->device,
+                        hwerr_kind_names[e->kind], e->delta, e->total);
+            }
+            fclose(fp_hwerr);
+        }
+    }
+
+    /* SNMP 트랩 큐 CSV 파일: traps_YYYYMMDD.csv (트랩을 쓸 때만) */
+    if (global_config.snmp_trap_enable == 1) {
+        char traps_csv[sizeof(daily_dir) + 64];
+        snprintf(traps_csv, sizeof(traps_csv), "%s/traps_%04d%02d%02d.csv",
+                 daily_dir, tm_info->tm_year+1900, tm_info->tm_mon+1, tm_info->tm_mday);
+        int traps_header = (access(traps_csv, F_OK) != 0);
+        FILE *fp_traps = fopen(traps_csv, "a");
+        if (fp_traps != NULL) {
+            if (traps_header) {
+                fprintf(fp_traps, "Timestamp,Queue Depth,Queued,Sent,Dropped (Queue Full),Dropped (Rate Limit),"
+                                  "Send Errors,Destinations,Last Latency (ms),Max Latency (ms)\n");
+            }
+            const TrapQueueStats *q = &snap->trapq;
+            fprintf(fp_traps, "%s,%u,%lu,%lu,%lu,%lu,%lu,%d,%.3f,%.3f\n", timestamp,
+                    q->depth, q->queued, q->sent, q->dropped_full, q->dropped_rate,
+                    q->send_errors, q->destinations, q->latency_last_ms, q->latency_max_ms);
+            fclose(fp_traps);
+        }
+    }
+
+    /* 마운트별 CSV 파일: mounts_YYYYMMDD.csv (마운트당 한 줄) */
+    char mounts_csv[sizeof(daily_dir) + 64];
+    snprintf(mounts_csv, sizeof(mounts_csv), "%s/mounts_%04d%02d%02d.csv",
+             daily_dir, tm_info->tm_year+1900, tm_info->tm_mon+1, tm_info->tm_mday);
+    int mounts_header = (access(mounts_csv, F_OK) != 0);
+    FILE *fp_mounts = fopen(mounts_csv, "a");
+    if (fp_mounts != NULL) {
+        if (mounts_header) {
+            fprintf(fp_mounts, "Timestamp,Mount,Filesystem,Read-only,Disk Usage (%%),Inode Usage (%%)\n");
+        }
+        for (int i = 0; i < snap->mounts.count; i++) {
+            const MountUsage *m = &snap->mounts.mounts[i];
+            fprintf(fp_mounts, "%s,%s,%s,%d,%.1f,%.1f\n",
+                    timestamp, m->mountpoint, m->fstype, m->readonly,
+                    m->block_usage, m->inode_usage);
+        }
+        fclose(fp_mounts);
+    }
+}
+
+static int remove_entry(const char *path, const struct stat *sb, int typeflag, struct FTW *ftwbuf) {
+    (void)sb;
+    (void)typeflag;
+    (void)ftwbuf;
+    if (remove(path) != 0)
+        syslog(LOG_WARNING, "Failed to remove %s", path);
+    return 0;
+}
+
+/* 디렉토리를 하위 항목부터 지운다 (셸 rm -rf 대신 프로세스 안에서 처리) */
+static void remove_tree(const char *dir_path) {
+    nftw(dir_path, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
 }
 
 /* CSV 로그 보관 기간 초과된 디렉토리를 삭제하는 함수 */
@@ -149,12 +336,10 @@ void cleanup_old_csv_logs(void) {
 
                 double diff_days = difftime(now, dir_time) / (60 * 60 * 24);
                 if (diff_days > retention) {
-                    // 해당 디렉토리 삭제 (rm -rf 사용)
+                    // 해당 디렉토리 삭제
                     char dir_path[512];
                     snprintf(dir_path, sizeof(dir_path), "%s/%s", LOG_DIR, entry->d_name);
-                    char cmd[1024];
-                    snprintf(cmd, sizeof(cmd), "rm -rf \"%s\"", dir_path);
-                    system(cmd);
+                    remove_tree(dir_path);
                 }
             }
         }
@@ -1,8 +1,10 @@
 #ifndef LOGGING_H
 #define LOGGING_H
 
+#include "snapshot.h"
+
 void ensure_log_dir(void);
-void write_csv_log(void);
+void write_csv_log(const snapshot_t *snap);
 void cleanup_old_csv_logs(void);
 
 #endif // LOGGING_H
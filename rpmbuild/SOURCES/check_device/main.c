@@ -1,26 +1,111 @@
 #include "daemon.h"
 #include "alarms.h"
+#include "rules.h"
+#include "trapq.h"
 #include "logging.h"
 #include "config.h"
+#include "snapshot.h"
+#include "scheduler.h"
+#include "mounts.h"
+#include "psi.h"
+#include "hwmon.h"
+#include "hwerrors.h"
+#include "kmsg.h"
+#include "hwhelper.h"
+#include "redfish.h"
+#include "raidworker.h"
 #include <syslog.h>
+#include <string.h>
 #include <unistd.h>
+#include <time.h>
+#include <signal.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/signalfd.h>
+
+/* 수집기들이 채우는 최신 지표 스냅샷 */
+static snapshot_t snapshot;
+
+/* 보고 주기: 스냅샷 기준으로 알람 판정 및 CSV 기록 */
+static void report_cycle(void *arg) {
+    snapshot_t *snap = arg;
+    snap->timestamp = time(NULL);
+    check_and_alarm(snap);
+    write_csv_log(snap);
+    /* 하드웨어 오류 증가분은 알람과 CSV에 반영했으므로 비운다 */
+    snap->hwerr.count = 0;
+    cleanup_old_csv_logs();
+}
+
+/* SIGHUP: 설정을 다시 읽고 임계치 규칙과 트랩 대상 주소를 다시 만든다 */
+static void on_sighup(int fd, short revents, void *arg) {
+    struct signalfd_siginfo si;
+    (void)revents;
+    (void)arg;
+    while (read(fd, &si, sizeof(si)) == sizeof(si))
+        ;
+    syslog(LOG_NOTICE, "SIGHUP received, reloading configuration");
+    if (reload_config() == 0) {
+        rules_compile();
+        mounts_reload();
+        trapq_reload(&global_config);
+    }
+}
+
+/* 스레드와 보조 프로세스를 만들기 전에 SIGHUP을 막아 두고 signalfd로 받는다 */
+static void watch_sighup(void) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGHUP);
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) != 0)
+        return;
+    int fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0) {
+        syslog(LOG_ERR, "signalfd failed: %s", strerror(errno));
+        return;
+    }
+    scheduler_add_fd(fd, POLLIN, on_sighup, NULL);
+}
+
+int main(int argc, char *argv[]) {
+    /* 팬/전원 보조 프로세스로 실행된 경우 */
+    if (argc > 1 && strcmp(argv[1], HW_HELPER_ARG) == 0) {
+        openlog("check_device-hw", LOG_PID, LOG_DAEMON);
+        init_config();
+        return hw_helper_main(argc, argv);
+    }
 
-int main(void) {
     //daemonize();
 
     //syslog 열기
     openlog("check_device", LOG_PID, LOG_DAEMON);
 
     init_config();
+    rules_compile();
 
     ensure_log_dir();
 
-    while (1) {
-        check_and_alarm();
-        write_csv_log();
-        cleanup_old_csv_logs();
-        sleep(global_config.interval_seconds);
-    }
+    /* timerfd를 만들지 못하면 scheduler_run()이 poll() 타임아웃으로 대신한다 */
+    scheduler_init();
+    watch_sighup();
+    trapq_init(&global_config);
+    mounts_init();
+    psi_init();
+    hwmon_init();
+    hwerrors_init();
+    kmsg_init();
+    redfish_init();
+    if (strcmp(global_config.hw_source, "redfish") != 0)
+        hw_helper_start();
+    /* RAID 장치가 없는 서버에서는 점검 워커를 띄우지 않는다 */
+    if (raid_backend_init() != NULL)
+        raid_worker_start();
+
+    /* 수집기를 먼저 등록해야 같은 마감 시각에서 보고보다 먼저 실행된다 */
+    snapshot_init(&snapshot);
+    scheduler_add_task("report", global_config.interval_seconds, report_cycle, &snapshot);
+
+    scheduler_run();
 
     //syslog 닫기
     closelog();
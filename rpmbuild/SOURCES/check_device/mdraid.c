@@ -0,0 +1,246 @@
+#include "mdraid.h"
+#include "procfile.h"
+#include "procparse.h"
+#include "scheduler.h"
+#include "raidworker.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <syslog.h>
+
+#define MD_SYSFS "/sys/block"
+
+/* 변경 알림을 받는 속성. sync_completed는 동기화 중 계속 바뀌므로 알림은 받지 않고 읽기만 한다 */
+static const char *const watch_attrs[MD_WATCH_ATTRS] = { "array_state", "degraded", "sync_action" };
+
+/* 메인 스레드(스케줄러)에서 감시하는 fd. 워커의 읽기 fd와 나누지 않는다 */
+static procfile_t mdstat_watch = PROCFILE_INIT("/proc/mdstat");
+static procfile_t attr_watch[RAID_MAX_VDS][MD_WATCH_ATTRS];
+static int attr_watch_count;
+
+/* 워커 스레드에서 읽는 /proc/mdstat */
+static procfile_t mdstat = PROCFILE_INIT("/proc/mdstat");
+
+/* 작은 sysfs 속성을 읽어 끝의 개행을 지운다. 실패하면 -1 */
+static int read_attr(const char *path, char *buf, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    if (n < 0)
+        return -1;
+    buf[n] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+/* /proc/mdstat의 배열 줄 "md0 : active raid1 sdb1[1] sda1[0]"을 차례로 돌려준다.
+   name에는 배열 이름, 반환값은 줄의 나머지 (상태 이후) */
+static char *next_array(char **cursor, char **name) {
+    char *line;
+    while ((line = parse_next_line(cursor)) != NULL) {
+        if (strncmp(line, "md", 2) != 0)
+            continue;
+        char *rest = line;
+        char *tok = parse_next_token(&rest);
+        char *colon = parse_next_token(&rest);
+        if (tok && colon && strcmp(colon, ":") == 0) {
+            *name = tok;
+            return rest;
+        }
+    }
+    return NULL;
+}
+
+/* 알림을 받은 속성은 처음부터 다시 읽어야 다음 알림이 온다 */
+static void on_attr_change(int fd, short revents, void *arg) {
+    (void)fd;
+    (void)revents;
+    procfile_read(arg, NULL);
+    raid_worker_kick();
+}
+
+/* 배열 목록에 맞춰 속성 감시를 다시 등록한다.
+   등록하지 못한 속성은 mdstat 알림과 RAID_INTERVAL 점검이 대신한다 */
+static void rebuild_attr_watches(void) {
+    for (int i = 0; i < attr_watch_count; i++) {
+        for (size_t a = 0; a < MD_WATCH_ATTRS; a++) {
+            if (attr_watch[i][a].fd >= 0)
+                scheduler_remove_fd(attr_watch[i][a].fd);
+            procfile_close(&attr_watch[i][a]);
+        }
+    }
+    attr_watch_count = 0;
+
+    char *cursor = procfile_read(&mdstat_watch, NULL);
+    char *name;
+    while (cursor && attr_watch_count < RAID_MAX_VDS && next_array(&cursor, &name) != NULL) {
+        for (size_t a = 0; a < MD_WATCH_ATTRS; a++) {
+            char path[256];
+            procfile_t *pf = &attr_watch[attr_watch_count][a];
+            snprintf(path, sizeof(path), MD_SYSFS "/%s/md/%s", name, watch_attrs[a]);
+            procfile_init(pf, path);
+            if (procfile_read(pf, NULL) != NULL && scheduler_add_fd(pf->fd, POLLPRI, on_attr_change, pf) != 0)
+                procfile_close(pf);
+        }
+        attr_watch_count++;
+    }
+}
+
+/* /proc/mdstat은 배열이 생기거나 상태가 바뀌면 POLLPRI를 준다 */
+static void on_mdstat_change(int fd, short revents, void *arg) {
+    (void)fd;
+    (void)revents;
+    (void)arg;
+    rebuild_attr_watches();
+    raid_worker_kick();
+}
+
+/* 동작 중인 md 배열이 하나라도 있으면 1 */
+int md_detect(void) {
+    char *cursor = procfile_read(&mdstat_watch, NULL);
+    char *name;
+    return (cursor && next_array(&cursor, &name) != NULL) ? 1 : 0;
+}
+
+/* 메인 스레드에서 한 번 호출: mdstat과 배열별 속성 변경 알림을 스케줄러에 등록한다.
+   배열 추가/삭제를 놓치지 않도록 mdstat을 먼저 등록한다 */
+int md_watch_init(void) {
+    if (procfile_read(&mdstat_watch, NULL) == NULL ||
+        scheduler_add_fd(mdstat_watch.fd, POLLPRI, on_mdstat_change, NULL) != 0)
+        return -1;
+    rebuild_attr_watches();
+    return 0;
+}
+
+/* 멤버 장치 상태 "in_sync", "faulty", "spare" 등을 MegaCli 표기로 바꾼다 */
+static void member_state(const char *state, char *out, size_t size) {
+    if (strstr(state, "faulty"))
+        snprintf(out, size, "Failed");
+    else if (strstr(state, "in_sync"))
+        snprintf(out, size, "Online");
+    else if (strstr(state, "spare"))
+        snprintf(out, size, "Hotspare");
+    else
+        snprintf(out, size, "%s", state);
+}
+
+static void read_members(const char *array, RaidVd *vd, RaidInfo *info) {
+    char dir_path[256];
+    snprintf(dir_path, sizeof(dir_path), MD_SYSFS "/%s/md", array);
+    DIR *dir = opendir(dir_path);
+    if (!dir)
+        return;
+
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        if (strncmp(de->d_name, "dev-", 4) != 0)
+            continue;
+        if (info->pd_count >= RAID_MAX_PDS)
+            break;
+
+        char path[544], buf[48];
+        RaidPd *pd = &info->pds[info->pd_count++];
+        memset(pd, 0, sizeof(*pd));
+        pd->adapter = vd->adapter;
+        pd->vd = vd->id;
+        pd->enclosure = -1;
+        pd->slot = -1;
+        snprintf(pd->device, sizeof(pd->device), "%s", de->d_name + 4);
+
+        snprintf(path, sizeof(path), "%s/%s/slot", dir_path, de->d_name);
+        if (read_attr(path, buf, sizeof(buf)) == 0 && strcmp(buf, "none") != 0)
+            pd->slot = atoi(buf);
+        snprintf(path, sizeof(path), "%s/%s/state", dir_path, de->d_name);
+        if (read_attr(path, buf, sizeof(buf)) == 0)
+            member_state(buf, pd->state, sizeof(pd->state));
+        /* 읽기 오류를 고친 횟수 */
+        snprintf(path, sizeof(path), "%s/%s/errors", dir_path, de->d_name);
+        if (read_attr(path, buf, sizeof(buf)) == 0)
+            pd->media_errors = (unsigned int)strtoul(buf, NULL, 10);
+    }
+    closedir(dir);
+}
+
+/* sync_completed "done / total" (섹터)를 %로, 진행 중이 아니면 -1 */
+static float sync_percent(const char *array) {
+    char path[256], buf[64];
+    unsigned long long done, total;
+    snprintf(path, sizeof(path), MD_SYSFS "/%s/md/sync_completed", array);
+    if (read_attr(path, buf, sizeof(buf)) != 0 ||
+        sscanf(buf, "%llu / %llu", &done, &total) != 2 || total == 0)
+        return -1;
+    return (float)done * 100 / total;
+}
+
+/* 배열 상태를 MegaCli VD 상태 표기로 정한다. 스크럽(check/repair)은 정상으로 본다 */
+static void array_state(const char *array, char *out, size_t size) {
+    char path[256], state[32] = "", degraded[16] = "0", action[32] = "idle";
+
+    snprintf(path, sizeof(path), MD_SYSFS "/%s/md/array_state", array);
+    read_attr(path, state, sizeof(state));
+    snprintf(path, sizeof(path), MD_SYSFS "/%s/md/degraded", array);
+    read_attr(path, degraded, sizeof(degraded));
+    snprintf(path, sizeof(path), MD_SYSFS "/%s/md/sync_action", array);
+    read_attr(path, action, sizeof(action));
+
+    float pct = sync_percent(array);
+    if (strcmp(state, "inactive") == 0 || strcmp(state, "clear") == 0 ||
+        strcmp(state, "broken") == 0) {
+        snprintf(out, size, "Offline (%s)", state);
+    } else if (atoi(degraded) > 0) {
+        if (strcmp(action, "recover") == 0 && pct >= 0)
+            snprintf(out, size, "Degraded, Rebuild %.1f%%", pct);
+        else
+            snprintf(out, size, "Degraded");
+    } else if (strcmp(action, "resync") == 0 || strcmp(action, "recover") == 0 ||
+               strcmp(action, "reshape") == 0) {
+        if (pct >= 0)
+            snprintf(out, size, "Resync %.1f%%", pct);
+        else
+            snprintf(out, size, "Resync");
+    } else {
+        snprintf(out, size, "Optimal");
+    }
+}
+
+/* /proc/mdstat의 배열마다 sysfs에서 상태와 멤버를 읽어 RaidInfo를 채운다. 배열이 없으면 -1 */
+int md_get_info(RaidInfo *info) {
+    char *cursor = procfile_read(&mdstat, NULL);
+    char *name, *rest;
+    if (!cursor)
+        return -1;
+
+    info->adapter_count = 1;
+    while ((rest = next_array(&cursor, &name)) != NULL) {
+        if (info->vd_count >= RAID_MAX_VDS) {
+            syslog(LOG_WARNING, "More than %d md arrays, ignoring the rest", RAID_MAX_VDS);
+            break;
+        }
+        RaidVd *vd = &info->vds[info->vd_count++];
+        memset(vd, 0, sizeof(*vd));
+        vd->adapter = 0;
+        vd->id = (strncmp(name, "md", 2) == 0) ? atoi(name + 2) : info->vd_count - 1;
+
+        /* "active raid1 ...", "active (auto-read-only) raid1 ...", "inactive sda[0](S)" */
+        char *tok;
+        while ((tok = parse_next_token(&rest)) != NULL) {
+            if (strncmp(tok, "raid", 4) == 0) {
+                snprintf(vd->level, sizeof(vd->level), "%s", tok + 4);
+                break;
+            }
+            if (strcmp(tok, "linear") == 0 || strcmp(tok, "multipath") == 0) {
+                snprintf(vd->level, sizeof(vd->level), "%s", tok);
+                break;
+            }
+        }
+        array_state(name, vd->state, sizeof(vd->state));
+        read_members(name, vd, info);
+    }
+    return info->vd_count > 0 ? 0 : -1;
+}
@@ -0,0 +1,14 @@
+#ifndef MDRAID_H
+#define MDRAID_H
+
+#include "metrics.h"
+
+/* 배열마다 변경 알림을 받는 sysfs 속성 수. 스케줄러에는 mdstat과 함께 최대 MD_WATCH_FDS개를 등록한다 */
+#define MD_WATCH_ATTRS 3
+#define MD_WATCH_FDS (1 + RAID_MAX_VDS * MD_WATCH_ATTRS)
+
+int md_detect(void);
+int md_watch_init(void);
+int md_get_info(RaidInfo *info);
+
+#endif // MDRAID_H
@@ -0,0 +1,248 @@
+#include "megacli.h"
+#include "procparse.h"
+#include "executor.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <syslog.h>
+
+/* MegaCli 출력 버퍼. RAID 점검은 워커 스레드에서만 호출된다 */
+static char megacli_output[256 * 1024];
+
+/* 앞뒤 공백 제거 (그 자리에서) */
+static char *strip(char *s) {
+    while (isspace((unsigned char)*s))
+        s++;
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1]))
+        *--end = '\0';
+    return s;
+}
+
+/* "Key   : Value" 줄을 키와 값으로 나눈다. ':'가 없으면 값은 NULL */
+static char *split_key(char *line, char **value) {
+    char *colon = strchr(line, ':');
+    if (!colon) {
+        *value = NULL;
+        return strip(line);
+    }
+    *colon = '\0';
+    *value = strip(colon + 1);
+    return strip(line);
+}
+
+/* "Primary-1, Secondary-0, RAID Level Qualifier-0" -> "1" */
+static void parse_raid_level(const char *value, char *level, size_t size) {
+    const char *p = strstr(value, "Primary-");
+    if (p)
+        snprintf(level, size, "%d", atoi(p + 8));
+    else
+        snprintf(level, size, "%s", value);
+}
+
+/* "32" -> 32, 직결 드라이브의 "N/A" -> -1 */
+static int parse_id(const char *value) {
+    return isdigit((unsigned char)*value) ? atoi(value) : -1;
+}
+
+static void note_adapter(RaidInfo *info, int adapter) {
+    if (adapter + 1 > info->adapter_count)
+        info->adapter_count = adapter + 1;
+}
+
+/* 물리 드라이브 블록의 한 줄. 아는 키면 1 */
+static int parse_pd_field(RaidPd *pd, const char *key, const char *value) {
+    if (strcmp(key, "Enclosure Device ID") == 0)
+        pd->enclosure = parse_id(value);
+    else if (strcmp(key, "Slot Number") == 0)
+        pd->slot = parse_id(value);
+    else if (strcmp(key, "Media Error Count") == 0)
+        pd->media_errors = (unsigned int)strtoul(value, NULL, 10);
+    else if (strcmp(key, "Other Error Count") == 0)
+        pd->other_errors = (unsigned int)strtoul(value, NULL, 10);
+    else if (strcmp(key, "Predictive Failure Count") == 0)
+        pd->predictive_failures = (unsigned int)strtoul(value, NULL, 10);
+    else if (strcmp(key, "Firmware state") == 0)
+        snprintf(pd->state, sizeof(pd->state), "%s", value);
+    else
+        return 0;
+    return 1;
+}
+
+static void init_pd(RaidPd *pd, int adapter) {
+    memset(pd, 0, sizeof(*pd));
+    pd->adapter = adapter;
+    pd->vd = -1;
+    pd->enclosure = -1;
+    pd->slot = -1;
+}
+
+/* MegaCli64 -PDList -aALL 출력으로 PD 표를 채운다. VD 멤버가 아닌 드라이브
+   (Unconfigured(bad), Failed, Hotspare, JBOD 등)도 모두 나온다. 출력 버퍼는 그 자리에서
+   잘라 쓴다. 파싱한 PD 수를 돌려준다. */
+int megacli_parse_pdlist(char *output, RaidInfo *info) {
+    char *cursor = output;
+    char *line;
+    int adapter = -1;
+    RaidPd *pd = NULL;
+    int truncated = 0;
+
+    while ((line = parse_next_line(&cursor)) != NULL) {
+        char *value;
+        char *key = split_key(line, &value);
+
+        /* "Adapter #0" */
+        if (strncmp(key, "Adapter #", 9) == 0 && value == NULL) {
+            adapter = atoi(key + 9);
+            note_adapter(info, adapter);
+            pd = NULL;
+            continue;
+        }
+        if (value == NULL)
+            continue;
+
+        /* 드라이브 블록은 "Enclosure Device ID"로 시작한다 */
+        if (strcmp(key, "Enclosure Device ID") == 0) {
+            if (info->pd_count >= RAID_MAX_PDS) {
+                pd = NULL;
+                truncated = 1;
+                continue;
+            }
+            pd = &info->pds[info->pd_count++];
+            init_pd(pd, adapter);
+        }
+        if (pd)
+            parse_pd_field(pd, key, value);
+    }
+    if (truncated)
+        syslog(LOG_WARNING, "MegaCli output has more than %d PDs, ignoring the rest", RAID_MAX_PDS);
+    return info->pd_count;
+}
+
+/* -LdPdInfo의 VD 멤버 드라이브를 PD 표에 반영한다. -PDList에서 받은 드라이브면
+   소속 VD만 적고, 없으면 (-PDList 실패 등) 멤버 정보로 새로 넣는다 */
+static int add_member(RaidInfo *info, const RaidPd *member) {
+    for (int i = 0; i < info->pd_count; i++) {
+        RaidPd *pd = &info->pds[i];
+        if (pd->adapter == member->adapter && pd->enclosure == member->enclosure &&
+            pd->slot == member->slot) {
+            pd->vd = member->vd;
+            return 0;
+        }
+    }
+    if (info->pd_count >= RAID_MAX_PDS)
+        return -1;
+    info->pds[info->pd_count++] = *member;
+    return 0;
+}
+
+/* MegaCli64 -LdPdInfo -aALL 출력 전체를 파싱하여 어댑터/VD 표를 채우고
+   PD 표에 VD 소속을 적는다. 출력 버퍼는 그 자리에서 잘라 쓴다. 파싱한 VD 수를 돌려준다. */
+int megacli_parse(char *output, RaidInfo *info) {
+    char *cursor = output;
+    char *line;
+    int adapter = -1;
+    RaidVd *vd = NULL;
+    RaidPd member;
+    int in_pd = 0;
+    int truncated = 0;
+
+    while ((line = parse_next_line(&cursor)) != NULL) {
+        char *value;
+        char *key = split_key(line, &value);
+        int block_end = (strncmp(key, "Adapter #", 9) == 0 && value == NULL) ||
+                        (value != NULL && (strcmp(key, "Virtual Drive") == 0 || strcmp(key, "PD") == 0));
+
+        if (block_end && in_pd) {
+            if (add_member(info, &member) != 0)
+                truncated = 1;
+            in_pd = 0;
+        }
+
+        /* "Adapter #0" */
+        if (strncmp(key, "Adapter #", 9) == 0 && value == NULL) {
+            adapter = atoi(key + 9);
+            note_adapter(info, adapter);
+            vd = NULL;
+            continue;
+        }
+        if (value == NULL)
+            continue;
+
+        /* "Virtual Drive: 0 (Target Id: 0)" */
+        if (strcmp(key, "Virtual Drive") == 0) {
+            if (info->vd_count >= RAID_MAX_VDS) {
+                vd = NULL;
+                truncated = 1;
+                continue;
+            }
+            vd = &info->vds[info->vd_count++];
+            memset(vd, 0, sizeof(*vd));
+            vd->adapter = adapter;
+            vd->id = atoi(value);
+            continue;
+        }
+        /* "PD: 0 Information" - 현재 VD에 속한 물리 드라이브 */
+        if (strcmp(key, "PD") == 0) {
+            init_pd(&member, adapter);
+            member.vd = vd ? vd->id : -1;
+            in_pd = 1;
+            continue;
+        }
+
+        if (in_pd) {
+            parse_pd_field(&member, key, value);
+        } else if (vd) {
+            if (strcmp(key, "RAID Level") == 0) {
+                parse_raid_level(value, vd->level, sizeof(vd->level));
+            } else if (strcmp(key, "State") == 0) {
+                snprintf(vd->state, sizeof(vd->state), "%s", value);
+            } else if (strcmp(key, "Span Depth") == 0 && atoi(value) > 1) {
+                /* 스팬이 여러 개면 RAID 10/50/60 */
+                size_t len = strlen(vd->level);
+                if (len > 0 && len + 1 < sizeof(vd->level) && vd->level[len - 1] != '0')
+                    strcat(vd->level, "0");
+            }
+        }
+    }
+    if (in_pd && add_member(info, &member) != 0)
+        truncated = 1;
+    if (truncated)
+        syslog(LOG_WARNING, "MegaCli output has more than %d VDs or %d PDs, ignoring the rest",
+               RAID_MAX_VDS, RAID_MAX_PDS);
+    return info->vd_count;
+}
+
+/* MegaCli64를 셸 없이 실행한다. 실패하거나 시간 초과면 -1 */
+static int run_megacli(char *const argv[], RaidInfo *info) {
+    exec_result_t res;
+    if (exec_run(argv, global_config.raid_probe_timeout * 1000,
+                 megacli_output, sizeof(megacli_output), &res) != 0)
+        return -1;
+    if (res.timed_out) {
+        info->timed_out = 1;
+        return -1;
+    }
+    if (res.exit_status != 0)
+        syslog(LOG_WARNING, "%s %s exited with status %d after %.1fs",
+               argv[0], argv[1], res.exit_status, res.runtime);
+    return 0;
+}
+
+/* -PDList로 모든 물리 드라이브를 받고 -LdPdInfo로 VD와 소속을 받는다. VD가 없으면 -1 */
+int megacli_get_info(RaidInfo *info) {
+    char *const pdlist[] = { MEGACLI_PATH, "-PDList", "-aALL", "-NoLog", NULL };
+    char *const ldpdinfo[] = { MEGACLI_PATH, "-LdPdInfo", "-aALL", "-NoLog", NULL };
+
+    /* 실패해도 -LdPdInfo의 멤버 드라이브는 본다. 시간 초과면 두 번째도 기다리지 않는다 */
+    if (run_megacli(pdlist, info) == 0)
+        megacli_parse_pdlist(megacli_output, info);
+    else if (info->timed_out)
+        return -1;
+    if (run_megacli(ldpdinfo, info) != 0)
+        return -1;
+    return megacli_parse(megacli_output, info) > 0 ? 0 : -1;
+}
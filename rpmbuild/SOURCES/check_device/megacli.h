@@ -0,0 +1,12 @@
+#ifndef MEGACLI_H
+#define MEGACLI_H
+
+#include "metrics.h"
+
+#define MEGACLI_PATH "/opt/MegaRAID/MegaCli/MegaCli64"
+
+int megacli_parse_pdlist(char *output, RaidInfo *info);
+int megacli_parse(char *output, RaidInfo *info);
+int megacli_get_info(RaidInfo *info);
+
+#endif // MEGACLI_H
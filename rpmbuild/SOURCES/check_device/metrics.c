@@ -1,4 +1,13 @@
 #include "metrics.h"
+#include "config.h"
+#include "procfile.h"
+#include "procparse.h"
+#include "executor.h"
+#include "megacli.h"
+#include "storcli.h"
+#include "mdraid.h"
+#include "hwmon.h"
+#include "redfish.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -6,6 +15,8 @@
 #include <string.h>
 #include <syslog.h>
 #include <ctype.h>
+#include <time.h>
+#include <fnmatch.h>
 
 // CPU 시간을 읽어들이기 위한 구조체 및 내부 함수
 typedef struct {
@@ -19,51 +30,70 @@ typedef struct {
     unsigned long long steal;
 } cpu_times_t;
 
+/* 주기마다 다시 읽는 /proc, /sys 파일 핸들 */
+static procfile_t proc_stat = PROCFILE_INIT("/proc/stat");
+static procfile_t proc_meminfo = PROCFILE_INIT("/proc/meminfo");
+static procfile_t thermal_temp = PROCFILE_INIT("/sys/class/thermal/thermal_zone0/temp");
+static procfile_t proc_diskstats = PROCFILE_INIT("/proc/diskstats");
+
 static int read_cpu_times(cpu_times_t *times) {
-    FILE *fp = fopen("/proc/stat", "r");
-    if (!fp)
+    char *buffer = procfile_read(&proc_stat, NULL);
+    if (!buffer)
         return -1;
-    char buffer[256];
-    if (!fgets(buffer, sizeof(buffer), fp)) {
-        fclose(fp);
+    /* 첫 줄: "cpu  user nice system idle iowait irq softirq steal ..." */
+    char *cursor = buffer;
+    char *line = parse_next_line(&cursor);
+    if (!line || strncmp(line, "cpu ", 4) != 0)
         return -1;
-    }
-    fclose(fp);
-    int ret = sscanf(buffer, "cpu  %llu %llu %llu %llu %llu %llu %llu %llu",
-                     &times->user, &times->nice, &times->system, &times->idle,
-                     &times->iowait, &times->irq, &times->softirq, &times->steal);
+    unsigned long long v[8] = {0};
+    int ret = parse_u64_fields(line + 4, v, 8);
+    times->user = v[0];
+    times->nice = v[1];
+    times->system = v[2];
+    times->idle = v[3];
+    times->iowait = v[4];
+    times->irq = v[5];
+    times->softirq = v[6];
+    times->steal = v[7];
     return (ret >= 4) ? 0 : -1;
 }
 
+/* 이전 수집 시점의 CPU 카운터. 0으로 시작하므로 첫 호출은 부팅 이후 평균이 된다 */
+static cpu_times_t prev_cpu;
+
+/* sleep 없이 직전 호출 이후 전체 구간의 CPU 사용률을 계산 */
 float get_cpu_usage(void) {
-    cpu_times_t t1, t2;
-    if (read_cpu_times(&t1) != 0)
-        return -1;
-    sleep(1);
-    if (read_cpu_times(&t2) != 0)
+    cpu_times_t cur;
+    if (read_cpu_times(&cur) != 0)
         return -1;
-    unsigned long long total1 = t1.user + t1.nice + t1.system + t1.idle +
-                                  t1.iowait + t1.irq + t1.softirq + t1.steal;
-    unsigned long long total2 = t2.user + t2.nice + t2.system + t2.idle +
-                                  t2.iowait + t2.irq + t2.softirq + t2.steal;
+    cpu_times_t *t1 = &prev_cpu, *t2 = &cur;
+    unsigned long long total1 = t1->user + t1->nice + t1->system + t1->idle +
+                                  t1->iowait + t1->irq + t1->softirq + t1->steal;
+    unsigned long long total2 = t2->user + t2->nice + t2->system + t2->idle +
+                                  t2->iowait + t2->irq + t2->softirq + t2->steal;
+    unsigned long long idle1 = t1->idle + t1->iowait;
+    unsigned long long idle2 = t2->idle + t2->iowait;
+    prev_cpu = cur;
+    /* iowait는 감소할 수 있으므로 역행한 구간은 0으로 처리 */
+    if (total2 <= total1 || idle2 < idle1)
+        return 0;
     unsigned long long total_diff = total2 - total1;
-    unsigned long long idle_diff = (t2.idle + t2.iowait) - (t1.idle + t1.iowait);
-    return (total_diff == 0) ? 0 : (float)(total_diff - idle_diff) / total_diff * 100;
+    unsigned long long idle_diff = idle2 - idle1;
+    if (idle_diff > total_diff)
+        return 0;
+    return (float)(total_diff - idle_diff) / total_diff * 100;
 }
 
 float get_memory_usage(void) {
-    FILE *fp = fopen("/proc/meminfo", "r");
-    if (!fp)
+    char *buf = procfile_read(&proc_meminfo, NULL);
+    if (!buf)
         return -1;
-    char line[256];
     unsigned long long memTotal = 0, memAvailable = 0;
-    while (fgets(line, sizeof(line), fp)) {
-        if (sscanf(line, "MemTotal: %llu kB", &memTotal) == 1) { }
-        else if (sscanf(line, "MemAvailable: %llu kB", &memAvailable) == 1) { }
-        if (memTotal && memAvailable)
-            break;
-    }
-    fclose(fp);
+    parse_field_t fields[] = {
+        { "MemTotal", &memTotal, 0 },
+        { "MemAvailable", &memAvailable, 0 },
+    };
+    parse_keyed_u64(buf, fields, 2);
     return (memTotal == 0) ? 0 : (float)(memTotal - memAvailable) / memTotal * 100;
 }
 
@@ -77,130 +107,233 @@ float get_disk_usage(void) {
     return (total == 0) ? 0 : (float)used / total * 100;
 }
 
-float get_cpu_temperature(void) {
-    FILE *fp = fopen("/sys/class/thermal/thermal_zone0/temp", "r");
-    if (!fp)
-        return -1;
-    int temp_milli;
-    fscanf(fp, "%d", &temp_milli);
-    fclose(fp);
-    return temp_milli / 1000.0;
+/* /proc/diskstats 장치별 상태. 장치가 수백 개여도 싸게 돌도록
+   필터 판정은 처음 볼 때 한 번만 하고 이후에는 캐시된 결과를 쓴다 */
+#define MAX_DISKSTAT_DEVICES 1024
+
+typedef struct {
+    unsigned int major;
+    unsigned int minor;
+    int selected;            /* 필터 통과 여부 */
+    int primed;              /* prev에 기준값이 있는지 */
+    int seen;
+    /* reads, sectors_read, ms_reading, writes, sectors_written, ms_writing, ms_io */
+    unsigned long long prev[7];
+} diskstat_state_t;
+
+static diskstat_state_t diskstat_state[MAX_DISKSTAT_DEVICES];
+static int diskstat_count;
+static struct timespec prev_disk_ts;
+
+static int name_in_list(const char *list, const char *name) {
+    char buf[256];
+    char *save = NULL;
+    snprintf(buf, sizeof(buf), "%s", list);
+    for (char *pat = strtok_r(buf, ", \t", &save); pat; pat = strtok_r(NULL, ", \t", &save)) {
+        if (fnmatch(pat, name, 0) == 0)
+            return 1;
+    }
+    return 0;
 }
 
-int get_network_traffic(float *rx_rate, float *tx_rate) {
-    FILE *fp;
-    char line[512];
-    unsigned long long rx1 = 0, tx1 = 0, rx2 = 0, tx2 = 0;
-    
-    fp = fopen("/proc/net/dev", "r");
-    if (!fp)
-        return -1;
-    // Skip header lines
-    fgets(line, sizeof(line), fp);
-    fgets(line, sizeof(line), fp);
-    while (fgets(line, sizeof(line), fp)) {
-        char iface[32];
-        unsigned long long r, t;
-        if (sscanf(line, " %[^:]: %llu %*s %*s %*s %*s %*s %*s %*s %llu", iface, &r, &t) == 3) {
-            if (strcmp(iface, "lo") != 0) {
-                rx1 += r;
-                tx1 += t;
-            }
-        }
+/* DISKSTATS_DEVICES/EXCLUDE 패턴과 파티션/dm/md 포함 여부로 장치를 고른다 */
+static int diskstat_selected(const char *name) {
+    char path[128];
+
+    if (!name_in_list(global_config.diskstats_devices, name))
+        return 0;
+    if (name_in_list(global_config.diskstats_exclude, name))
+        return 0;
+    if (strncmp(name, "dm-", 3) == 0)
+        return global_config.diskstats_include_dm;
+    if (strncmp(name, "md", 2) == 0 && isdigit((unsigned char)name[2]))
+        return global_config.diskstats_include_md;
+    snprintf(path, sizeof(path), "/sys/class/block/%s/partition", name);
+    if (access(path, F_OK) == 0)
+        return global_config.diskstats_include_partitions;
+    return 1;
+}
+
+/* 줄 순서는 보통 바뀌지 않으므로 같은 위치부터 찾아본다 */
+static diskstat_state_t *diskstat_lookup(int hint, unsigned int major, unsigned int minor) {
+    if (hint < diskstat_count &&
+        diskstat_state[hint].major == major && diskstat_state[hint].minor == minor)
+        return &diskstat_state[hint];
+    for (int i = 0; i < diskstat_count; i++) {
+        if (diskstat_state[i].major == major && diskstat_state[i].minor == minor)
+            return &diskstat_state[i];
     }
-    fclose(fp);
-    sleep(1);
-    fp = fopen("/proc/net/dev", "r");
-    if (!fp)
+    return NULL;
+}
+
+/* /proc/diskstats를 한 번 읽어 선택된 장치의 IOPS, 처리량, 평균 대기, 사용률 계산.
+   처음 보는 장치는 기준값만 저장한다. */
+int get_diskio_info(DiskIoInfo *info) {
+    struct timespec now;
+    double elapsed = 0;
+
+    memset(info, 0, sizeof(*info));
+    char *buf = procfile_read(&proc_diskstats, NULL);
+    if (!buf)
         return -1;
-    fgets(line, sizeof(line), fp);
-    fgets(line, sizeof(line), fp);
-    while (fgets(line, sizeof(line), fp)) {
-        char iface[32];
-        unsigned long long r, t;
-        if (sscanf(line, " %[^:]: %llu %*s %*s %*s %*s %*s %*s %*s %llu", iface, &r, &t) == 3) {
-            if (strcmp(iface, "lo") != 0) {
-                rx2 += r;
-                tx2 += t;
-            }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (prev_disk_ts.tv_sec != 0 || prev_disk_ts.tv_nsec != 0)
+        elapsed = (now.tv_sec - prev_disk_ts.tv_sec) + (now.tv_nsec - prev_disk_ts.tv_nsec) / 1e9;
+    prev_disk_ts = now;
+
+    for (int i = 0; i < diskstat_count; i++)
+        diskstat_state[i].seen = 0;
+
+    /* 형식: major minor name reads rd_merged rd_sectors rd_ms writes wr_merged wr_sectors wr_ms
+             in_flight io_ms weighted_ms ... */
+    char *cursor = buf;
+    char *line;
+    int lineno = 0;
+    while ((line = parse_next_line(&cursor)) != NULL) {
+        const char *p = line;
+        unsigned long long major, minor;
+        if (parse_u64(&p, &major) != 0 || parse_u64(&p, &minor) != 0)
+            continue;
+        char *rest = (char *)p;
+        char *name = parse_next_token(&rest);
+        if (!name)
+            continue;
+
+        diskstat_state_t *st = diskstat_lookup(lineno++, (unsigned int)major, (unsigned int)minor);
+        if (!st) {
+            if (diskstat_count >= MAX_DISKSTAT_DEVICES)
+                continue;
+            st = &diskstat_state[diskstat_count++];
+            memset(st, 0, sizeof(*st));
+            st->major = (unsigned int)major;
+            st->minor = (unsigned int)minor;
+            st->selected = diskstat_selected(name);
         }
+        st->seen = 1;
+        if (!st->selected)
+            continue;
+
+        unsigned long long v[10];
+        if (parse_u64_fields(rest, v, 10) < 10)
+            continue;
+        unsigned long long cur[7] = { v[0], v[2], v[3], v[4], v[6], v[7], v[9] };
+
+        /* 기준값만 있는 첫 샘플도 목록에는 넣어 CSV 열 구성이 흔들리지 않게 한다 */
+        if (info->count < MAX_DISKS) {
+            DiskIo *io = &info->disks[info->count++];
+            snprintf(io->name, sizeof(io->name), "%s", name);
+            if (!st->primed || elapsed <= 0)
+                goto next;
+            unsigned long long d[7];
+            for (int i = 0; i < 7; i++)
+                d[i] = (cur[i] >= st->prev[i]) ? cur[i] - st->prev[i] : 0;
+            unsigned long long ios = d[0] + d[3];
+            io->iops = ios / elapsed;
+            io->read_bps = d[1] * 512.0 / elapsed;
+            io->write_bps = d[4] * 512.0 / elapsed;
+            io->await_ms = (ios == 0) ? 0 : (float)(d[2] + d[5]) / ios;
+            io->util = d[6] / (elapsed * 1000) * 100;
+            if (io->util > 100)
+                io->util = 100;
+        }
+next:
+        memcpy(st->prev, cur, sizeof(cur));
+        st->primed = 1;
+    }
+
+    /* 사라진 장치는 빼서 같은 major:minor가 새 장치로 재사용될 때 다시 판정한다 */
+    int kept = 0;
+    for (int i = 0; i < diskstat_count; i++) {
+        if (diskstat_state[i].seen)
+            diskstat_state[kept++] = diskstat_state[i];
     }
-    fclose(fp);
-    *rx_rate = (float)(rx2 - rx1);
-    *tx_rate = (float)(tx2 - tx1);
+    diskstat_count = kept;
     return 0;
 }
 
+float get_cpu_temperature(void) {
+    float temp;
+    if (hwmon_cpu_temperature(&temp) == 0)
+        return temp;
+
+    char *buf = procfile_read(&thermal_temp, NULL);
+    if (!buf)
+        return -1;
+    int temp_milli = atoi(buf);
+    return temp_milli / 1000.0;
+}
+
+/* 정상으로 보는 물리 드라이브 상태 */
+int raid_pd_ok(const RaidPd *pd) {
+    return strncmp(pd->state, "Online", 6) == 0 ||
+           strncmp(pd->state, "Hotspare", 8) == 0 ||
+           strncmp(pd->state, "Unconfigured(good)", 18) == 0 ||
+           strncmp(pd->state, "JBOD", 4) == 0;
+}
+
+/* 시작할 때 정한 RAID 백엔드. NULL이면 RAID 점검을 하지 않는다 */
+static const char *raid_backend = NULL;
+
+/* RAID_BACKEND 값을 실제 백엔드로 정한다. auto면 storcli, MegaCli 순으로 설치된 도구를 쓰고
+   둘 다 없으면 md 배열이 있을 때 md를 쓴다. md면 변경 알림도 등록한다 (메인 스레드에서 호출) */
+const char *raid_backend_init(void) {
+    const char *backend = global_config.raid_backend;
+    if (strcmp(backend, "auto") == 0) {
+        if (access(STORCLI_PATH, X_OK) == 0)
+            backend = "storcli";
+        else if (access(MEGACLI_PATH, X_OK) == 0)
+            backend = "megacli";
+        else if (md_detect())
+            backend = "md";
+        else
+            backend = "none";
+    } else if (strcmp(backend, "storcli") != 0 && strcmp(backend, "megacli") != 0 &&
+               strcmp(backend, "md") != 0 && strcmp(backend, "redfish") != 0 &&
+               strcmp(backend, "none") != 0) {
+        syslog(LOG_ERR, "Unknown RAID_BACKEND '%s', using megacli", backend);
+        backend = "megacli";
+    }
+    syslog(LOG_INFO, "RAID backend: %s", backend);
+
+    if (strcmp(backend, "none") == 0)
+        return NULL;
+    if (strcmp(backend, "md") == 0 && md_watch_init() != 0)
+        syslog(LOG_WARNING, "Cannot watch /proc/mdstat, md changes are seen every RAID_INTERVAL");
+    raid_backend = backend;
+    return raid_backend;
+}
+
 RaidInfo get_raid_info(void) {
     RaidInfo info;
     memset(&info, 0, sizeof(info));
-    FILE *fp;
-    char line[256];
-
-    /* 1. RAID 상태 및 레벨 확인 명령어 */
-    const char *raid_cmd =
-        "/opt/MegaRAID/MegaCli/MegaCli64 -ShowSummary -aALL | grep -A 7 \"Storage\" | "
-        "awk \"{ if(\\$0 ~ /State/) { stat=\\$NF } else if(\\$0 ~ /RAID Level/) { raid=\\$NF } } "
-        "END { print stat, raid }\"";
-    
-    //Optimal 1 로출력됨(쉼표 안나옴)
-    fp = popen(raid_cmd, "r");
-    if (fp != NULL) {
-        //syslog(LOG_DEBUG, "DEBUG: Executing command: %s", raid_cmd);
-        if (fgets(line, sizeof(line), fp) != NULL) {
-            //syslog(LOG_DEBUG, "DEBUG: popen output: %s", line);
-            // 공백을 기준으로 토큰 분리
-            char *token = strtok(line, " \t\n");
-            if (token != NULL) {
-                strncpy(info.raid_state, token, sizeof(info.raid_state) - 1);
-                token = strtok(NULL, " \t\n");
-                if (token != NULL) {
-                    strncpy(info.raid_level, token, sizeof(info.raid_level) - 1);
-                } else {
-                    strncpy(info.raid_level, "Unknown", sizeof(info.raid_level) - 1);
-                }
-            }
-        }
-        pclose(fp);
-    } else {
-        syslog(LOG_ERR, "DEBUG: RAID popen() failed: %s", raid_cmd);
+
+    int rc;
+    if (strcmp(raid_backend, "storcli") == 0)
+        rc = storcli_get_info(&info);
+    else if (strcmp(raid_backend, "md") == 0)
+        rc = md_get_info(&info);
+    else if (strcmp(raid_backend, "redfish") == 0)
+        rc = redfish_get_raid_info(&info);
+    else
+        rc = megacli_get_info(&info);
+    if (rc != 0) {
+        if (!info.timed_out)
+            syslog(LOG_ERR, "DEBUG: RAID status command failed (%s backend)", raid_backend);
         strncpy(info.raid_state, "Unknown", sizeof(info.raid_state)-1);
         strncpy(info.raid_level, "Unknown", sizeof(info.raid_level)-1);
+        return info;
     }
-    
-    /* 2. 슬롯(SSD) 상태 확인 명령어 */
-    const char *pd_cmd =
-        "/opt/MegaRAID/MegaCli/MegaCli64 -PDList -aALL | grep -E \"Slot Number:|Firmware state:\" | "
-        "awk '{ if($0 ~ /Slot Number:/) { slot=$3 } else if($0 ~ /Firmware state:/) { print \"Slot \" slot \": \" $3, substr($0, index($0,$4)) } }'";
-    
-    fp = popen(pd_cmd, "r");
-    if (fp != NULL) {
-        //syslog(LOG_DEBUG, "DEBUG: Executing PD command: %s", pd_cmd);
-        int count = 0;
-        while (fgets(line, sizeof(line), fp) != NULL && count < 2) {
-            //syslog(LOG_DEBUG, "DEBUG: PD popen output: %s", line);
-            line[strcspn(line, "\n")] = '\0';  // 개행 제거
-            /* 만약 "Online" 문자열이 있으면 "Online", 아니면 "Not Online" */
-            if (strstr(line, "Online") != NULL) {
-                if (count == 0)
-                    strncpy(info.ssd0_status, "Online", sizeof(info.ssd0_status)-1);
-                else if (count == 1)
-                    strncpy(info.ssd1_status, "Online", sizeof(info.ssd1_status)-1);
-            } else {
-                if (count == 0)
-                    strncpy(info.ssd0_status, "Not Online", sizeof(info.ssd0_status)-1);
-                else if (count == 1)
-                    strncpy(info.ssd1_status, "Not Online", sizeof(info.ssd1_status)-1);
-            }
-            count++;
+
+    /* 요약: 첫 번째 이상 VD, 모두 정상이면 첫 VD */
+    const RaidVd *summary = &info.vds[0];
+    for (int i = 0; i < info.vd_count; i++) {
+        if (strcmp(info.vds[i].state, "Optimal") != 0) {
+            summary = &info.vds[i];
+            break;
         }
-        pclose(fp);
-    } else {
-        syslog(LOG_ERR, "DEBUG: PD popen() failed: %s", pd_cmd);
-        strncpy(info.ssd0_status, "Unknown", sizeof(info.ssd0_status)-1);
-        strncpy(info.ssd1_status, "Unknown", sizeof(info.ssd1_status)-1);
     }
-    
+    snprintf(info.raid_state, sizeof(info.raid_state), "%s", summary->state[0] ? summary->state : "Unknown");
+    snprintf(info.raid_level, sizeof(info.raid_level), "%s", summary->level[0] ? summary->level : "Unknown");
     return info;
 }
 
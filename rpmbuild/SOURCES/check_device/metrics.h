@@ -5,18 +5,74 @@ float get_cpu_usage(void);
 float get_memory_usage(void);
 float get_disk_usage(void);
 float get_cpu_temperature(void);
-int get_network_traffic(float *rx_rate, float *tx_rate);
 
-/* RAID 및 SSD 상태 정보를 위한 구조체와 함수 선언 */
+/* 블록 장치 I/O 통계 (/proc/diskstats, 직전 수집 이후 구간 기준) */
+#define MAX_DISKS 32
+
+typedef struct {
+    char name[32];
+    float iops;              /* 초당 읽기+쓰기 완료 수 */
+    float read_bps;          /* bytes/sec */
+    float write_bps;         /* bytes/sec */
+    float await_ms;          /* I/O 평균 대기 시간 (ms) */
+    float util;              /* 장치가 바빴던 시간 비율 % */
+} DiskIo;
+
+typedef struct {
+    int count;
+    DiskIo disks[MAX_DISKS];
+} DiskIoInfo;
+
+int get_diskio_info(DiskIoInfo *info);
+
+/* RAID 상태 정보: 어댑터, 가상 드라이브(VD), 물리 드라이브(PD) 표 */
+#define RAID_MAX_VDS 64
+#define RAID_MAX_PDS 256
+
 typedef struct {
-    char raid_state[64];   /* 예: "Optimal" */
-    char raid_level[16];   /* 예: "1" */
-    char ssd0_status[128]; /* 예: "Slot 0: Online, Spun Up" */
-    char ssd1_status[128]; /* 예: "Slot 1: Online, Spun Up" */
+    int adapter;
+    int id;                /* Virtual Drive 번호 */
+    char state[32];        /* 예: "Optimal", "Degraded" */
+    char level[16];        /* 예: "1", "10", "5" */
+} RaidVd;
+
+typedef struct {
+    int adapter;
+    int vd;                /* 소속 VD, 없으면 -1 */
+    int enclosure;
+    int slot;
+    char device[32];       /* 소프트웨어 RAID 멤버 장치 이름 (예: "sda1"), 하드웨어 RAID는 빈 값 */
+    char state[48];        /* 예: "Online, Spun Up" */
+    unsigned int media_errors;
+    unsigned int other_errors;
+    unsigned int predictive_failures;
+} RaidPd;
+
+typedef struct {
+    char raid_state[64];   /* 요약: 모든 VD가 Optimal이면 "Optimal", 아니면 첫 이상 VD 상태 */
+    char raid_level[16];   /* 요약 VD의 레벨 */
+    int adapter_count;
+    int vd_count;
+    RaidVd vds[RAID_MAX_VDS];
+    int pd_count;
+    RaidPd pds[RAID_MAX_PDS];
+    int timed_out;         /* 점검 명령이 RAID_PROBE_TIMEOUT을 넘겨 종료됨 */
 } RaidInfo;
 
+int raid_pd_ok(const RaidPd *pd);
+const char *raid_backend_init(void);
 RaidInfo get_raid_info(void);
 
+/* 팬 회전수 (RPM). 벤더 FanInfo(fanmonitor.h)는 보조 프로세스(hwhelper.c)에서만 이 구조로 옮겨 담으므로
+   그 밖의 모듈과 테스트는 libaxio 헤더 없이 빌드된다 */
+typedef struct {
+    int cpuFan;
+    int auxFan;
+    int fan1;
+    int fan2;
+    int fan3;
+} FanSpeeds;
+
 /* 전원 정보: Redundant_Power() 함수를 이용 */
 typedef struct {
     char power1[16];   /* 예: "OK" 또는 "Fail" */
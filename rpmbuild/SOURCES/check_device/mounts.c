@@ -0,0 +1,195 @@
+#include "mounts.h"
+#include "config.h"
+#include "scheduler.h"
+#include "procfile.h"
+#include "procparse.h"
+#include "alarms.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fnmatch.h>
+#include <poll.h>
+#include <syslog.h>
+#include <sys/statvfs.h>
+
+/* DISK_MOUNTS에 해당하는 마운트 목록. mountinfo가 바뀔 때만 다시 만든다 */
+typedef struct {
+    char mountpoint[128];    /* MountUsage.mountpoint와 같은 크기. 이보다 긴 마운트 지점은 감시하지 않는다 */
+    char fstype[32];
+    int readonly;
+    float block_threshold;
+    float inode_threshold;
+} mount_entry_t;
+
+static mount_entry_t mount_table[MAX_MOUNTS];
+static int mount_count;
+
+/* mountinfo는 내용이 바뀌면 POLLPRI로 알려준다 */
+static procfile_t mountinfo = PROCFILE_INIT("/proc/self/mountinfo");
+
+/* mountinfo의 \040 같은 8진수 이스케이프를 그 자리에서 푼다 */
+static void unescape_octal(char *s) {
+    char *out = s;
+    while (*s) {
+        if (s[0] == '\\' && s[1] >= '0' && s[1] <= '7' &&
+            s[2] >= '0' && s[2] <= '7' && s[3] >= '0' && s[3] <= '7') {
+            *out++ = (char)((s[1] - '0') * 64 + (s[2] - '0') * 8 + (s[3] - '0'));
+            s += 4;
+        } else {
+            *out++ = *s++;
+        }
+    }
+    *out = '\0';
+}
+
+/* "패턴:값,패턴:값" 형식 목록에서 마운트 지점에 맞는 임계치를 찾는다 */
+static float lookup_threshold(const char *list, const char *mountpoint, float fallback) {
+    char buf[256];
+    char *save = NULL;
+
+    snprintf(buf, sizeof(buf), "%s", list);
+    for (char *item = strtok_r(buf, ", \t", &save); item; item = strtok_r(NULL, ", \t", &save)) {
+        char *colon = strrchr(item, ':');
+        if (!colon)
+            continue;
+        *colon = '\0';
+        if (fnmatch(item, mountpoint, 0) == 0)
+            return atof(colon + 1);
+    }
+    return fallback;
+}
+
+static int mount_selected(const char *mountpoint) {
+    char buf[sizeof(global_config.disk_mounts)];
+    char *save = NULL;
+
+    snprintf(buf, sizeof(buf), "%s", global_config.disk_mounts);
+    for (char *pat = strtok_r(buf, ", \t", &save); pat; pat = strtok_r(NULL, ", \t", &save)) {
+        if (fnmatch(pat, mountpoint, 0) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* 같은 마운트 지점은 나중 항목(위에 덮어쓴 마운트)이 유효하다 */
+static mount_entry_t *find_entry(mount_entry_t *table, int count, const char *mountpoint) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(table[i].mountpoint, mountpoint) == 0)
+            return &table[i];
+    }
+    return NULL;
+}
+
+/* /proc/self/mountinfo를 다시 읽어 감시 대상 마운트 목록을 만든다.
+   읽기 전용 알람은 alarms.c가 주기마다 readonly로 판정하고, rw에서 ro로 바뀐 마운트는 여기서 바로 알린다 */
+static void refresh_mount_table(void) {
+    mount_entry_t table[MAX_MOUNTS];
+    int count = 0;
+    char *buf = procfile_read(&mountinfo, NULL);
+    if (!buf)
+        return;
+
+    /* 형식: id parent major:minor root mountpoint options [optional...] - fstype source superoptions */
+    char *cursor = buf;
+    char *line;
+    while ((line = parse_next_line(&cursor)) != NULL) {
+        char *fields[6];
+        int n = 0;
+        while (n < 6 && (fields[n] = parse_next_token(&line)) != NULL)
+            n++;
+        if (n < 6)
+            continue;
+        char *tok, *fstype = NULL;
+        while ((tok = parse_next_token(&line)) != NULL) {
+            if (strcmp(tok, "-") == 0) {
+                fstype = parse_next_token(&line);
+                break;
+            }
+        }
+        if (!fstype)
+            continue;
+
+        char *mountpoint = fields[4];
+        unescape_octal(mountpoint);
+        if (!mount_selected(mountpoint))
+            continue;
+        /* 잘린 경로로 statvfs()하면 다른 파일시스템을 보게 되므로 감시하지 않는다 */
+        if (strlen(mountpoint) >= sizeof(table[0].mountpoint)) {
+            syslog(LOG_WARNING, "Mount point too long, not monitored: %.64s...", mountpoint);
+            continue;
+        }
+
+        mount_entry_t *e = find_entry(table, count, mountpoint);
+        if (!e) {
+            if (count >= MAX_MOUNTS) {
+                syslog(LOG_WARNING, "More than %d mounts selected, ignoring %s", MAX_MOUNTS, mountpoint);
+                continue;
+            }
+            e = &table[count++];
+        }
+        memset(e, 0, sizeof(*e));
+        snprintf(e->mountpoint, sizeof(e->mountpoint), "%s", mountpoint);
+        snprintf(e->fstype, sizeof(e->fstype), "%s", fstype);
+        /* 마운트별 옵션은 "rw,relatime" 또는 "ro,..." 로 시작한다 */
+        e->readonly = (strncmp(fields[5], "ro", 2) == 0 && (fields[5][2] == ',' || fields[5][2] == '\0'));
+        e->block_threshold = lookup_threshold(global_config.disk_mount_thresholds,
+                                              mountpoint, global_config.disk_usage_threshold);
+        e->inode_threshold = lookup_threshold(global_config.inode_mount_thresholds,
+                                              mountpoint, global_config.inode_usage_threshold);
+    }
+
+    /* 파일시스템 오류로 다시 마운트된 경우가 대부분이므로 다음 보고 주기까지 기다리지 않는다 */
+    for (int i = 0; i < count; i++) {
+        const mount_entry_t *old = find_entry(mount_table, mount_count, table[i].mountpoint);
+        if (old && !old->readonly && table[i].readonly)
+            raise_mount_ro_alarm(table[i].mountpoint, table[i].fstype);
+    }
+
+    memcpy(mount_table, table, sizeof(table[0]) * count);
+    mount_count = count;
+}
+
+static void on_mountinfo_change(int fd, short revents, void *arg) {
+    (void)fd;
+    (void)revents;
+    (void)arg;
+    refresh_mount_table();
+}
+
+/* 마운트 목록을 처음 만들고 mountinfo 변경 알림을 스케줄러에 등록한다 */
+int mounts_init(void) {
+    refresh_mount_table();
+    if (mountinfo.fd < 0)
+        return -1;
+    return scheduler_add_fd(mountinfo.fd, POLLPRI, on_mountinfo_change, NULL);
+}
+
+/* SIGHUP: 마운트별 임계치(DISK_MOUNT_THRESHOLDS, INODE_MOUNT_THRESHOLDS)는 목록을 만들 때 정하므로 다시 만든다 */
+void mounts_reload(void) {
+    refresh_mount_table();
+}
+
+/* 감시 대상 마운트마다 statvfs()로 블록/아이노드 사용률을 계산 */
+int get_mount_info(MountInfo *info) {
+    memset(info, 0, sizeof(*info));
+    for (int i = 0; i < mount_count; i++) {
+        const mount_entry_t *e = &mount_table[i];
+        struct statvfs vfs;
+        if (statvfs(e->mountpoint, &vfs) != 0)
+            continue;
+        /* proc, sysfs 같은 가상 파일시스템은 블록이 0이므로 제외 */
+        if (vfs.f_blocks == 0)
+            continue;
+
+        MountUsage *m = &info->mounts[info->count++];
+        memcpy(m->mountpoint, e->mountpoint, sizeof(m->mountpoint));
+        snprintf(m->fstype, sizeof(m->fstype), "%s", e->fstype);
+        m->readonly = e->readonly || (vfs.f_flag & ST_RDONLY) != 0;
+        m->block_usage = (float)(vfs.f_blocks - vfs.f_bfree) / vfs.f_blocks * 100;
+        m->inode_usage = (vfs.f_files == 0) ? -1 :
+                         (float)(vfs.f_files - vfs.f_ffree) / vfs.f_files * 100;
+        m->block_threshold = e->block_threshold;
+        m->inode_threshold = e->inode_threshold;
+    }
+    return 0;
+}
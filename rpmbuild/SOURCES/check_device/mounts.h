@@ -0,0 +1,26 @@
+#ifndef MOUNTS_H
+#define MOUNTS_H
+
+#define MAX_MOUNTS 32
+
+/* 감시 대상 마운트의 블록/아이노드 사용률 */
+typedef struct {
+    char mountpoint[128];
+    char fstype[32];
+    int readonly;
+    float block_usage;       /* % */
+    float inode_usage;       /* %, 아이노드가 없는 파일시스템이면 -1 */
+    float block_threshold;   /* 이 마운트에 적용되는 임계치 */
+    float inode_threshold;
+} MountUsage;
+
+typedef struct {
+    int count;
+    MountUsage mounts[MAX_MOUNTS];
+} MountInfo;
+
+int mounts_init(void);
+void mounts_reload(void);
+int get_mount_info(MountInfo *info);
+
+#endif // MOUNTS_H
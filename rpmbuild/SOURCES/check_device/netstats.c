@@ -0,0 +1,245 @@
+#include "netstats.h"
+#include "config.h"
+#include "procfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fnmatch.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+
+/* 인터페이스별 직전 누적 카운터와 링크 속도 파일 핸들 */
+typedef struct {
+    int ifindex;             /* 0이면 빈 슬롯 */
+    int seen;                /* 이번 덤프에서 보였는지 */
+    int primed;              /* prev에 기준값이 있는지 */
+    char name[IF_NAMESIZE];
+    struct rtnl_link_stats64 prev;
+    procfile_t speed;        /* /sys/class/net/<name>/speed */
+} net_state_t;
+
+static net_state_t net_state[MAX_NET_IFACES];
+static struct timespec prev_ts;
+static int prev_valid;
+
+static int nl_fd = -1;
+static unsigned int nl_seq;
+
+/* RTM_GETLINK 덤프 응답 수신 버퍼 */
+static char nl_buf[32768];
+
+static int netlink_open(void) {
+    struct sockaddr_nl addr;
+
+    nl_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (nl_fd < 0) {
+        syslog(LOG_ERR, "netlink socket failed: %s", strerror(errno));
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    if (bind(nl_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        syslog(LOG_ERR, "netlink bind failed: %s", strerror(errno));
+        close(nl_fd);
+        nl_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+/* NET_INTERFACE 목록(쉼표/공백 구분, glob 패턴 허용)에 맞는지 확인.
+   루프백은 이름을 정확히 적은 경우에만 포함한다. */
+static int iface_selected(const char *name, int loopback) {
+    char list[sizeof(global_config.net_interface)];
+    char *save = NULL;
+
+    snprintf(list, sizeof(list), "%s", global_config.net_interface);
+    for (char *pat = strtok_r(list, ", \t", &save); pat; pat = strtok_r(NULL, ", \t", &save)) {
+        if (strcmp(pat, name) == 0)
+            return 1;
+        if (!loopback && fnmatch(pat, name, 0) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+static net_state_t *state_lookup(int ifindex, const char *name) {
+    net_state_t *empty = NULL;
+    for (int i = 0; i < MAX_NET_IFACES; i++) {
+        if (net_state[i].ifindex == ifindex)
+            return &net_state[i];
+        if (net_state[i].ifindex == 0 && !empty)
+            empty = &net_state[i];
+    }
+    if (!empty)
+        return NULL;
+    /* 새 인터페이스: 첫 샘플은 기준값만 저장 */
+    char path[128];
+    memset(empty, 0, sizeof(*empty));
+    empty->ifindex = ifindex;
+    snprintf(empty->name, sizeof(empty->name), "%s", name);
+    snprintf(path, sizeof(path), "/sys/class/net/%s/speed", name);
+    procfile_init(&empty->speed, path);
+    return empty;
+}
+
+static int read_link_speed(net_state_t *st) {
+    char *buf = procfile_read(&st->speed, NULL);
+    if (!buf)
+        return -1;   /* 가상 인터페이스나 링크 다운이면 EINVAL */
+    int speed = atoi(buf);
+    return (speed > 0) ? speed : -1;
+}
+
+static unsigned long long counter_delta(unsigned long long cur, unsigned long long prev) {
+    return (cur >= prev) ? cur - prev : 0;
+}
+
+/* 덤프의 RTM_NEWLINK 메시지 하나를 처리 */
+static void handle_link(struct nlmsghdr *nh, NetInfo *info, double elapsed) {
+    struct ifinfomsg *ifi = NLMSG_DATA(nh);
+    int len = nh->nlmsg_len - NLMSG_LENGTH(sizeof(*ifi));
+    const char *name = NULL;
+    struct rtnl_link_stats64 stats;
+    int have_stats = 0;
+    int stacked = 0;         /* 본딩/브리지 슬레이브 또는 VLAN 등 다른 링크 위의 인터페이스 */
+
+    for (struct rtattr *rta = IFLA_RTA(ifi); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == IFLA_IFNAME) {
+            name = RTA_DATA(rta);
+        } else if (rta->rta_type == IFLA_MASTER) {
+            stacked = 1;
+        } else if (rta->rta_type == IFLA_LINK && RTA_PAYLOAD(rta) >= sizeof(int)) {
+            if (*(int *)RTA_DATA(rta) != ifi->ifi_index)
+                stacked = 1;
+        } else if (rta->rta_type == IFLA_STATS64 &&
+                   RTA_PAYLOAD(rta) >= sizeof(stats)) {
+            memcpy(&stats, RTA_DATA(rta), sizeof(stats));
+            have_stats = 1;
+        }
+    }
+    if (!name || !have_stats || !iface_selected(name, ifi->ifi_flags & IFF_LOOPBACK))
+        return;
+
+    net_state_t *st = state_lookup(ifi->ifi_index, name);
+    if (!st) {
+        static int warned;
+        if (!warned++)
+            syslog(LOG_WARNING, "More than %d interfaces selected, ignoring the rest", MAX_NET_IFACES);
+        return;
+    }
+    st->seen = 1;
+
+    NetIface *nif = &info->ifaces[info->count++];
+    memset(nif, 0, sizeof(*nif));
+    snprintf(nif->name, sizeof(nif->name), "%s", name);
+    nif->speed_mbps = read_link_speed(st);
+    nif->rx_util = -1;
+    nif->tx_util = -1;
+
+    if (st->primed && elapsed > 0) {
+        nif->rx_rate = counter_delta(stats.rx_bytes, st->prev.rx_bytes) / elapsed;
+        nif->tx_rate = counter_delta(stats.tx_bytes, st->prev.tx_bytes) / elapsed;
+        nif->rx_pps = counter_delta(stats.rx_packets, st->prev.rx_packets) / elapsed;
+        nif->tx_pps = counter_delta(stats.tx_packets, st->prev.tx_packets) / elapsed;
+        nif->rx_errors = counter_delta(stats.rx_errors, st->prev.rx_errors);
+        nif->tx_errors = counter_delta(stats.tx_errors, st->prev.tx_errors);
+        nif->rx_dropped = counter_delta(stats.rx_dropped, st->prev.rx_dropped);
+        nif->tx_dropped = counter_delta(stats.tx_dropped, st->prev.tx_dropped);
+        if (nif->speed_mbps > 0) {
+            double bytes_per_sec = nif->speed_mbps * 1000000.0 / 8;
+            nif->rx_util = nif->rx_rate / bytes_per_sec * 100;
+            nif->tx_util = nif->tx_rate / bytes_per_sec * 100;
+        }
+    }
+    st->prev = stats;
+    st->primed = 1;
+
+    /* 같은 트래픽이 본딩/VLAN과 그 아래 링크에 모두 잡히므로 합계에는 최상위 인터페이스만 */
+    if (!stacked) {
+        info->rx_rate += nif->rx_rate;
+        info->tx_rate += nif->tx_rate;
+    }
+}
+
+/* RTM_GETLINK 덤프 한 번으로 모든 인터페이스의 64비트 카운터를 받아
+   NET_INTERFACE에 맞는 인터페이스의 구간 통계를 계산한다.
+   처음 보는 인터페이스는 기준값만 저장하므로 그 주기의 속도는 0이다. */
+int get_net_info(NetInfo *info) {
+    struct {
+        struct nlmsghdr nh;
+        struct ifinfomsg ifi;
+    } req;
+    struct timespec now;
+    double elapsed = 0;
+
+    memset(info, 0, sizeof(*info));
+    if (nl_fd < 0 && netlink_open() != 0)
+        return -1;
+
+    memset(&req, 0, sizeof(req));
+    req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(req.ifi));
+    req.nh.nlmsg_type = RTM_GETLINK;
+    req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.nh.nlmsg_seq = ++nl_seq;
+    req.ifi.ifi_family = AF_UNSPEC;
+    if (send(nl_fd, &req, req.nh.nlmsg_len, 0) < 0) {
+        syslog(LOG_ERR, "RTM_GETLINK send failed: %s", strerror(errno));
+        close(nl_fd);
+        nl_fd = -1;
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (prev_valid)
+        elapsed = (now.tv_sec - prev_ts.tv_sec) + (now.tv_nsec - prev_ts.tv_nsec) / 1e9;
+    for (int i = 0; i < MAX_NET_IFACES; i++)
+        net_state[i].seen = 0;
+
+    for (;;) {
+        ssize_t n = recv(nl_fd, nl_buf, sizeof(nl_buf), 0);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            syslog(LOG_ERR, "RTM_GETLINK recv failed: %s", strerror(errno));
+            close(nl_fd);
+            nl_fd = -1;
+            return -1;
+        }
+        int len = (int)n;
+        for (struct nlmsghdr *nh = (struct nlmsghdr *)nl_buf; NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+            if (nh->nlmsg_seq != nl_seq)
+                continue;
+            if (nh->nlmsg_type == NLMSG_DONE)
+                goto done;
+            if (nh->nlmsg_type == NLMSG_ERROR) {
+                struct nlmsgerr *err = NLMSG_DATA(nh);
+                syslog(LOG_ERR, "RTM_GETLINK dump failed: %s", strerror(-err->error));
+                /* 남은 덤프 응답이 다음 요청에 섞이지 않도록 소켓째 버리고 다음에 새로 연다 */
+                close(nl_fd);
+                nl_fd = -1;
+                return -1;
+            }
+            if (nh->nlmsg_type == RTM_NEWLINK && info->count < MAX_NET_IFACES)
+                handle_link(nh, info, elapsed);
+        }
+    }
+
+done:
+    /* 사라진 인터페이스의 슬롯은 비워서 재사용 */
+    for (int i = 0; i < MAX_NET_IFACES; i++) {
+        if (net_state[i].ifindex != 0 && !net_state[i].seen) {
+            procfile_close(&net_state[i].speed);
+            memset(&net_state[i], 0, sizeof(net_state[i]));
+        }
+    }
+    prev_ts = now;
+    prev_valid = 1;
+    return 0;
+}
@@ -0,0 +1,34 @@
+#ifndef NETSTATS_H
+#define NETSTATS_H
+
+#include <net/if.h>
+
+#define MAX_NET_IFACES 64
+
+/* 인터페이스별 네트워크 통계 (직전 수집 이후 구간 기준) */
+typedef struct {
+    char name[IF_NAMESIZE];
+    int speed_mbps;          /* 링크 속도, 알 수 없으면 -1 */
+    float rx_rate;           /* bytes/sec */
+    float tx_rate;           /* bytes/sec */
+    float rx_pps;            /* packets/sec */
+    float tx_pps;            /* packets/sec */
+    float rx_util;           /* 링크 속도 대비 %, 알 수 없으면 -1 */
+    float tx_util;
+    unsigned long long rx_errors;   /* 구간 내 증가량 */
+    unsigned long long tx_errors;
+    unsigned long long rx_dropped;
+    unsigned long long tx_dropped;
+} NetIface;
+
+/* NET_INTERFACE에 해당하는 인터페이스 목록과 합계 */
+typedef struct {
+    int count;
+    NetIface ifaces[MAX_NET_IFACES];
+    float rx_rate;           /* 선택된 인터페이스 합계 bytes/sec (슬레이브, VLAN 제외) */
+    float tx_rate;
+} NetInfo;
+
+int get_net_info(NetInfo *info);
+
+#endif // NETSTATS_H
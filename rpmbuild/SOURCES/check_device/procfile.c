@@ -0,0 +1,97 @@
+#include "procfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* 첫 버퍼 크기. sysfs 속성은 대부분 이 안에 들어가고 큰 /proc 파일은 두 배씩 늘린다 */
+#define PROCFILE_INITIAL_SIZE 256
+
+void procfile_init(procfile_t *pf, const char *path) {
+    memset(pf, 0, sizeof(*pf));
+    snprintf(pf->path, sizeof(pf->path), "%s", path);
+    pf->fd = -1;
+}
+
+static int procfile_open(procfile_t *pf) {
+    pf->fd = open(pf->path, O_RDONLY | O_CLOEXEC);
+    return (pf->fd < 0) ? -1 : 0;
+}
+
+/* 버퍼를 두 배로 키운다 */
+static int procfile_grow(procfile_t *pf) {
+    char *bigger = realloc(pf->buf, pf->cap * 2);
+    if (bigger == NULL)
+        return -1;
+    pf->buf = bigger;
+    pf->cap *= 2;
+    return 0;
+}
+
+/* 파일 전체를 처음부터 다시 읽어 NUL로 끝나는 내부 버퍼를 돌려준다.
+   버퍼는 다음 호출 때까지 유효하며 호출자가 그 자리에서 파싱해도 된다.
+   장치가 사라졌다 다시 생긴 경우(ENODEV, ESTALE)에는 한 번 다시 연다. */
+char *procfile_read(procfile_t *pf, size_t *len) {
+    int reopened = 0;
+    /* sysfs 속성은 show() 한 번에 통째로 만들어지므로 짧게 읽히면 그것이 끝이다.
+       /proc의 seq_file은 한 번에 한 페이지 남짓만 돌려주므로 0이 나올 때까지 이어 읽는다 */
+    int sysfs = strncmp(pf->path, "/sys/", 5) == 0;
+    size_t used = 0;
+
+    if (pf->fd < 0 && procfile_open(pf) != 0)
+        return NULL;
+    if (pf->buf == NULL) {
+        pf->buf = malloc(PROCFILE_INITIAL_SIZE);
+        if (pf->buf == NULL)
+            return NULL;
+        pf->cap = PROCFILE_INITIAL_SIZE;
+    }
+
+    for (;;) {
+        if (used == pf->cap - 1 && procfile_grow(pf) != 0)
+            return NULL;
+        ssize_t n = pread(pf->fd, pf->buf + used, pf->cap - 1 - used, (off_t)used);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if ((errno == ENODEV || errno == ESTALE || errno == EBADF) && !reopened) {
+                close(pf->fd);
+                pf->fd = -1;
+                reopened = 1;
+                used = 0;
+                if (procfile_open(pf) != 0)
+                    return NULL;
+                continue;
+            }
+            return NULL;
+        }
+        if (sysfs) {
+            /* 버퍼가 꽉 찼으면 키워서 처음부터 다시 읽는다 */
+            if ((size_t)n == pf->cap - 1) {
+                if (procfile_grow(pf) != 0)
+                    return NULL;
+                continue;
+            }
+            used = (size_t)n;
+            break;
+        }
+        if (n == 0)
+            break;
+        used += (size_t)n;
+    }
+    pf->buf[used] = '\0';
+    if (len)
+        *len = used;
+    return pf->buf;
+}
+
+void procfile_close(procfile_t *pf) {
+    if (pf->fd >= 0)
+        close(pf->fd);
+    free(pf->buf);
+    pf->fd = -1;
+    pf->buf = NULL;
+    pf->cap = 0;
+}
@@ -0,0 +1,20 @@
+#ifndef PROCFILE_H
+#define PROCFILE_H
+
+#include <stddef.h>
+
+/* 한 번 열어 두고 pread로 처음부터 다시 읽는 /proc, /sys 파일 핸들 */
+typedef struct {
+    char path[256];
+    int fd;          /* -1이면 아직 열지 않음 */
+    char *buf;       /* 재사용 읽기 버퍼 (필요하면 커짐) */
+    size_t cap;
+} procfile_t;
+
+#define PROCFILE_INIT(p) { .path = (p), .fd = -1, .buf = NULL, .cap = 0 }
+
+void procfile_init(procfile_t *pf, const char *path);
+char *procfile_read(procfile_t *pf, size_t *len);
+void procfile_close(procfile_t *pf);
+
+#endif // PROCFILE_H
@@ -0,0 +1,100 @@
+#include "procparse.h"
+#include <string.h>
+
+static inline int is_blank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+static inline int is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+/* *cursor에서 한 줄을 꺼내 '\n'을 '\0'으로 바꾸고 그 줄을 돌려준다.
+   버퍼 끝이면 NULL. */
+char *parse_next_line(char **cursor) {
+    char *line = *cursor;
+    if (line == NULL || *line == '\0')
+        return NULL;
+    char *nl = strchr(line, '\n');
+    if (nl) {
+        *nl = '\0';
+        *cursor = nl + 1;
+    } else {
+        *cursor = line + strlen(line);
+    }
+    return line;
+}
+
+/* 공백/탭으로 구분된 다음 토큰을 '\0'으로 끊어 돌려준다 */
+char *parse_next_token(char **cursor) {
+    char *p = *cursor;
+    while (is_blank(*p))
+        p++;
+    if (*p == '\0') {
+        *cursor = p;
+        return NULL;
+    }
+    char *start = p;
+    while (*p != '\0' && !is_blank(*p))
+        p++;
+    if (*p != '\0')
+        *p++ = '\0';
+    *cursor = p;
+    return start;
+}
+
+/* 앞 공백을 건너뛰고 부호 없는 10진수를 읽는다. 성공하면 *p를 숫자 뒤로 옮긴다 */
+int parse_u64(const char **p, unsigned long long *out) {
+    const char *s = *p;
+    unsigned long long v = 0;
+    while (is_blank(*s))
+        s++;
+    if (!is_digit(*s))
+        return -1;
+    while (is_digit(*s)) {
+        v = v * 10 + (unsigned long long)(*s - '0');
+        s++;
+    }
+    *out = v;
+    *p = s;
+    return 0;
+}
+
+/* 공백으로 구분된 숫자를 최대 count개 읽고 읽은 개수를 돌려준다 */
+int parse_u64_fields(const char *p, unsigned long long *out, int count) {
+    int n = 0;
+    while (n < count && parse_u64(&p, &out[n]) == 0)
+        n++;
+    return n;
+}
+
+/* "Key:   value [unit]" 줄들로 된 버퍼(meminfo 형식)에서 fields의 키를 찾아 값을 채운다.
+   모든 키를 찾으면 바로 멈추며, 찾은 키의 개수를 돌려준다. */
+int parse_keyed_u64(char *buf, parse_field_t *fields, int count) {
+    int remaining = count;
+    char *cursor = buf;
+    char *line;
+
+    for (int i = 0; i < count; i++)
+        fields[i].found = 0;
+
+    while (remaining > 0 && (line = parse_next_line(&cursor)) != NULL) {
+        char *colon = strchr(line, ':');
+        if (colon == NULL)
+            continue;
+        size_t keylen = (size_t)(colon - line);
+        for (int i = 0; i < count; i++) {
+            if (fields[i].found)
+                continue;
+            if (strncmp(line, fields[i].key, keylen) != 0 || fields[i].key[keylen] != '\0')
+                continue;
+            const char *p = colon + 1;
+            if (parse_u64(&p, fields[i].value) == 0) {
+                fields[i].found = 1;
+                remaining--;
+            }
+            break;
+        }
+    }
+    return count - remaining;
+}
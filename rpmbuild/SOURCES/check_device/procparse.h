@@ -0,0 +1,22 @@
+#ifndef PROCPARSE_H
+#define PROCPARSE_H
+
+#include <stddef.h>
+
+/* /proc 파일 버퍼를 그 자리에서 파싱하는 함수들.
+   힙을 쓰지 않고 로케일에 의존하지 않는다. */
+
+/* meminfo 형식 키 조회용 항목 */
+typedef struct {
+    const char *key;             /* 예: "MemTotal" (':' 제외) */
+    unsigned long long *value;
+    int found;
+} parse_field_t;
+
+char *parse_next_line(char **cursor);
+char *parse_next_token(char **cursor);
+int parse_u64(const char **p, unsigned long long *out);
+int parse_u64_fields(const char *p, unsigned long long *out, int count);
+int parse_keyed_u64(char *buf, parse_field_t *fields, int count);
+
+#endif // PROCPARSE_H
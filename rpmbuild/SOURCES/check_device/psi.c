@@ -0,0 +1,123 @@
+#include "psi.h"
+#include "config.h"
+#include "alarms.h"
+#include "scheduler.h"
+#include "procfile.h"
+#include "procparse.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <syslog.h>
+#include <unistd.h>
+
+static const char *psi_names[PSI_RESOURCES] = { "cpu", "memory", "io" };
+static const char *psi_oids[PSI_RESOURCES] = {
+    ".1.3.6.1.4.1.8072.2.3.0.18",
+    ".1.3.6.1.4.1.8072.2.3.0.19",
+    ".1.3.6.1.4.1.8072.2.3.0.20",
+};
+
+/* 평균값 조회용 핸들 (트리거 fd와 별도) */
+static procfile_t psi_files[PSI_RESOURCES] = {
+    PROCFILE_INIT("/proc/pressure/cpu"),
+    PROCFILE_INIT("/proc/pressure/memory"),
+    PROCFILE_INIT("/proc/pressure/io"),
+};
+
+/* 커널 PSI 트리거 fd. 임계 지연이 발생하면 POLLPRI */
+static int trigger_fds[PSI_RESOURCES] = { -1, -1, -1 };
+
+/* "some avg10=1.23 avg60=0.50 avg300=0.10 total=123" 한 줄에서 avg10, avg60 */
+static void parse_psi_line(char *line, float *avg10, float *avg60) {
+    char *tok;
+    while ((tok = parse_next_token(&line)) != NULL) {
+        if (strncmp(tok, "avg10=", 6) == 0)
+            *avg10 = strtof(tok + 6, NULL);
+        else if (strncmp(tok, "avg60=", 6) == 0)
+            *avg60 = strtof(tok + 6, NULL);
+    }
+}
+
+static int read_psi(int res, float *some10, float *some60, float *full10, float *full60) {
+    char *buf = procfile_read(&psi_files[res], NULL);
+    if (!buf)
+        return -1;
+    char *cursor = buf;
+    char *line;
+    while ((line = parse_next_line(&cursor)) != NULL) {
+        if (strncmp(line, "some ", 5) == 0)
+            parse_psi_line(line + 5, some10, some60);
+        else if (strncmp(line, "full ", 5) == 0)
+            parse_psi_line(line + 5, full10, full60);
+    }
+    return 0;
+}
+
+/* 트리거 발생: 다음 보고 주기를 기다리지 않고 바로 알람 */
+static void on_psi_event(int fd, short revents, void *arg) {
+    int res = (int)(long)arg;
+
+    if (revents & POLLERR) {
+        /* 파일이 사라졌으면 더 이상 감시하지 않는다 */
+        syslog(LOG_ERR, "PSI trigger for %s failed, disabling", psi_names[res]);
+        scheduler_remove_fd(fd);
+        close(fd);
+        trigger_fds[res] = -1;
+        return;
+    }
+    float some10 = 0, some60 = 0, full10 = 0, full60 = 0;
+    read_psi(res, &some10, &some60, &full10, &full60);
+    char message[128];
+    snprintf(message, sizeof(message), "%s pressure stall alarm triggered", psi_names[res]);
+    raise_event_alarm(psi_oids[res], message,
+                      "ALARM: %s pressure stall: some avg10=%.2f%%, full avg10=%.2f%%",
+                      psi_names[res], some10, full10);
+}
+
+/* "some 150000 1000000" 같은 트리거를 등록하고 스케줄러에서 POLLPRI를 기다린다 */
+static int register_trigger(int res, const char *trigger) {
+    char path[64];
+
+    if (trigger[0] == '\0')
+        return 0;
+    snprintf(path, sizeof(path), "/proc/pressure/%s", psi_names[res]);
+    int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        syslog(LOG_WARNING, "PSI not available for %s: %s", psi_names[res], strerror(errno));
+        return -1;
+    }
+    /* 커널은 문자열 끝의 NUL까지 포함해서 쓰기를 기대한다 */
+    if (write(fd, trigger, strlen(trigger) + 1) < 0) {
+        /* CAP_SYS_RESOURCE가 없으면 윈도우가 2초의 배수여야 한다 */
+        syslog(LOG_ERR, "PSI trigger \"%s\" for %s rejected: %s%s", trigger, psi_names[res], strerror(errno),
+               (errno == EINVAL) ? " (without CAP_SYS_RESOURCE the window must be a multiple of 2s)" : "");
+        close(fd);
+        return -1;
+    }
+    trigger_fds[res] = fd;
+    return scheduler_add_fd(fd, POLLPRI, on_psi_event, (void *)(long)res);
+}
+
+/* PSI_ENABLE이면 자원별 트리거를 등록한다 */
+int psi_init(void) {
+    if (!global_config.psi_enable)
+        return 0;
+    register_trigger(PSI_CPU, global_config.psi_cpu_trigger);
+    register_trigger(PSI_MEMORY, global_config.psi_memory_trigger);
+    register_trigger(PSI_IO, global_config.psi_io_trigger);
+    return 0;
+}
+
+/* CSV 기록용 PSI 평균값 */
+int get_psi_info(PsiInfo *info) {
+    memset(info, 0, sizeof(*info));
+    for (int res = 0; res < PSI_RESOURCES; res++) {
+        if (read_psi(res, &info->some_avg10[res], &info->some_avg60[res],
+                     &info->full_avg10[res], &info->full_avg60[res]) == 0)
+            info->available = 1;
+    }
+    return info->available ? 0 : -1;
+}
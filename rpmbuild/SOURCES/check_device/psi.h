@@ -0,0 +1,19 @@
+#ifndef PSI_H
+#define PSI_H
+
+/* /proc/pressure/{cpu,memory,io} 자원 순서 */
+enum { PSI_CPU = 0, PSI_MEMORY, PSI_IO, PSI_RESOURCES };
+
+/* PSI 평균 (최근 10초/60초 동안 지연된 시간 비율 %) */
+typedef struct {
+    int available;                 /* 커널이 PSI를 지원하는지 */
+    float some_avg10[PSI_RESOURCES];
+    float some_avg60[PSI_RESOURCES];
+    float full_avg10[PSI_RESOURCES];
+    float full_avg60[PSI_RESOURCES];
+} PsiInfo;
+
+int psi_init(void);
+int get_psi_info(PsiInfo *info);
+
+#endif // PSI_H
@@ -0,0 +1,92 @@
+#include "raidworker.h"
+#include "metrics.h"
+#include "config.h"
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <syslog.h>
+#include <time.h>
+
+/* 워커 스레드가 채우고 메인 루프가 읽는 캐시. mutex로 보호 */
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t kick_cond;
+static RaidInfo cached_info;
+static time_t cached_updated;
+static int probing;
+static time_t probe_started;
+static int kicked;
+
+static int raid_period(void) {
+    return (global_config.raid_interval > 0) ? global_config.raid_interval
+                                             : global_config.interval_seconds;
+}
+
+/* MegaCli 점검은 수 초씩 걸리고 멈출 수도 있으므로 메인 루프와 분리해 실행한다 */
+static void *raid_worker_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&cache_lock);
+        probing = 1;
+        probe_started = time(NULL);
+        pthread_mutex_unlock(&cache_lock);
+
+        RaidInfo info = get_raid_info();
+
+        pthread_mutex_lock(&cache_lock);
+        cached_info = info;
+        cached_updated = time(NULL);
+        probing = 0;
+
+        /* 다음 주기까지 대기. raid_worker_kick()이 오면 바로 다시 점검 */
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += raid_period();
+        while (!kicked) {
+            if (pthread_cond_timedwait(&kick_cond, &cache_lock, &deadline) == ETIMEDOUT)
+                break;
+        }
+        kicked = 0;
+        pthread_mutex_unlock(&cache_lock);
+    }
+    return NULL;
+}
+
+int raid_worker_start(void) {
+    pthread_condattr_t attr;
+    pthread_t tid;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&kick_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    int err = pthread_create(&tid, NULL, raid_worker_main, NULL);
+    if (err != 0) {
+        syslog(LOG_ERR, "Failed to start RAID worker: %s", strerror(err));
+        return -1;
+    }
+    pthread_detach(tid);
+    return 0;
+}
+
+/* 캐시된 결과를 막힘 없이 복사한다. 결과의 신선도와 점검 지연 여부도 함께 판단 */
+void raid_worker_get(RaidStatus *status) {
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&cache_lock);
+    status->info = cached_info;
+    status->updated = cached_updated;
+    status->probe_timeout = cached_info.timed_out ||
+                            (probing && (now - probe_started) > global_config.raid_probe_timeout);
+    pthread_mutex_unlock(&cache_lock);
+
+    status->stale = (status->updated == 0) || (now - status->updated) > global_config.raid_cache_ttl;
+}
+
+/* 대기 중인 워커를 깨워 바로 다시 점검하게 한다 */
+void raid_worker_kick(void) {
+    pthread_mutex_lock(&cache_lock);
+    kicked = 1;
+    pthread_cond_signal(&kick_cond);
+    pthread_mutex_unlock(&cache_lock);
+}
@@ -0,0 +1,19 @@
+#ifndef RAIDWORKER_H
+#define RAIDWORKER_H
+
+#include <time.h>
+#include "metrics.h"
+
+/* 백그라운드 RAID 점검 결과 캐시 */
+typedef struct {
+    RaidInfo info;           /* 마지막으로 끝난 점검 결과 */
+    time_t updated;          /* 점검이 끝난 시각, 0이면 아직 결과 없음 */
+    int stale;               /* RAID_CACHE_TTL보다 오래된 결과 */
+    int probe_timeout;       /* 점검이 RAID_PROBE_TIMEOUT을 넘김 (진행 중이거나 직전 점검) */
+} RaidStatus;
+
+int raid_worker_start(void);
+void raid_worker_get(RaidStatus *status);
+void raid_worker_kick(void);
+
+#endif // RAIDWORKER_H
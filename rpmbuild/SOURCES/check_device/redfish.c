@@ -0,0 +1,618 @@
+#include "redfish.h"
+#include "config.h"
+#include "json.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+#include <curl/curl.h>
+
+#define RF_MAX_RESOURCES 320
+#define RF_PATH_LEN 256
+#define RF_MAX_LINKS RAID_MAX_PDS
+
+/* 리소스별 ETag와 마지막 본문. 304 Not Modified면 저장해 둔 본문을 다시 파싱한다 */
+typedef struct {
+    char path[RF_PATH_LEN];
+    char etag[128];
+    char *body;
+    size_t len;
+    int used;                  /* 이번 주기에 참조됨 */
+} rf_resource_t;
+
+/* BMC 연결 하나. CURL 핸들을 재사용하므로 같은 TCP/TLS 연결이 유지된다 (keep-alive) */
+typedef struct {
+    CURL *curl;
+    char errbuf[CURL_ERROR_SIZE];
+    rf_resource_t resources[RF_MAX_RESOURCES];
+    char *recv;                /* 응답 본문 수신 버퍼 */
+    size_t recv_len, recv_cap;
+    char recv_etag[128];
+    char *scratch;             /* 파싱용 복사본 (JSON 파서가 그 자리에서 자른다) */
+    size_t scratch_cap;
+    unsigned long requests, not_modified;
+} rf_client_t;
+
+/* 팬/전원/온도용 (redfish 스레드)과 RAID용 (RAID 워커 스레드) 연결을 따로 둔다 */
+static rf_client_t hw_client, raid_client;
+
+static pthread_mutex_t hw_lock = PTHREAD_MUTEX_INITIALIZER;
+static FanSpeeds cached_fan;
+static PowerInfo cached_power;
+static SensorInfo cached_sensors;
+static long long cached_updated_ms;
+static long long started_ms;
+
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static size_t on_body(char *data, size_t size, size_t nmemb, void *arg) {
+    rf_client_t *c = arg;
+    size_t n = size * nmemb;
+    if (c->recv_len + n + 1 > c->recv_cap) {
+        size_t cap = c->recv_cap ? c->recv_cap : 65536;
+        while (cap < c->recv_len + n + 1)
+            cap *= 2;
+        char *bigger = realloc(c->recv, cap);
+        if (bigger == NULL)
+            return 0;
+        c->recv = bigger;
+        c->recv_cap = cap;
+    }
+    memcpy(c->recv + c->recv_len, data, n);
+    c->recv_len += n;
+    c->recv[c->recv_len] = '\0';
+    return n;
+}
+
+static size_t on_header(char *data, size_t size, size_t nmemb, void *arg) {
+    rf_client_t *c = arg;
+    size_t n = size * nmemb;
+    if (n > 5 && strncasecmp(data, "ETag:", 5) == 0) {
+        const char *v = data + 5;
+        size_t len = n - 5;
+        while (len > 0 && isspace((unsigned char)*v)) {
+            v++;
+            len--;
+        }
+        while (len > 0 && isspace((unsigned char)v[len - 1]))
+            len--;
+        if (len >= sizeof(c->recv_etag))
+            len = 0;
+        memcpy(c->recv_etag, v, len);
+        c->recv_etag[len] = '\0';
+    }
+    return n;
+}
+
+static int client_open(rf_client_t *c) {
+    if (c->curl)
+        return 0;
+    c->curl = curl_easy_init();
+    if (c->curl == NULL)
+        return -1;
+    curl_easy_setopt(c->curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(c->curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(c->curl, CURLOPT_ERRORBUFFER, c->errbuf);
+    curl_easy_setopt(c->curl, CURLOPT_WRITEFUNCTION, on_body);
+    curl_easy_setopt(c->curl, CURLOPT_WRITEDATA, c);
+    curl_easy_setopt(c->curl, CURLOPT_HEADERFUNCTION, on_header);
+    curl_easy_setopt(c->curl, CURLOPT_HEADERDATA, c);
+    curl_easy_setopt(c->curl, CURLOPT_TIMEOUT, (long)global_config.redfish_timeout);
+    curl_easy_setopt(c->curl, CURLOPT_CONNECTTIMEOUT, (long)global_config.redfish_timeout);
+    if (global_config.redfish_user[0]) {
+        curl_easy_setopt(c->curl, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
+        curl_easy_setopt(c->curl, CURLOPT_USERNAME, global_config.redfish_user);
+        curl_easy_setopt(c->curl, CURLOPT_PASSWORD, global_config.redfish_password);
+    }
+    if (!global_config.redfish_verify_tls) {
+        /* BMC는 자체 서명 인증서가 대부분이다 */
+        curl_easy_setopt(c->curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(c->curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    }
+    return 0;
+}
+
+static void begin_cycle(rf_client_t *c) {
+    for (int i = 0; i < RF_MAX_RESOURCES; i++)
+        c->resources[i].used = 0;
+}
+
+/* 이번 주기에 참조하지 않은 리소스(없어진 드라이브 등)는 캐시에서 지운다 */
+static void end_cycle(rf_client_t *c) {
+    for (int i = 0; i < RF_MAX_RESOURCES; i++) {
+        rf_resource_t *r = &c->resources[i];
+        if (r->path[0] && !r->used) {
+            free(r->body);
+            memset(r, 0, sizeof(*r));
+        }
+    }
+}
+
+static rf_resource_t *find_resource(rf_client_t *c, const char *path) {
+    rf_resource_t *free_slot = NULL;
+    for (int i = 0; i < RF_MAX_RESOURCES; i++) {
+        rf_resource_t *r = &c->resources[i];
+        if (r->path[0] == '\0') {
+            if (!free_slot)
+                free_slot = r;
+        } else if (strcmp(r->path, path) == 0) {
+            return r;
+        }
+    }
+    if (free_slot)
+        snprintf(free_slot->path, sizeof(free_slot->path), "%s", path);
+    return free_slot;
+}
+
+/* path를 GET 한다. 바뀌지 않았으면 (304) 캐시된 본문을 쓴다.
+   반환값은 파싱용 복사본으로 다음 호출 전까지 유효하다. 실패하면 NULL */
+static char *rf_get(rf_client_t *c, const char *path) {
+    if (client_open(c) != 0)
+        return NULL;
+    rf_resource_t *r = find_resource(c, path);
+    if (r == NULL) {
+        syslog(LOG_WARNING, "redfish: more than %d resources, skipping %s", RF_MAX_RESOURCES, path);
+        return NULL;
+    }
+    /* 같은 주기에 이미 받은 리소스 (섀시 등)는 다시 묻지 않는다 */
+    if (r->used && r->body)
+        goto copy;
+    r->used = 1;
+
+    char url[512], cond[160];
+    snprintf(url, sizeof(url), "%s%s", global_config.redfish_url, path);
+    struct curl_slist *headers = NULL;
+    headers = curl_slist_append(headers, "Accept: application/json");
+    headers = curl_slist_append(headers, "OData-Version: 4.0");
+    if (r->etag[0] && r->body) {
+        snprintf(cond, sizeof(cond), "If-None-Match: %s", r->etag);
+        headers = curl_slist_append(headers, cond);
+    }
+
+    c->recv_len = 0;
+    c->recv_etag[0] = '\0';
+    c->errbuf[0] = '\0';
+    curl_easy_setopt(c->curl, CURLOPT_URL, url);
+    curl_easy_setopt(c->curl, CURLOPT_HTTPHEADER, headers);
+    CURLcode rc = curl_easy_perform(c->curl);
+    curl_easy_setopt(c->curl, CURLOPT_HTTPHEADER, NULL);
+    curl_slist_free_all(headers);
+    c->requests++;
+
+    if (rc != CURLE_OK) {
+        syslog(LOG_ERR, "redfish: GET %s failed: %s", path,
+               c->errbuf[0] ? c->errbuf : curl_easy_strerror(rc));
+        return NULL;
+    }
+    long status = 0;
+    curl_easy_getinfo(c->curl, CURLINFO_RESPONSE_CODE, &status);
+    if (status == 304 && r->body) {
+        c->not_modified++;
+    } else if (status == 200 && c->recv_len > 0) {
+        char *body = realloc(r->body, c->recv_len + 1);
+        if (body == NULL)
+            return NULL;
+        memcpy(body, c->recv, c->recv_len + 1);
+        r->body = body;
+        r->len = c->recv_len;
+        snprintf(r->etag, sizeof(r->etag), "%s", c->recv_etag);
+    } else {
+        syslog(LOG_ERR, "redfish: GET %s returned HTTP %ld", path, status);
+        return NULL;
+    }
+
+copy:
+    if (r->len + 1 > c->scratch_cap) {
+        char *bigger = realloc(c->scratch, r->len + 1);
+        if (bigger == NULL)
+            return NULL;
+        c->scratch = bigger;
+        c->scratch_cap = r->len + 1;
+    }
+    memcpy(c->scratch, r->body, r->len + 1);
+    return c->scratch;
+}
+
+static int key_is(const char *key, const char *name) {
+    return key && strcmp(key, name) == 0;
+}
+
+/* ---- 링크 모으기: "Members": [{"@odata.id": ...}], "Power": {"@odata.id": ...} ---- */
+
+typedef struct {
+    const char *member;                /* 최상위 멤버 이름 */
+    char (*links)[RF_PATH_LEN];
+    int count;
+    int max;
+} link_list_t;
+
+static int on_links(const json_event_t *ev, void *arg) {
+    link_list_t *l = arg;
+    if (ev->type != JSON_STRING || !key_is(ev->key, "@odata.id"))
+        return 0;
+    /* depth 2: 객체 링크, depth 3: 배열 원소 링크 */
+    if ((ev->depth == 2 || (ev->depth == 3 && ev->keys[2] == NULL)) &&
+        key_is(ev->keys[1], l->member) && l->count < l->max) {
+        snprintf(l->links[l->count++], RF_PATH_LEN, "%s", ev->value);
+    }
+    return 0;
+}
+
+static int get_links(rf_client_t *c, const char *path, const char *member,
+                     char (*links)[RF_PATH_LEN], int max) {
+    link_list_t l = { member, links, 0, max };
+    char *body = rf_get(c, path);
+    if (body == NULL || json_parse(body, on_links, &l) != 0)
+        return -1;
+    return l.count;
+}
+
+/* 컬렉션의 첫 멤버 아래에서 member 링크를 찾는다 (예: Chassis -> Chassis/1 -> Power) */
+static int get_first_member_link(rf_client_t *c, const char *collection,
+                                 const char *member, char *out) {
+    char first[1][RF_PATH_LEN];
+    char link[1][RF_PATH_LEN];
+    if (get_links(c, collection, "Members", first, 1) < 1)
+        return -1;
+    if (get_links(c, first[0], member, link, 1) < 1)
+        return -1;
+    snprintf(out, RF_PATH_LEN, "%s", link[0]);
+    return 0;
+}
+
+/* Redfish Status.Health / Status.State */
+typedef struct {
+    char health[16];
+    char state[24];
+} rf_status_t;
+
+static void take_status(rf_status_t *st, const json_event_t *ev) {
+    if (key_is(ev->key, "Health"))
+        snprintf(st->health, sizeof(st->health), "%s", ev->value);
+    else if (key_is(ev->key, "State"))
+        snprintf(st->state, sizeof(st->state), "%s", ev->value);
+}
+
+/* ---- Power: PowerSupplies[].Status ---- */
+
+typedef struct {
+    int count;
+    rf_status_t psu[2];
+} power_parse_t;
+
+static int on_power(const json_event_t *ev, void *arg) {
+    power_parse_t *p = arg;
+    if (ev->depth < 2 || !key_is(ev->keys[1], "PowerSupplies"))
+        return 0;
+    if (ev->type == JSON_OBJECT_BEGIN && ev->depth == 2) {
+        p->count++;
+    } else if (ev->type == JSON_STRING && ev->depth == 4 && key_is(ev->keys[3], "Status") &&
+               p->count >= 1 && p->count <= 2) {
+        take_status(&p->psu[p->count - 1], ev);
+    }
+    return 0;
+}
+
+/* 앞의 두 전원 공급 장치를 Power1/Power2로: 정상 "OK", 빠졌거나 이상 "Fail" */
+static void psu_state(const power_parse_t *p, int i, char *out, size_t size) {
+    const rf_status_t *st = &p->psu[i];
+    if (i >= p->count || (st->health[0] == '\0' && st->state[0] == '\0'))
+        snprintf(out, size, "Unknown");
+    else if (strcmp(st->state, "Absent") == 0 || strcmp(st->health, "OK") != 0)
+        snprintf(out, size, "Fail");
+    else
+        snprintf(out, size, "OK");
+}
+
+/* ---- Thermal: Fans[], Temperatures[] ---- */
+
+typedef struct {
+    SensorInfo *info;
+    Sensor *cur;
+    int has_reading;
+    rf_status_t status;
+} thermal_parse_t;
+
+static int on_thermal(const json_event_t *ev, void *arg) {
+    thermal_parse_t *t = arg;
+    if (ev->depth < 2)
+        return 0;
+    int fans = key_is(ev->keys[1], "Fans");
+    if (!fans && !key_is(ev->keys[1], "Temperatures"))
+        return 0;
+
+    if (ev->depth == 2 && ev->type == JSON_OBJECT_BEGIN) {
+        t->cur = NULL;
+        if (t->info->count >= MAX_SENSORS)
+            return 0;
+        t->cur = &t->info->sensors[t->info->count++];
+        memset(t->cur, 0, sizeof(*t->cur));
+        memset(&t->status, 0, sizeof(t->status));
+        snprintf(t->cur->chip, sizeof(t->cur->chip), REDFISH_SENSOR_CHIP);
+        t->cur->type = fans ? SENSOR_FAN : SENSOR_TEMP;
+        t->has_reading = 0;
+        return 0;
+    }
+    if (t->cur == NULL)
+        return 0;
+    if (ev->depth == 2 && ev->type == JSON_OBJECT_END) {
+        /* 빠진 센서와 값이 없는 센서는 버린다 */
+        if (!t->has_reading || strcmp(t->status.state, "Absent") == 0) {
+            t->info->count--;
+        } else {
+            if (t->status.health[0] && strcmp(t->status.health, "OK") != 0)
+                t->cur->alarm = 1;
+            if (t->cur->crit > 0 && t->cur->value >= t->cur->crit)
+                t->cur->alarm = 1;
+            if (t->cur->type == SENSOR_FAN && t->cur->min > 0 && t->cur->value < t->cur->min)
+                t->cur->alarm = 1;
+        }
+        t->cur = NULL;
+        return 0;
+    }
+
+    if (ev->depth == 4 && ev->type == JSON_STRING && key_is(ev->keys[3], "Status")) {
+        take_status(&t->status, ev);
+    } else if (ev->depth == 3 && ev->type == JSON_STRING &&
+               (key_is(ev->key, "Name") || (key_is(ev->key, "FanName") && t->cur->label[0] == '\0'))) {
+        snprintf(t->cur->label, sizeof(t->cur->label), "%s", ev->value);
+    } else if (ev->depth == 3 && ev->type == JSON_NUMBER) {
+        double v = atof(ev->value);
+        if (key_is(ev->key, "Reading") || key_is(ev->key, "ReadingCelsius")) {
+            t->cur->value = v;
+            t->has_reading = 1;
+        } else if (key_is(ev->key, "LowerThresholdCritical")) {
+            t->cur->min = v;
+        } else if (key_is(ev->key, "UpperThresholdNonCritical")) {
+            t->cur->max = v;
+        } else if (key_is(ev->key, "UpperThresholdCritical")) {
+            t->cur->crit = v;
+        }
+    }
+    return 0;
+}
+
+/* ---- Storage: 드라이브와 볼륨 ---- */
+
+typedef struct {
+    char id[32];
+    char name[64];
+    char raid_type[16];
+    rf_status_t status;
+    int failure_predicted;
+    int location;
+} rf_item_t;
+
+static int on_item(const json_event_t *ev, void *arg) {
+    rf_item_t *it = arg;
+    if (ev->depth == 1 && ev->type == JSON_STRING) {
+        if (key_is(ev->key, "Id"))
+            snprintf(it->id, sizeof(it->id), "%s", ev->value);
+        else if (key_is(ev->key, "Name"))
+            snprintf(it->name, sizeof(it->name), "%s", ev->value);
+        else if (key_is(ev->key, "RAIDType"))
+            snprintf(it->raid_type, sizeof(it->raid_type), "%s", ev->value);
+    } else if (ev->depth == 1 && ev->type == JSON_TRUE && key_is(ev->key, "FailurePredicted")) {
+        it->failure_predicted = 1;
+    } else if (ev->depth == 2 && ev->type == JSON_STRING && key_is(ev->keys[1], "Status")) {
+        take_status(&it->status, ev);
+    } else if (ev->type == JSON_NUMBER && key_is(ev->key, "LocationOrdinalValue") &&
+               key_is(ev->keys[1], "PhysicalLocation")) {
+        it->location = atoi(ev->value);
+    }
+    return 0;
+}
+
+static int get_item(rf_client_t *c, const char *path, rf_item_t *it) {
+    memset(it, 0, sizeof(*it));
+    it->location = -1;
+    char *body = rf_get(c, path);
+    if (body == NULL || json_parse(body, on_item, it) != 0)
+        return -1;
+    return 0;
+}
+
+static void add_drive(RaidInfo *info, int adapter, const rf_item_t *it) {
+    if (strcmp(it->status.state, "Absent") == 0 || info->pd_count >= RAID_MAX_PDS)
+        return;
+    RaidPd *pd = &info->pds[info->pd_count];
+    memset(pd, 0, sizeof(*pd));
+    pd->adapter = adapter;
+    pd->vd = -1;
+    pd->enclosure = -1;
+    pd->slot = (it->location >= 0) ? it->location : info->pd_count;
+    snprintf(pd->device, sizeof(pd->device), "%s", it->id);
+    if (strcmp(it->status.health, "Critical") == 0)
+        snprintf(pd->state, sizeof(pd->state), "Failed");
+    else if (strcmp(it->status.state, "StandbySpare") == 0)
+        snprintf(pd->state, sizeof(pd->state), "Hotspare");
+    else if (strcmp(it->status.health, "OK") == 0 || it->status.health[0] == '\0')
+        snprintf(pd->state, sizeof(pd->state), "Online");
+    else
+        snprintf(pd->state, sizeof(pd->state), "%s", it->status.health);
+    pd->predictive_failures = it->failure_predicted;
+    info->pd_count++;
+}
+
+static void add_volume(RaidInfo *info, int adapter, const rf_item_t *it) {
+    if (info->vd_count >= RAID_MAX_VDS)
+        return;
+    RaidVd *vd = &info->vds[info->vd_count];
+    memset(vd, 0, sizeof(*vd));
+    vd->adapter = adapter;
+    vd->id = isdigit((unsigned char)it->id[0]) ? atoi(it->id) : info->vd_count;
+    const char *lvl = strncmp(it->raid_type, "RAID", 4) == 0 ? it->raid_type + 4 : it->raid_type;
+    snprintf(vd->level, sizeof(vd->level), "%s", lvl);
+    if (strcmp(it->status.health, "OK") == 0 || it->status.health[0] == '\0')
+        snprintf(vd->state, sizeof(vd->state), "Optimal");
+    else if (strcmp(it->status.health, "Warning") == 0)
+        snprintf(vd->state, sizeof(vd->state), "Degraded");
+    else
+        snprintf(vd->state, sizeof(vd->state), "Offline");
+    info->vd_count++;
+}
+
+/* Systems/<첫 시스템>/Storage 아래의 컨트롤러마다 드라이브와 볼륨을 읽는다.
+   RAID 워커 스레드에서 호출한다. VD를 하나도 얻지 못하면 -1 */
+int redfish_get_raid_info(RaidInfo *info) {
+    static char storages[8][RF_PATH_LEN];
+    static char links[RF_MAX_LINKS][RF_PATH_LEN];
+    char storage_path[RF_PATH_LEN];
+    rf_client_t *c = &raid_client;
+
+    if (global_config.redfish_url[0] == '\0')
+        return -1;
+    begin_cycle(c);
+    if (get_first_member_link(c, "/redfish/v1/Systems", "Storage", storage_path) != 0) {
+        end_cycle(c);
+        return -1;
+    }
+    int nstorage = get_links(c, storage_path, "Members", storages, 8);
+    for (int s = 0; s < nstorage; s++) {
+        rf_item_t it;
+        char volumes[1][RF_PATH_LEN];
+        info->adapter_count++;
+
+        int ndrives = get_links(c, storages[s], "Drives", links, RF_MAX_LINKS);
+        for (int d = 0; d < ndrives; d++) {
+            if (get_item(c, links[d], &it) == 0)
+                add_drive(info, s, &it);
+        }
+        if (get_links(c, storages[s], "Volumes", volumes, 1) < 1)
+            continue;
+        int nvol = get_links(c, volumes[0], "Members", links, RF_MAX_LINKS);
+        for (int v = 0; v < nvol; v++) {
+            if (get_item(c, links[v], &it) == 0)
+                add_volume(info, s, &it);
+        }
+    }
+    end_cycle(c);
+    return info->vd_count > 0 ? 0 : -1;
+}
+
+/* Chassis/<첫 섀시>/Power, Thermal을 읽어 캐시를 갱신한다 */
+static void poll_hw(void) {
+    static SensorInfo sensors;
+    char path[RF_PATH_LEN];
+    rf_client_t *c = &hw_client;
+    power_parse_t power;
+    PowerInfo pinfo;
+    FanSpeeds fan;
+    int ok = 1;
+
+    begin_cycle(c);
+    memset(&power, 0, sizeof(power));
+    memset(&pinfo, 0, sizeof(pinfo));
+    memset(&fan, 0, sizeof(fan));
+    memset(&sensors, 0, sizeof(sensors));
+
+    char *body;
+    if (get_first_member_link(c, "/redfish/v1/Chassis", "Power", path) == 0 &&
+        (body = rf_get(c, path)) != NULL && json_parse(body, on_power, &power) == 0) {
+        psu_state(&power, 0, pinfo.power1, sizeof(pinfo.power1));
+        psu_state(&power, 1, pinfo.power2, sizeof(pinfo.power2));
+    } else {
+        ok = 0;
+    }
+
+    thermal_parse_t thermal = { &sensors, NULL, 0, { "", "" } };
+    if (get_first_member_link(c, "/redfish/v1/Chassis", "Thermal", path) == 0 &&
+        (body = rf_get(c, path)) != NULL && json_parse(body, on_thermal, &thermal) == 0) {
+        /* 기존 팬 필드(cpuFan, auxFan, FAN1~3)에는 앞의 다섯 팬을 순서대로 넣는다 */
+        int *slots[] = { &fan.cpuFan, &fan.auxFan, &fan.fan1, &fan.fan2, &fan.fan3 };
+        int n = 0;
+        for (int i = 0; i < sensors.count && n < 5; i++) {
+            if (sensors.sensors[i].type == SENSOR_FAN)
+                *slots[n++] = (int)sensors.sensors[i].value;
+        }
+    } else {
+        ok = 0;
+    }
+    end_cycle(c);
+
+    if (!ok)
+        return;
+    pthread_mutex_lock(&hw_lock);
+    cached_power = pinfo;
+    cached_fan = fan;
+    cached_sensors = sensors;
+    cached_updated_ms = monotonic_ms();
+    pthread_mutex_unlock(&hw_lock);
+}
+
+static void *redfish_main(void *arg) {
+    (void)arg;
+    int period = global_config.redfish_interval > 0 ? global_config.redfish_interval
+                                                    : global_config.interval_seconds;
+    for (;;) {
+        unsigned long before = hw_client.not_modified;
+        unsigned long requests = hw_client.requests;
+        poll_hw();
+        syslog(LOG_DEBUG, "redfish: %lu requests, %lu not modified",
+               hw_client.requests - requests, hw_client.not_modified - before);
+        sleep(period);
+    }
+    return NULL;
+}
+
+/* libcurl 초기화 (스레드를 띄우기 전 메인 스레드에서 한 번).
+   HW_SOURCE=redfish면 팬/전원/온도 수집 스레드를 띄운다 */
+int redfish_init(void) {
+    if (global_config.redfish_url[0] == '\0')
+        return 0;
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
+        syslog(LOG_ERR, "redfish: curl_global_init failed");
+        return -1;
+    }
+    if (strcmp(global_config.hw_source, "redfish") != 0)
+        return 0;
+
+    pthread_t tid;
+    started_ms = monotonic_ms();
+    if (pthread_create(&tid, NULL, redfish_main, NULL) != 0) {
+        syslog(LOG_ERR, "redfish: failed to start thread");
+        return -1;
+    }
+    pthread_detach(tid);
+    return 0;
+}
+
+/* 마지막 Power/Thermal 결과. REDFISH_INTERVAL + HW_HELPER_TIMEOUT 넘게 갱신되지 않으면 stale */
+void redfish_get_hw(HwStatus *status) {
+    memset(status, 0, sizeof(*status));
+    pthread_mutex_lock(&hw_lock);
+    status->fan = cached_fan;
+    status->power = cached_power;
+    long long updated = cached_updated_ms;
+    pthread_mutex_unlock(&hw_lock);
+
+    long long now = monotonic_ms();
+    long long limit = (long long)hw_stale_limit() * 1000;
+    status->updated = (updated != 0);
+    if (!status->updated) {
+        status->age = -1;
+        status->stale = (now - started_ms) > limit;
+        return;
+    }
+    status->age = (int)((now - updated) / 1000);
+    status->stale = (now - updated) > limit;
+}
+
+/* hwmon 센서 표 뒤에 BMC의 팬/온도 센서를 붙인다 */
+void redfish_append_sensors(SensorInfo *info) {
+    if (strcmp(global_config.hw_source, "redfish") != 0)
+        return;
+    pthread_mutex_lock(&hw_lock);
+    for (int i = 0; i < cached_sensors.count && info->count < MAX_SENSORS; i++)
+        info->sensors[info->count++] = cached_sensors.sensors[i];
+    pthread_mutex_unlock(&hw_lock);
+}
@@ -0,0 +1,15 @@
+#ifndef REDFISH_H
+#define REDFISH_H
+
+#include "metrics.h"
+#include "hwmon.h"
+#include "hwhelper.h"
+
+#define REDFISH_SENSOR_CHIP "redfish"
+
+int redfish_init(void);
+void redfish_get_hw(HwStatus *status);
+void redfish_append_sensors(SensorInfo *info);
+int redfish_get_raid_info(RaidInfo *info);
+
+#endif // REDFISH_H
@@ -0,0 +1,268 @@
+#include "rules.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <fnmatch.h>
+#include <syslog.h>
+
+#define CPU_OID ".1.3.6.1.4.1.8072.2.3.0.1"
+#define MEM_OID ".1.3.6.1.4.1.8072.2.3.0.2"
+#define DISK_OID ".1.3.6.1.4.1.8072.2.3.0.3"
+#define TEMP_OID ".1.3.6.1.4.1.8072.2.3.0.4"
+#define NET_RX_OID ".1.3.6.1.4.1.8072.2.3.0.5"
+#define NET_TX_OID ".1.3.6.1.4.1.8072.2.3.0.6"
+#define NET_RX_UTIL_OID ".1.3.6.1.4.1.8072.2.3.0.12"
+#define NET_TX_UTIL_OID ".1.3.6.1.4.1.8072.2.3.0.13"
+#define INODE_OID ".1.3.6.1.4.1.8072.2.3.0.14"
+#define DISK_UTIL_OID ".1.3.6.1.4.1.8072.2.3.0.16"
+#define DISK_AWAIT_OID ".1.3.6.1.4.1.8072.2.3.0.17"
+
+/* *_THRESHOLD 설정으로 만드는 기본 규칙 수 */
+#define BUILTIN_RULES 11
+
+/* 지표가 있는 곳: 스냅샷에 하나, 또는 마운트/장치/인터페이스 배열의 원소마다 */
+enum { SCOPE_HOST = 0, SCOPE_MOUNT, SCOPE_DISK, SCOPE_IFACE };
+enum { VALUE_FLOAT = 0, VALUE_INT, VALUE_FREE_PCT };
+
+typedef struct {
+    size_t count_off;             /* snapshot_t 안의 원소 수 (int) */
+    size_t base_off;              /* snapshot_t 안의 첫 원소 */
+    size_t stride;
+    size_t name_off;              /* 원소 안의 이름 (char[]) */
+} rule_scope_t;
+
+static const rule_scope_t scopes[] = {
+    [SCOPE_HOST]  = { 0, 0, 0, 0 },
+    [SCOPE_MOUNT] = { offsetof(snapshot_t, mounts.count), offsetof(snapshot_t, mounts.mounts),
+                      sizeof(MountUsage), offsetof(MountUsage, mountpoint) },
+    [SCOPE_DISK]  = { offsetof(snapshot_t, diskio.count), offsetof(snapshot_t, diskio.disks),
+                      sizeof(DiskIo), offsetof(DiskIo, name) },
+    [SCOPE_IFACE] = { offsetof(snapshot_t, net.count), offsetof(snapshot_t, net.ifaces),
+                      sizeof(NetIface), offsetof(NetIface, name) },
+};
+
+/* 규칙에서 쓸 수 있는 지표. 값은 호스트 지표면 snapshot_t, 그 밖에는 원소 안의 offset */
+typedef struct {
+    const char *name;
+    int scope;                    /* SCOPE_* */
+    int type;                     /* VALUE_* */
+    size_t offset;
+    size_t limit_off;             /* 원소 안의 대상별 임계치 (float), 없으면 0 */
+    const char *unit;
+    int skip_negative;            /* 음수는 알 수 없는 값 (아이노드 없는 FS, 속도 모르는 링크) */
+    int needs_hw;                 /* 팬/전원 보조 프로세스 결과가 있을 때만 */
+} metric_def_t;
+
+static const metric_def_t metrics[] = {
+    { "cpu.usage", SCOPE_HOST, VALUE_FLOAT, offsetof(snapshot_t, cpu_usage), 0, "%", 0, 0 },
+    { "mem.usage", SCOPE_HOST, VALUE_FLOAT, offsetof(snapshot_t, mem_usage), 0, "%", 0, 0 },
+    { "mem.free", SCOPE_HOST, VALUE_FREE_PCT, offsetof(snapshot_t, mem_usage), 0, "%", 0, 0 },
+    { "cpu.temp", SCOPE_HOST, VALUE_FLOAT, offsetof(snapshot_t, cpu_temp), 0, "°C", 0, 0 },
+    { "net.rx_rate", SCOPE_HOST, VALUE_FLOAT, offsetof(snapshot_t, net.rx_rate), 0, " bytes/sec", 0, 0 },
+    { "net.tx_rate", SCOPE_HOST, VALUE_FLOAT, offsetof(snapshot_t, net.tx_rate), 0, " bytes/sec", 0, 0 },
+    { "psi.cpu", SCOPE_HOST, VALUE_FLOAT, offsetof(snapshot_t, psi.some_avg10[PSI_CPU]), 0, "%", 0, 0 },
+    { "psi.memory", SCOPE_HOST, VALUE_FLOAT, offsetof(snapshot_t, psi.some_avg10[PSI_MEMORY]), 0, "%", 0, 0 },
+    { "psi.io", SCOPE_HOST, VALUE_FLOAT, offsetof(snapshot_t, psi.some_avg10[PSI_IO]), 0, "%", 0, 0 },
+    { "fan.cpu", SCOPE_HOST, VALUE_INT, offsetof(snapshot_t, fan.cpuFan), 0, " RPM", 0, 1 },
+    { "fan.aux", SCOPE_HOST, VALUE_INT, offsetof(snapshot_t, fan.auxFan), 0, " RPM", 0, 1 },
+    { "fan.fan1", SCOPE_HOST, VALUE_INT, offsetof(snapshot_t, fan.fan1), 0, " RPM", 0, 1 },
+    { "fan.fan2", SCOPE_HOST, VALUE_INT, offsetof(snapshot_t, fan.fan2), 0, " RPM", 0, 1 },
+    { "fan.fan3", SCOPE_HOST, VALUE_INT, offsetof(snapshot_t, fan.fan3), 0, " RPM", 0, 1 },
+    { "disk.usage", SCOPE_MOUNT, VALUE_FLOAT, offsetof(MountUsage, block_usage),
+      offsetof(MountUsage, block_threshold), "%", 0, 0 },
+    { "inode.usage", SCOPE_MOUNT, VALUE_FLOAT, offsetof(MountUsage, inode_usage),
+      offsetof(MountUsage, inode_threshold), "%", 1, 0 },
+    { "disk.util", SCOPE_DISK, VALUE_FLOAT, offsetof(DiskIo, util), 0, "%", 0, 0 },
+    { "disk.await", SCOPE_DISK, VALUE_FLOAT, offsetof(DiskIo, await_ms), 0, " ms", 0, 0 },
+    { "net.rx_util", SCOPE_IFACE, VALUE_FLOAT, offsetof(NetIface, rx_util), 0, "%", 1, 0 },
+    { "net.tx_util", SCOPE_IFACE, VALUE_FLOAT, offsetof(NetIface, tx_util), 0, "%", 1, 0 },
+    { "net.if_rx_rate", SCOPE_IFACE, VALUE_FLOAT, offsetof(NetIface, rx_rate), 0, " bytes/sec", 0, 0 },
+    { "net.if_tx_rate", SCOPE_IFACE, VALUE_FLOAT, offsetof(NetIface, tx_rate), 0, " bytes/sec", 0, 0 },
+};
+
+#define METRIC_COUNT ((int)(sizeof(metrics) / sizeof(metrics[0])))
+
+/* 기본 규칙 다음에 ALARM_RULE 규칙. 평가할 때는 이 배열만 차례로 본다 */
+static AlarmRule rules[BUILTIN_RULES + MAX_ALARM_RULES];
+static int rule_count;
+
+static int find_metric(const char *name) {
+    for (int i = 0; i < METRIC_COUNT; i++)
+        if (strcmp(metrics[i].name, name) == 0)
+            return i;
+    return -1;
+}
+
+static void add_builtin(const char *metric, double critical, int instance_limit, const char *oid, const char *name) {
+    AlarmRule *r = &rules[rule_count++];
+    memset(r, 0, sizeof(*r));
+    r->metric = find_metric(metric);
+    r->op = RULE_OP_GT;
+    r->has_critical = 1;
+    r->critical = critical;
+    r->instance_limit = instance_limit;
+    snprintf(r->oid, sizeof(r->oid), "%s", oid);
+    snprintf(r->name, sizeof(r->name), "%s", name);
+}
+
+static int parse_level(const char *s, int *has, double *level) {
+    char *end;
+    *has = 0;
+    if (strcmp(s, "-") == 0)
+        return 0;
+    *level = strtod(s, &end);
+    if (end == s || *end != '\0')
+        return -1;
+    *has = 1;
+    return 0;
+}
+
+/* "<지표>[@<대상 glob>] <연산자> <warning> <critical> <OID> [이름]". 단계를 쓰지 않으려면 "-" */
+static const char *parse_rule(const char *line, AlarmRule *r) {
+    static const char *const ops[] = { ">", ">=", "<", "<=" };
+    char metric[128], op[4], warning[32], critical[32], oid[64];
+    int name_pos = 0;
+
+    memset(r, 0, sizeof(*r));
+    if (sscanf(line, "%127s %3s %31s %31s %63s %n", metric, op, warning, critical, oid, &name_pos) < 5)
+        return "expected <metric> <op> <warning> <critical> <oid> [name]";
+
+    char *at = strchr(metric, '@');
+    if (at) {
+        *at = '\0';
+        snprintf(r->pattern, sizeof(r->pattern), "%s", at + 1);
+    }
+    if ((r->metric = find_metric(metric)) < 0)
+        return "unknown metric";
+    if (at && metrics[r->metric].scope == SCOPE_HOST)
+        return "metric has no instances";
+
+    r->op = -1;
+    for (int i = 0; i < 4; i++)
+        if (strcmp(op, ops[i]) == 0)
+            r->op = i;
+    if (r->op < 0)
+        return "unknown operator";
+
+    if (parse_level(warning, &r->has_warning, &r->warning) != 0 ||
+        parse_level(critical, &r->has_critical, &r->critical) != 0)
+        return "invalid level";
+    if (!r->has_warning && !r->has_critical)
+        return "no warning or critical level";
+    /* warning 단계가 critical보다 먼저 걸려야 한다 */
+    if (r->has_warning && r->has_critical &&
+        ((r->op <= RULE_OP_GE) ? r->warning > r->critical : r->warning < r->critical))
+        return "warning level beyond critical";
+
+    if (oid[0] != '.' || strspn(oid, ".0123456789") != strlen(oid))
+        return "OID must be numeric";
+    snprintf(r->oid, sizeof(r->oid), "%s", oid);
+    /* 이름을 생략하면 지표 표의 이름 */
+    if (name_pos > 0 && line[name_pos] != '\0')
+        snprintf(r->name, sizeof(r->name), "%s", line + name_pos);
+    else
+        snprintf(r->name, sizeof(r->name), "%s", metrics[r->metric].name);
+    return NULL;
+}
+
+/* *_THRESHOLD 설정과 ALARM_RULE 줄을 규칙 배열로 만든다. 시작할 때와 설정을 다시 읽을 때 부른다 */
+int rules_compile(void) {
+    rule_count = 0;
+    add_builtin("cpu.usage", global_config.cpu_usage_threshold, 0, CPU_OID, "CPU usage high");
+    add_builtin("mem.usage", global_config.mem_usage_threshold, 0, MEM_OID, "Memory usage high");
+    /* 마운트별 임계치는 DISK_MOUNT_THRESHOLDS를 적용한 값을 mounts.c가 채워 둔다 */
+    add_builtin("disk.usage", 0, 1, DISK_OID, "Disk usage high");
+    add_builtin("inode.usage", 0, 1, INODE_OID, "Inode usage high");
+    add_builtin("disk.util", global_config.disk_util_threshold, 0, DISK_UTIL_OID, "Disk I/O utilization high");
+    add_builtin("disk.await", global_config.disk_await_threshold, 0, DISK_AWAIT_OID, "Disk I/O latency high");
+    add_builtin("cpu.temp", global_config.cpu_temp_threshold, 0, TEMP_OID, "CPU temperature high");
+    add_builtin("net.rx_rate", global_config.net_rx_threshold, 0, NET_RX_OID, "Network RX high");
+    add_builtin("net.tx_rate", global_config.net_tx_threshold, 0, NET_TX_OID, "Network TX high");
+    add_builtin("net.rx_util", global_config.net_rx_util_threshold, 0, NET_RX_UTIL_OID, "Network RX utilization high");
+    add_builtin("net.tx_util", global_config.net_tx_util_threshold, 0, NET_TX_UTIL_OID, "Network TX utilization high");
+
+    for (int i = 0; i < global_config.alarm_rule_count; i++) {
+        const char *err = parse_rule(global_config.alarm_rules[i], &rules[rule_count]);
+        if (err) {
+            syslog(LOG_ERR, "Invalid ALARM_RULE \"%s\": %s, ignored", global_config.alarm_rules[i], err);
+            continue;
+        }
+        rule_count++;
+    }
+    return rule_count;
+}
+
+static int compare(int op, double value, double limit) {
+    switch (op) {
+    case RULE_OP_GT: return value > limit;
+    case RULE_OP_GE: return value >= limit;
+    case RULE_OP_LT: return value < limit;
+    default:         return value <= limit;
+    }
+}
+
+static double read_value(const metric_def_t *m, const char *base) {
+    switch (m->type) {
+    case VALUE_INT:      return *(const int *)(base + m->offset);
+    case VALUE_FREE_PCT: return 100.0 - *(const float *)(base + m->offset);
+    default:             return *(const float *)(base + m->offset);
+    }
+}
+
+static void evaluate_one(const AlarmRule *r, const metric_def_t *m, const char *base, const char *instance,
+                         void (*fn)(const RuleSample *sample)) {
+    RuleSample s;
+    s.value = read_value(m, base);
+    if (m->skip_negative && s.value < 0)
+        return;
+
+    double critical = r->instance_limit ? *(const float *)(base + m->limit_off) : r->critical;
+    /* 해제 임계치는 가장 낮은 단계에서 ALARM_HYSTERESIS%만큼 정상 쪽으로 */
+    double lowest = r->has_warning ? r->warning : critical;
+    double margin = (r->op <= RULE_OP_GE) ? -global_config.alarm_hysteresis : global_config.alarm_hysteresis;
+
+    s.rule = r;
+    s.instance = instance;
+    s.unit = m->unit;
+    s.clear_threshold = lowest * (100.0 + margin) / 100.0;
+    s.cleared = (r->op <= RULE_OP_GE) ? s.value <= s.clear_threshold : s.value >= s.clear_threshold;
+    if (r->has_critical && compare(r->op, s.value, critical)) {
+        s.level = RULE_LEVEL_CRITICAL;
+        s.threshold = critical;
+    } else if (r->has_warning && compare(r->op, s.value, r->warning)) {
+        s.level = RULE_LEVEL_WARNING;
+        s.threshold = r->warning;
+    } else {
+        s.level = RULE_LEVEL_NONE;
+        s.threshold = lowest;
+    }
+    fn(&s);
+}
+
+/* 규칙마다 대상별 값을 판정해 fn에 넘긴다. 메모리를 할당하지 않는다 */
+void rules_evaluate(const snapshot_t *snap, void (*fn)(const RuleSample *sample)) {
+    const char *snap_base = (const char *)snap;
+    int hw_valid = snap->hw_updated && !snap->hw_stale;
+
+    for (int i = 0; i < rule_count; i++) {
+        const AlarmRule *r = &rules[i];
+        const metric_def_t *m = &metrics[r->metric];
+        if (m->needs_hw && !hw_valid)
+            continue;
+        if (m->scope == SCOPE_HOST) {
+            evaluate_one(r, m, snap_base, "", fn);
+            continue;
+        }
+        const rule_scope_t *sc = &scopes[m->scope];
+        int count = *(const int *)(snap_base + sc->count_off);
+        for (int j = 0; j < count; j++) {
+            const char *elem = snap_base + sc->base_off + (size_t)j * sc->stride;
+            const char *instance = elem + sc->name_off;
+            if (r->pattern[0] && fnmatch(r->pattern, instance, 0) != 0)
+                continue;
+            evaluate_one(r, m, elem, instance, fn);
+        }
+    }
+}
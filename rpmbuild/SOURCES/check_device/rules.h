@@ -0,0 +1,39 @@
+#ifndef RULES_H
+#define RULES_H
+
+#include "snapshot.h"
+
+/* 단계 (알람 severity). 0이면 정상 */
+enum { RULE_LEVEL_NONE = 0, RULE_LEVEL_WARNING, RULE_LEVEL_CRITICAL };
+
+/* 비교 연산자 */
+enum { RULE_OP_GT = 0, RULE_OP_GE, RULE_OP_LT, RULE_OP_LE };
+
+/* 컴파일한 임계치 규칙 하나 */
+typedef struct {
+    int metric;                   /* 지표 표의 번호 */
+    int op;                       /* RULE_OP_* */
+    int has_warning, has_critical;
+    double warning, critical;
+    int instance_limit;           /* critical 대신 마운트별 임계치(DISK_MOUNT_THRESHOLDS 등)를 쓴다 */
+    char pattern[64];             /* 대상 이름 glob, 비어 있으면 전부 */
+    char oid[64];
+    char name[64];                /* syslog와 트랩 메시지에 쓰는 이름 */
+} AlarmRule;
+
+/* 규칙 하나를 대상 하나에 적용한 결과 */
+typedef struct {
+    const AlarmRule *rule;
+    const char *instance;         /* 마운트, 장치, 인터페이스 이름. 호스트 지표는 "" */
+    const char *unit;
+    double value;
+    int level;                    /* RULE_LEVEL_* */
+    double threshold;             /* 넘은 단계의 임계치 (정상이면 가장 낮은 단계) */
+    int cleared;                  /* 해제 임계치 안쪽 (히스테리시스 적용) */
+    double clear_threshold;
+} RuleSample;
+
+int rules_compile(void);
+void rules_evaluate(const snapshot_t *snap, void (*fn)(const RuleSample *sample));
+
+#endif // RULES_H
@@ -0,0 +1,254 @@
+#include "scheduler.h"
+#include "mdraid.h"
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <syslog.h>
+#include <poll.h>
+#include <sys/timerfd.h>
+
+#define MAX_TASKS 32
+/* 고정 감시 fd (SIGHUP, kmsg, uevent, mountinfo, PSI 트리거 등)와 md 배열 감시 */
+#define MAX_FDS (16 + MD_WATCH_FDS)
+
+/* 주기 작업. 마감 시각(deadline)은 벽시계 기준 period의 배수로 정렬된다 */
+typedef struct {
+    const char *name;
+    int period;
+    sched_task_fn fn;
+    void *arg;
+    time_t deadline;
+    int order;              /* 같은 마감 시각이면 등록 순서대로 실행 */
+} sched_task_t;
+
+static sched_task_t tasks[MAX_TASKS];
+static int task_count;
+
+/* 마감 시각 기준 최소 힙 (tasks 인덱스) */
+static int heap[MAX_TASKS];
+static int heap_size;
+
+/* 주기 작업 사이에 감시하는 이벤트 fd (POLLPRI 등) */
+typedef struct {
+    int fd;
+    short events;
+    sched_fd_fn fn;
+    void *arg;
+} sched_fd_t;
+
+static sched_fd_t watch_fds[MAX_FDS];
+static int watch_count;
+
+static int timer_fd = -1;
+static unsigned long overrun_count;
+
+static int task_before(int a, int b) {
+    if (tasks[a].deadline != tasks[b].deadline)
+        return tasks[a].deadline < tasks[b].deadline;
+    return tasks[a].order < tasks[b].order;
+}
+
+static void heap_swap(int i, int j) {
+    int tmp = heap[i];
+    heap[i] = heap[j];
+    heap[j] = tmp;
+}
+
+static void heap_push(int idx) {
+    int i = heap_size++;
+    heap[i] = idx;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!task_before(heap[i], heap[parent]))
+            break;
+        heap_swap(i, parent);
+        i = parent;
+    }
+}
+
+static int heap_pop(void) {
+    int top = heap[0];
+    heap[0] = heap[--heap_size];
+    int i = 0;
+    for (;;) {
+        int left = 2 * i + 1, right = left + 1, min = i;
+        if (left < heap_size && task_before(heap[left], heap[min]))
+            min = left;
+        if (right < heap_size && task_before(heap[right], heap[min]))
+            min = right;
+        if (min == i)
+            break;
+        heap_swap(i, min);
+        i = min;
+    }
+    return top;
+}
+
+/* 가장 이른 마감 시각에 단발 타이머를 건다.
+   시스템 시각이 바뀌면 read()가 ECANCELED로 알려준다. */
+static int arm_timer(time_t deadline) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = deadline;
+    return timerfd_settime(timer_fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &its, NULL);
+}
+
+/* 실행을 마친 작업의 다음 마감 시각을 계산한다.
+   이미 지나간 마감은 (늦게 시작했든 오래 걸렸든) 몰아서 실행하지 않고 건너뛰며 그 수를 센다.
+   지금과 같은 마감은 지나간 것이 아니므로 바로 실행한다. */
+static void reschedule(sched_task_t *t, time_t now) {
+    time_t next = (t->deadline / t->period + 1) * t->period;
+    if (next < now) {
+        long missed = (now - next + t->period - 1) / t->period;
+        next += (time_t)missed * t->period;
+        overrun_count += missed;
+        syslog(LOG_WARNING, "Task %s overrun: skipped %ld interval(s), total %lu",
+               t->name, missed, overrun_count);
+    }
+    t->deadline = next;
+}
+
+/* 시각이 변경되었으면 모든 작업을 새 시각 기준으로 다시 정렬 */
+static void realign_all(void) {
+    time_t now = time(NULL);
+    heap_size = 0;
+    for (int i = 0; i < task_count; i++) {
+        tasks[i].deadline = (now / tasks[i].period + 1) * tasks[i].period;
+        heap_push(i);
+    }
+}
+
+/* 절대 마감 시각 기반 스케줄러 초기화 */
+int scheduler_init(void) {
+    timer_fd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        syslog(LOG_ERR, "timerfd_create failed: %s", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/* 주기 작업 등록. 첫 실행은 곧바로 하고 이후는 정렬된 마감 시각에 실행한다 */
+int scheduler_add_task(const char *name, int period_seconds, sched_task_fn fn, void *arg) {
+    if (task_count >= MAX_TASKS) {
+        syslog(LOG_ERR, "Too many scheduler tasks, dropping %s", name);
+        return -1;
+    }
+    sched_task_t *t = &tasks[task_count];
+    t->name = name;
+    t->period = (period_seconds > 0) ? period_seconds : 60;
+    t->fn = fn;
+    t->arg = arg;
+    t->deadline = time(NULL);
+    t->order = task_count;
+    heap_push(task_count);
+    task_count++;
+    return 0;
+}
+
+/* 이벤트 fd 등록. 주기 작업을 기다리는 동안 events가 발생하면 fn을 호출한다 */
+int scheduler_add_fd(int fd, short events, sched_fd_fn fn, void *arg) {
+    if (watch_count >= MAX_FDS) {
+        syslog(LOG_ERR, "Too many scheduler event fds, dropping fd %d", fd);
+        return -1;
+    }
+    watch_fds[watch_count].fd = fd;
+    watch_fds[watch_count].events = events;
+    watch_fds[watch_count].fn = fn;
+    watch_fds[watch_count].arg = arg;
+    watch_count++;
+    return 0;
+}
+
+void scheduler_remove_fd(int fd) {
+    for (int i = 0; i < watch_count; i++) {
+        if (watch_fds[i].fd == fd) {
+            watch_fds[i] = watch_fds[--watch_count];
+            return;
+        }
+    }
+}
+
+/* 타이머 fd의 만료를 소비한다. 시각이 변경되었으면 일정을 다시 정렬 */
+static void drain_timer(void) {
+    uint64_t expirations;
+    ssize_t n = read(timer_fd, &expirations, sizeof(expirations));
+    if (n < 0 && errno == ECANCELED) {
+        syslog(LOG_NOTICE, "System clock changed, realigning schedule");
+        realign_all();
+    } else if (n < 0 && errno != EINTR && errno != EAGAIN) {
+        syslog(LOG_ERR, "timerfd read failed: %s", strerror(errno));
+        sleep(1);
+    }
+}
+
+/* 마감 시각이 된 작업을 순서대로 실행하며 계속 대기한다.
+   대기 중에는 등록된 이벤트 fd도 함께 poll()한다. */
+void scheduler_run(void) {
+    while (heap_size > 0) {
+        time_t now = time(NULL);
+
+        while (heap_size > 0 && tasks[heap[0]].deadline <= now) {
+            int idx = heap_pop();
+            tasks[idx].fn(tasks[idx].arg);
+            now = time(NULL);
+            reschedule(&tasks[idx], now);
+            heap_push(idx);
+        }
+
+        int timeout = -1;
+        if (timer_fd < 0 || arm_timer(tasks[heap[0]].deadline) != 0) {
+            /* 타이머를 쓸 수 없으면 poll() 타임아웃으로 대신한다 */
+            timeout = (int)(tasks[heap[0]].deadline - now) * 1000;
+        }
+
+        struct pollfd pfds[MAX_FDS + 1];
+        int nfds = 0;
+        if (timeout < 0) {
+            pfds[nfds].fd = timer_fd;
+            pfds[nfds].events = POLLIN;
+            nfds++;
+        }
+        for (int i = 0; i < watch_count; i++) {
+            pfds[nfds].fd = watch_fds[i].fd;
+            pfds[nfds].events = watch_fds[i].events;
+            nfds++;
+        }
+
+        int ready = poll(pfds, nfds, timeout);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                syslog(LOG_ERR, "poll failed: %s", strerror(errno));
+                sleep(1);
+            }
+            continue;
+        }
+        if (ready == 0)
+            continue;
+
+        int first_watch = 0;
+        if (timeout < 0) {
+            first_watch = 1;
+            if (pfds[0].revents & POLLIN)
+                drain_timer();
+        }
+        /* 콜백이 fd 목록을 바꿀 수 있으므로 fd로 다시 찾아 호출한다 */
+        for (int i = first_watch; i < nfds; i++) {
+            if (pfds[i].revents == 0)
+                continue;
+            for (int j = 0; j < watch_count; j++) {
+                if (watch_fds[j].fd == pfds[i].fd) {
+                    watch_fds[j].fn(pfds[i].fd, pfds[i].revents, watch_fds[j].arg);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/* 지금까지 건너뛴 주기의 누적 수 */
+unsigned long scheduler_overruns(void) {
+    return overrun_count;
+}
@@ -0,0 +1,14 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+typedef void (*sched_task_fn)(void *arg);
+typedef void (*sched_fd_fn)(int fd, short revents, void *arg);
+
+int scheduler_init(void);
+int scheduler_add_task(const char *name, int period_seconds, sched_task_fn fn, void *arg);
+int scheduler_add_fd(int fd, short events, sched_fd_fn fn, void *arg);
+void scheduler_remove_fd(int fd);
+void scheduler_run(void);
+unsigned long scheduler_overruns(void);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,157 @@
+#include "snapshot.h"
+#include "metrics.h"
+#include "config.h"
+#include "scheduler.h"
+#include "redfish.h"
+#include <string.h>
+#include <time.h>
+
+static void collect_cpu(void *arg) {
+    snapshot_t *snap = arg;
+    snap->cpu_usage = get_cpu_usage();
+    snap->cpu_ts = time(NULL);
+}
+
+static void collect_memory(void *arg) {
+    snapshot_t *snap = arg;
+    snap->mem_usage = get_memory_usage();
+    snap->mem_ts = time(NULL);
+}
+
+static void collect_disk(void *arg) {
+    snapshot_t *snap = arg;
+    snap->disk_usage = get_disk_usage();
+    get_mount_info(&snap->mounts);
+    snap->disk_ts = time(NULL);
+}
+
+static void collect_diskio(void *arg) {
+    snapshot_t *snap = arg;
+    get_diskio_info(&snap->diskio);
+    snap->diskio_ts = time(NULL);
+}
+
+static void collect_psi(void *arg) {
+    snapshot_t *snap = arg;
+    get_psi_info(&snap->psi);
+    snap->psi_ts = time(NULL);
+}
+
+static void collect_temperature(void *arg) {
+    snapshot_t *snap = arg;
+    snap->cpu_temp = get_cpu_temperature();
+    snap->temp_ts = time(NULL);
+}
+
+static void collect_sensors(void *arg) {
+    snapshot_t *snap = arg;
+    get_sensor_info(&snap->sensors);
+    redfish_append_sensors(&snap->sensors);
+    snap->sensors_ts = time(NULL);
+}
+
+/* 늘어난 카운터는 보고 주기가 가져갈 때까지 장치, 종류별로 더해 둔다.
+   HWERR_INTERVAL이 INTERVAL_SECONDS보다 짧아도 중간 수집의 증가분을 잃지 않는다 */
+static void collect_hwerrors(void *arg) {
+    snapshot_t *snap = arg;
+    HwErrInfo info;
+    get_hwerr_info(&info);
+    snap->hwerr.counters = info.counters;
+    for (int i = 0; i < info.count; i++) {
+        const HwErrEvent *n = &info.events[i];
+        HwErrEvent *e = NULL;
+        for (int j = 0; j < snap->hwerr.count; j++) {
+            if (snap->hwerr.events[j].kind == n->kind && strcmp(snap->hwerr.events[j].device, n->device) == 0) {
+                e = &snap->hwerr.events[j];
+                break;
+            }
+        }
+        if (e) {
+            e->delta += n->delta;
+            e->total = n->total;
+        } else if (snap->hwerr.count < MAX_HWERR_EVENTS) {
+            snap->hwerr.events[snap->hwerr.count++] = *n;
+        }
+    }
+    snap->hwerr_ts = time(NULL);
+}
+
+static void collect_network(void *arg) {
+    snapshot_t *snap = arg;
+    get_net_info(&snap->net);
+    snap->net_ts = time(NULL);
+}
+
+static void collect_raid(void *arg) {
+    snapshot_t *snap = arg;
+    raid_worker_get(&snap->raid);
+    snap->raid_ts = time(NULL);
+}
+
+static void read_hw_status(snapshot_t *snap, HwStatus *hw) {
+    if (strcmp(global_config.hw_source, "redfish") == 0)
+        redfish_get_hw(hw);
+    else
+        hw_helper_get(hw);
+    snap->hw_updated = hw->updated;
+    snap->hw_age = hw->age;
+    snap->hw_stale = hw->stale;
+}
+
+/* 벤더 라이브러리는 보조 프로세스에서만 부르고 여기서는 공유 메모리(또는 Redfish 캐시)만 읽는다 */
+static void collect_fan(void *arg) {
+    snapshot_t *snap = arg;
+    HwStatus hw;
+    read_hw_status(snap, &hw);
+    snap->fan = hw.fan;
+    snap->fan_ts = time(NULL);
+}
+
+static void collect_power(void *arg) {
+    snapshot_t *snap = arg;
+    HwStatus hw;
+    read_hw_status(snap, &hw);
+    snap->power = hw.power;
+    snap->power_ts = time(NULL);
+}
+
+static void collect_trapq(void *arg) {
+    snapshot_t *snap = arg;
+    trapq_get_stats(&snap->trapq);
+}
+
+/* 수집기 목록과 conf 파일의 수집 주기 */
+typedef struct {
+    const char *name;
+    const int *period;
+    sched_task_fn collect;
+} collector_t;
+
+static const collector_t collectors[] = {
+    { "cpu",         &global_config.cpu_interval,   collect_cpu },
+    { "memory",      &global_config.mem_interval,   collect_memory },
+    { "disk",        &global_config.disk_interval,  collect_disk },
+    { "diskio",      &global_config.diskio_interval, collect_diskio },
+    { "psi",         &global_config.psi_interval,   collect_psi },
+    { "temperature", &global_config.temp_interval,  collect_temperature },
+    { "sensors",     &global_config.temp_interval,  collect_sensors },
+    { "hwerrors",    &global_config.hwerr_interval, collect_hwerrors },
+    { "network",     &global_config.net_interval,   collect_network },
+    /* RAID 점검 자체는 워커가 RAID_INTERVAL마다 하고, 여기서는 캐시만 읽는다 */
+    { "raid",        &global_config.interval_seconds, collect_raid },
+    { "fan",         &global_config.fan_interval,   collect_fan },
+    { "power",       &global_config.power_interval, collect_power },
+    { "trapq",       &global_config.interval_seconds, collect_trapq },
+};
+
+/* 각 수집기를 자기 주기로 스케줄러에 등록한다.
+   주기가 0이면 INTERVAL_SECONDS를 따른다. */
+void snapshot_init(snapshot_t *snap) {
+    memset(snap, 0, sizeof(*snap));
+    for (size_t i = 0; i < sizeof(collectors) / sizeof(collectors[0]); i++) {
+        int period = *collectors[i].period;
+        if (period <= 0)
+            period = global_config.interval_seconds;
+        scheduler_add_task(collectors[i].name, period, collectors[i].collect, snap);
+    }
+}
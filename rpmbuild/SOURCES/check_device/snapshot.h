@@ -0,0 +1,56 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <time.h>
+#include "metrics.h"
+#include "netstats.h"
+#include "mounts.h"
+#include "psi.h"
+#include "hwmon.h"
+#include "hwerrors.h"
+#include "raidworker.h"
+#include "hwhelper.h"
+#include "trapq.h"
+
+/* 수집기별 최신 지표 묶음.
+   각 수집기가 자기 주기마다 해당 값과 수집 시각(*_ts)을 갱신하고,
+   알람 판정과 CSV 기록은 보고 주기마다 같은 스냅샷을 읽는다. */
+typedef struct {
+    time_t timestamp;      /* 보고 시각 */
+
+    float cpu_usage;       /* % */
+    time_t cpu_ts;
+    float mem_usage;       /* % */
+    time_t mem_ts;
+    float disk_usage;      /* / 사용률 % */
+    MountInfo mounts;      /* DISK_MOUNTS 마운트별 블록/아이노드 사용률 */
+    time_t disk_ts;
+    DiskIoInfo diskio;     /* 블록 장치별 I/O 통계 */
+    time_t diskio_ts;
+    PsiInfo psi;           /* 자원별 PSI 평균 */
+    time_t psi_ts;
+    float cpu_temp;        /* °C */
+    time_t temp_ts;
+    SensorInfo sensors;    /* hwmon 센서 표 */
+    time_t sensors_ts;
+    HwErrInfo hwerr;       /* 직전 보고 이후 늘어난 하드웨어 오류 카운터 (보고 주기가 비운다) */
+    time_t hwerr_ts;
+    NetInfo net;           /* NET_INTERFACE 인터페이스별 통계와 합계 */
+    time_t net_ts;
+
+    RaidStatus raid;       /* 백그라운드 점검 결과 캐시에서 읽은 값 */
+    time_t raid_ts;
+    FanSpeeds fan;         /* 팬/전원은 보조 프로세스의 공유 메모리에서 읽은 값 */
+    time_t fan_ts;
+    PowerInfo power;
+    time_t power_ts;
+    int hw_updated;        /* 보조 프로세스 결과가 있음 */
+    int hw_age;            /* 결과 나이 (초), 없으면 -1 */
+    int hw_stale;
+
+    TrapQueueStats trapq;  /* SNMP 트랩 큐 자체 지표 */
+} snapshot_t;
+
+void snapshot_init(snapshot_t *snap);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,192 @@
+#include "snmpber.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* 알람 OID는 모두 이 아래에 있으므로 접두어를 미리 인코딩해 둔다 (8072 = 0xbf 0x08) */
+#define ALARM_PREFIX_STR ".1.3.6.1.4.1.8072.2.3.0"
+static const unsigned char alarm_prefix_ber[] = { 0x2b, 0x06, 0x01, 0x04, 0x01, 0xbf, 0x08, 0x02, 0x03, 0x00 };
+
+const BerOid ber_oid_sysuptime = { 8, { 0x2b, 0x06, 0x01, 0x02, 0x01, 0x01, 0x03, 0x00 } };
+const BerOid ber_oid_snmptrapoid = { 10, { 0x2b, 0x06, 0x01, 0x06, 0x03, 0x01, 0x01, 0x04, 0x01, 0x00 } };
+
+/* 하위 식별자 하나를 base-128로 붙인다 */
+int ber_oid_append(BerOid *oid, unsigned long subid) {
+    unsigned char tmp[10];
+    int n = 0;
+    do {
+        tmp[n++] = subid & 0x7f;
+        subid >>= 7;
+    } while (subid);
+    if (oid->len + n > BER_OID_MAX)
+        return -1;
+    while (n > 0) {
+        n--;
+        oid->ber[oid->len++] = tmp[n] | (n ? 0x80 : 0);
+    }
+    return 0;
+}
+
+static int next_subid(const char **p, unsigned long *v) {
+    const char *s = *p;
+    char *end;
+    if (*s == '.')
+        s++;
+    if (*s < '0' || *s > '9')
+        return -1;
+    *v = strtoul(s, &end, 10);
+    *p = end;
+    return 0;
+}
+
+/* ".1.3.6.1..." 숫자 표기만 받는다 (MIB 이름은 풀지 않음) */
+int ber_oid_encode(const char *str, BerOid *out) {
+    size_t plen = sizeof(ALARM_PREFIX_STR) - 1;
+    const char *p = str;
+    unsigned long v;
+
+    out->len = 0;
+    if (strncmp(str, ALARM_PREFIX_STR, plen) == 0 && (str[plen] == '.' || str[plen] == '\0')) {
+        memcpy(out->ber, alarm_prefix_ber, sizeof(alarm_prefix_ber));
+        out->len = sizeof(alarm_prefix_ber);
+        p = str + plen;
+    } else {
+        unsigned long first, second;
+        if (next_subid(&p, &first) != 0 || next_subid(&p, &second) != 0)
+            return -1;
+        if (first > 2 || (first < 2 && second >= 40))
+            return -1;
+        ber_oid_append(out, first * 40 + second);
+    }
+    while (*p) {
+        if (*p != '.' || next_subid(&p, &v) != 0 || ber_oid_append(out, v) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* 버퍼 끝에서 앞으로 쓴다. 내용을 먼저 쓰고 나면 길이를 알기 때문에 헤더를 바로 앞에 붙일 수 있다 */
+typedef struct {
+    unsigned char *buf;
+    size_t pos;
+    int err;
+} ber_writer_t;
+
+static void put_raw(ber_writer_t *w, const void *data, size_t n) {
+    if (w->err || n > w->pos) {
+        w->err = 1;
+        return;
+    }
+    w->pos -= n;
+    memcpy(w->buf + w->pos, data, n);
+}
+
+static void put_header(ber_writer_t *w, unsigned char tag, size_t len) {
+    unsigned char h[4];
+    int n = 0;
+    h[n++] = tag;
+    if (len < 0x80) {
+        h[n++] = len;
+    } else if (len <= 0xff) {
+        h[n++] = 0x81;
+        h[n++] = len;
+    } else if (len <= 0xffff) {
+        h[n++] = 0x82;
+        h[n++] = len >> 8;
+        h[n++] = len & 0xff;
+    } else {
+        w->err = 1;
+        return;
+    }
+    put_raw(w, h, n);
+}
+
+/* 음이 아닌 정수 (INTEGER, Gauge32, TimeTicks). 최상위 비트가 서면 0을 앞에 붙인다 */
+static void put_unsigned(ber_writer_t *w, unsigned char tag, unsigned long v) {
+    unsigned char tmp[sizeof(v) + 1];
+    size_t n = 0;
+    do {
+        tmp[sizeof(tmp) - 1 - n++] = v & 0xff;
+        v >>= 8;
+    } while (v);
+    if (tmp[sizeof(tmp) - n] & 0x80)
+        tmp[sizeof(tmp) - 1 - n++] = 0;
+    put_raw(w, tmp + sizeof(tmp) - n, n);
+    put_header(w, tag, n);
+}
+
+static void put_bytes(ber_writer_t *w, unsigned char tag, const void *data, size_t len) {
+    put_raw(w, data, len);
+    put_header(w, tag, len);
+}
+
+/* SNMPv2c Trap2/Inform 메시지를 만든다. 패킷은 buf 안의 *packet부터, 길이를 돌려준다 (실패 -1) */
+long snmp_encode_notification(unsigned char *buf, size_t size, int pdu_type, const char *community,
+                              long request_id, const BerVarbind *vbs, int count, unsigned char **packet) {
+    ber_writer_t w = { buf, size, 0 };
+
+    for (int i = count - 1; i >= 0; i--) {
+        const BerVarbind *vb = &vbs[i];
+        size_t vb_end = w.pos;
+        if (vb->type == BER_GAUGE32 || vb->type == BER_TIMETICKS || vb->type == BER_INTEGER)
+            put_unsigned(&w, vb->type, vb->num);
+        else
+            put_bytes(&w, vb->type, vb->value, vb->value_len);
+        put_bytes(&w, BER_OID, vb->name->ber, vb->name->len);
+        put_header(&w, BER_SEQUENCE, vb_end - w.pos);
+    }
+    put_header(&w, BER_SEQUENCE, size - w.pos);           /* varbind 목록 */
+    put_unsigned(&w, BER_INTEGER, 0);                      /* error-index */
+    put_unsigned(&w, BER_INTEGER, 0);                      /* error-status */
+    put_unsigned(&w, BER_INTEGER, (unsigned long)request_id);
+    put_header(&w, pdu_type, size - w.pos);
+    put_bytes(&w, BER_OCTET_STR, community, strlen(community));
+    put_unsigned(&w, BER_INTEGER, 1);                      /* version: 1 = v2c */
+    put_header(&w, BER_SEQUENCE, size - w.pos);
+    if (w.err)
+        return -1;
+    *packet = buf + w.pos;
+    return (long)(size - w.pos);
+}
+
+static int get_header(const unsigned char **p, const unsigned char *end, unsigned char *tag, size_t *len) {
+    if (end - *p < 2)
+        return -1;
+    *tag = *(*p)++;
+    size_t l = *(*p)++;
+    if (l & 0x80) {
+        int n = l & 0x7f;
+        if (n == 0 || n > 4 || end - *p < n)
+            return -1;
+        for (l = 0; n > 0; n--)
+            l = (l << 8) | *(*p)++;
+    }
+    if ((size_t)(end - *p) < l)
+        return -1;
+    *len = l;
+    return 0;
+}
+
+/* Inform 응답(Response PDU)에서 request-id를 꺼낸다. Response가 아니면 -1 */
+int snmp_decode_response(const unsigned char *buf, size_t len, long *request_id) {
+    const unsigned char *p = buf, *end = buf + len;
+    unsigned char tag;
+    size_t l;
+
+    if (get_header(&p, end, &tag, &l) != 0 || tag != BER_SEQUENCE)
+        return -1;
+    if (get_header(&p, end, &tag, &l) != 0 || tag != BER_INTEGER)
+        return -1;
+    p += l;
+    if (get_header(&p, end, &tag, &l) != 0 || tag != BER_OCTET_STR)
+        return -1;
+    p += l;
+    if (get_header(&p, end, &tag, &l) != 0 || tag != SNMP_PDU_RESPONSE)
+        return -1;
+    if (get_header(&p, end, &tag, &l) != 0 || tag != BER_INTEGER || l == 0 || l > 4)
+        return -1;
+    unsigned long v = (p[0] & 0x80) ? ~0UL : 0;
+    for (size_t i = 0; i < l; i++)
+        v = (v << 8) | p[i];
+    *request_id = (long)v;
+    return 0;
+}
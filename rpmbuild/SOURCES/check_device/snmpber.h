@@ -0,0 +1,45 @@
+#ifndef SNMPBER_H
+#define SNMPBER_H
+
+#include <stddef.h>
+
+/* SNMPv2c 알림(Trap2, Inform)용 최소 BER 인코더 */
+
+#define BER_INTEGER     0x02
+#define BER_OCTET_STR   0x04
+#define BER_OID         0x06
+#define BER_SEQUENCE    0x30
+#define BER_GAUGE32     0x42
+#define BER_TIMETICKS   0x43
+
+#define SNMP_PDU_RESPONSE 0xA2
+#define SNMP_PDU_INFORM   0xA6
+#define SNMP_PDU_TRAP2    0xA7
+
+#define BER_OID_MAX 64
+
+/* BER로 인코딩한 OID 값 (태그와 길이 제외) */
+typedef struct {
+    unsigned char len;
+    unsigned char ber[BER_OID_MAX];
+} BerOid;
+
+/* varbind 하나. type이 BER_GAUGE32, BER_TIMETICKS면 num, 그 밖에는 value/value_len */
+typedef struct {
+    const BerOid *name;
+    unsigned char type;
+    unsigned long num;
+    const void *value;
+    size_t value_len;
+} BerVarbind;
+
+extern const BerOid ber_oid_sysuptime;      /* .1.3.6.1.2.1.1.3.0 */
+extern const BerOid ber_oid_snmptrapoid;    /* .1.3.6.1.6.3.1.1.4.1.0 */
+
+int ber_oid_encode(const char *str, BerOid *out);
+int ber_oid_append(BerOid *oid, unsigned long subid);
+long snmp_encode_notification(unsigned char *buf, size_t size, int pdu_type, const char *community,
+                              long request_id, const BerVarbind *vbs, int count, unsigned char **packet);
+int snmp_decode_response(const unsigned char *buf, size_t len, long *request_id);
+
+#endif // SNMPBER_H
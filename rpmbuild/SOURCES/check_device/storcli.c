@@ -0,0 +1,260 @@
+#include "storcli.h"
+#include "json.h"
+#include "executor.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+
+/* storcli 출력 버퍼. RAID 점검은 워커 스레드에서만 호출된다 */
+static char storcli_output[1024 * 1024];
+
+/* storcli 약어 상태를 MegaCli와 같은 표기로 바꾼다 (알람/CSV 판정을 공유) */
+static const struct { const char *abbr; const char *name; } state_names[] = {
+    { "Optl",  "Optimal" },
+    { "OfLn",  "Offline" },
+    { "Pdgd",  "Partially Degraded" },
+    { "Dgrd",  "Degraded" },
+    { "Rec",   "Recovery" },
+    { "Cac",   "CacheCade" },
+    { "Onln",  "Online, Spun Up" },
+    { "Offln", "Offline" },
+    { "UGood", "Unconfigured(good)" },
+    { "UGUnsp","Unconfigured(good), Unsupported" },
+    { "UBad",  "Unconfigured(bad)" },
+    { "UBUnsp","Unconfigured(bad), Unsupported" },
+    { "GHS",   "Hotspare, Spun Up" },
+    { "DHS",   "Hotspare, Spun Up" },
+    { "Rbld",  "Rebuild" },
+    { "Cpybck","Copyback" },
+    { "Msng",  "Missing" },
+    { "F",     "Failed" },
+    { "JBOD",  "JBOD" },
+};
+
+static void copy_state(char *dst, size_t size, const char *abbr) {
+    for (size_t i = 0; i < sizeof(state_names) / sizeof(state_names[0]); i++) {
+        if (strcmp(abbr, state_names[i].abbr) == 0) {
+            snprintf(dst, size, "%s", state_names[i].name);
+            return;
+        }
+    }
+    snprintf(dst, size, "%s", abbr);
+}
+
+/* 파싱 상태: 지금 어느 표(VD LIST/PD LIST)의 어느 항목 안에 있는지 */
+typedef struct {
+    RaidInfo *info;
+    int adapter;
+    int list;              /* 0: 없음, 1: VD LIST, 2: PD LIST, 3: 드라이브 상세 State */
+    int list_depth;        /* 표 배열(또는 상세 객체)의 깊이 */
+    RaidVd *vd;
+    RaidPd *pd;
+    int pd_dg[RAID_MAX_PDS];   /* PD의 드라이브 그룹 (VD 매핑용) */
+    int vd_dg[RAID_MAX_VDS];
+    int truncated;
+} storcli_state_t;
+
+static RaidPd *find_pd(RaidInfo *info, int adapter, int enclosure, int slot) {
+    for (int i = 0; i < info->pd_count; i++) {
+        RaidPd *pd = &info->pds[i];
+        if (pd->adapter == adapter && pd->enclosure == enclosure && pd->slot == slot)
+            return pd;
+    }
+    return NULL;
+}
+
+static int on_json(const json_event_t *ev, void *arg) {
+    storcli_state_t *st = arg;
+    RaidInfo *info = st->info;
+
+    switch (ev->type) {
+    case JSON_ARRAY_BEGIN:
+        if (ev->key && strcmp(ev->key, "VD LIST") == 0) {
+            st->list = 1;
+            st->list_depth = ev->depth;
+        } else if (ev->key && strcmp(ev->key, "PD LIST") == 0) {
+            st->list = 2;
+            st->list_depth = ev->depth;
+        }
+        return 0;
+    case JSON_OBJECT_BEGIN:
+        if (ev->key == NULL && ev->depth == st->list_depth + 1) {
+            if (st->list == 1) {
+                st->vd = NULL;
+                if (info->vd_count >= RAID_MAX_VDS) {
+                    st->truncated = 1;
+                    return 0;
+                }
+                st->vd_dg[info->vd_count] = -1;
+                st->vd = &info->vds[info->vd_count++];
+                memset(st->vd, 0, sizeof(*st->vd));
+                st->vd->adapter = st->adapter;
+            } else if (st->list == 2) {
+                st->pd = NULL;
+                if (info->pd_count >= RAID_MAX_PDS) {
+                    st->truncated = 1;
+                    return 0;
+                }
+                st->pd_dg[info->pd_count] = -1;
+                st->pd = &info->pds[info->pd_count++];
+                memset(st->pd, 0, sizeof(*st->pd));
+                st->pd->adapter = st->adapter;
+                st->pd->enclosure = -1;
+                st->pd->slot = -1;
+                st->pd->vd = -1;
+            }
+        } else if (st->list == 0 && ev->key && strncmp(ev->key, "Drive /c", 8) == 0) {
+            /* /call/eall/sall show all: "Drive /c0/e252/s3 State" { 오류 카운터 } */
+            int c, e = -1, s;
+            const char *k = ev->key;
+            size_t len = strlen(k);
+            if (len > 6 && strcmp(k + len - 6, " State") == 0 &&
+                (sscanf(k, "Drive /c%d/e%d/s%d", &c, &e, &s) == 3 ||
+                 (e = -1, sscanf(k, "Drive /c%d/s%d", &c, &s) == 2))) {
+                st->pd = find_pd(info, c, e, s);
+                if (st->pd) {
+                    st->list = 3;
+                    st->list_depth = ev->depth;
+                }
+            }
+        }
+        return 0;
+    case JSON_ARRAY_END:
+    case JSON_OBJECT_END:
+        if (st->list != 0 && ev->depth == st->list_depth) {
+            st->list = 0;
+            st->vd = NULL;
+            st->pd = NULL;
+        }
+        return 0;
+    case JSON_STRING:
+    case JSON_NUMBER:
+        break;
+    default:
+        return 0;
+    }
+
+    if (ev->key == NULL)
+        return 0;
+
+    /* "Command Status": { "Controller": 0, ... } 로 어댑터 번호를 안다 */
+    if (st->list == 0) {
+        if (ev->depth >= 1 && strcmp(ev->key, "Controller") == 0 &&
+            ev->keys[ev->depth - 1] && strcmp(ev->keys[ev->depth - 1], "Command Status") == 0) {
+            st->adapter = atoi(ev->value);
+            info->adapter_count++;
+        }
+        return 0;
+    }
+
+    if (st->list == 1 && st->vd && ev->depth == st->list_depth + 2) {
+        if (strcmp(ev->key, "DG/VD") == 0) {
+            int dg, vd;
+            if (sscanf(ev->value, "%d/%d", &dg, &vd) == 2) {
+                st->vd->id = vd;
+                st->vd_dg[st->vd - info->vds] = dg;
+            }
+        } else if (strcmp(ev->key, "TYPE") == 0) {
+            /* "RAID1" -> "1" */
+            const char *lvl = strncmp(ev->value, "RAID", 4) == 0 ? ev->value + 4 : ev->value;
+            snprintf(st->vd->level, sizeof(st->vd->level), "%s", lvl);
+        } else if (strcmp(ev->key, "State") == 0) {
+            copy_state(st->vd->state, sizeof(st->vd->state), ev->value);
+        }
+    } else if (st->list == 2 && st->pd && ev->depth == st->list_depth + 2) {
+        if (strcmp(ev->key, "EID:Slt") == 0) {
+            /* "252:3", 인클로저가 없으면 " :3" */
+            const char *colon = strchr(ev->value, ':');
+            if (colon) {
+                if (colon > ev->value && ev->value[0] != ' ')
+                    st->pd->enclosure = atoi(ev->value);
+                st->pd->slot = atoi(colon + 1);
+            }
+        } else if (strcmp(ev->key, "State") == 0) {
+            copy_state(st->pd->state, sizeof(st->pd->state), ev->value);
+        } else if (strcmp(ev->key, "DG") == 0) {
+            if (ev->type == JSON_NUMBER)
+                st->pd_dg[st->pd - info->pds] = atoi(ev->value);
+        }
+    } else if (st->list == 3 && st->pd && ev->depth == st->list_depth + 1) {
+        if (strcmp(ev->key, "Media Error Count") == 0)
+            st->pd->media_errors = (unsigned int)strtoul(ev->value, NULL, 10);
+        else if (strcmp(ev->key, "Other Error Count") == 0)
+            st->pd->other_errors = (unsigned int)strtoul(ev->value, NULL, 10);
+        else if (strcmp(ev->key, "Predictive Failure Count") == 0)
+            st->pd->predictive_failures = (unsigned int)strtoul(ev->value, NULL, 10);
+    }
+    return 0;
+}
+
+/* storcli JSON 출력을 RaidInfo에 더한다. 같은 info에 /call show all 과
+   /call/eall/sall show all 출력을 차례로 넘길 수 있다. 문법 오류면 -1 */
+int storcli_parse(char *output, RaidInfo *info) {
+    static storcli_state_t st;
+    int first_vd = info->vd_count;
+    int first_pd = info->pd_count;
+
+    memset(&st, 0, sizeof(st));
+    st.info = info;
+    for (int i = 0; i < RAID_MAX_PDS; i++)
+        st.pd_dg[i] = -1;
+    int rc = json_parse(output, on_json, &st);
+
+    /* PD의 드라이브 그룹으로 소속 VD를 찾는다 */
+    for (int i = first_pd; i < info->pd_count; i++) {
+        for (int j = first_vd; j < info->vd_count; j++) {
+            if (st.pd_dg[i] >= 0 && st.pd_dg[i] == st.vd_dg[j] &&
+                info->pds[i].adapter == info->vds[j].adapter) {
+                info->pds[i].vd = info->vds[j].id;
+                break;
+            }
+        }
+    }
+    if (st.truncated)
+        syslog(LOG_WARNING, "storcli output has more than %d VDs or %d PDs, ignoring the rest",
+               RAID_MAX_VDS, RAID_MAX_PDS);
+    return rc == 0 ? 0 : -1;
+}
+
+static int run_storcli(char *const argv[], RaidInfo *info) {
+    exec_result_t res;
+    if (exec_run(argv, global_config.raid_probe_timeout * 1000,
+                 storcli_output, sizeof(storcli_output), &res) != 0)
+        return -1;
+    if (res.timed_out) {
+        info->timed_out = 1;
+        return -1;
+    }
+    if (res.truncated) {
+        syslog(LOG_ERR, "%s output exceeds %zu bytes", argv[0], sizeof(storcli_output));
+        return -1;
+    }
+    if (res.exit_status != 0)
+        syslog(LOG_WARNING, "%s %s exited with status %d after %.1fs",
+               argv[0], argv[1], res.exit_status, res.runtime);
+    return 0;
+}
+
+/* 컨트롤러/VD/PD 목록을 받고, 드라이브별 오류 카운터를 상세 출력에서 채운다.
+   VD를 하나도 얻지 못하면 -1 */
+int storcli_get_info(RaidInfo *info) {
+    char *const show_argv[] = { STORCLI_PATH, "/call", "show", "all", "J", NULL };
+    if (run_storcli(show_argv, info) != 0)
+        return -1;
+    if (storcli_parse(storcli_output, info) != 0) {
+        syslog(LOG_ERR, "Failed to parse %s /call show all J output", STORCLI_PATH);
+        return -1;
+    }
+    if (info->vd_count == 0)
+        return -1;
+
+    /* 오류 카운터는 /call show all 에 없으므로 드라이브 상세를 한 번 더 받는다 */
+    char *const pd_argv[] = { STORCLI_PATH, "/call/eall/sall", "show", "all", "J", NULL };
+    int adapters = info->adapter_count;
+    if (run_storcli(pd_argv, info) == 0 && storcli_parse(storcli_output, info) != 0)
+        syslog(LOG_ERR, "Failed to parse %s /call/eall/sall show all J output", STORCLI_PATH);
+    info->adapter_count = adapters;
+    return 0;
+}
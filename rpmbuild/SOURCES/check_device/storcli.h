@@ -0,0 +1,11 @@
+#ifndef STORCLI_H
+#define STORCLI_H
+
+#include "metrics.h"
+
+#define STORCLI_PATH "/opt/MegaRAID/storcli/storcli64"
+
+int storcli_parse(char *output, RaidInfo *info);
+int storcli_get_info(RaidInfo *info);
+
+#endif // STORCLI_H
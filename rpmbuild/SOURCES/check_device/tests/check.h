@@ -0,0 +1,73 @@
+#ifndef TESTS_CHECK_H
+#define TESTS_CHECK_H
+
+/* make check용 최소 검사 도구. 실패해도 계속 진행하고 main()이 check_done()을 돌려준다 */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FIXTURE_DIR "tests/fixtures/"
+
+static int check_failures;
+static int check_count;
+
+#define CHECK(cond) do { \
+    check_count++; \
+    if (!(cond)) { \
+        check_failures++; \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define CHECK_INT(actual, expected) do { \
+    long long a_ = (long long)(actual), e_ = (long long)(expected); \
+    check_count++; \
+    if (a_ != e_) { \
+        check_failures++; \
+        fprintf(stderr, "%s:%d: %s = %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+    } \
+} while (0)
+
+#define CHECK_STR(actual, expected) do { \
+    const char *a_ = (actual), *e_ = (expected); \
+    check_count++; \
+    if (strcmp(a_, e_) != 0) { \
+        check_failures++; \
+        fprintf(stderr, "%s:%d: %s = \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #actual, a_, e_); \
+    } \
+} while (0)
+
+/* tests/fixtures/<name>을 읽는다. 파서가 버퍼를 그 자리에서 자르므로 매번 새로 읽는다 */
+static inline char *read_fixture(const char *name, size_t *len) {
+    char path[256];
+    snprintf(path, sizeof(path), FIXTURE_DIR "%s", name);
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        perror(path);
+        exit(2);
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    rewind(fp);
+    char *buf = malloc(size + 1);
+    if (!buf || fread(buf, 1, size, fp) != (size_t)size) {
+        fprintf(stderr, "%s: read failed\n", path);
+        exit(2);
+    }
+    buf[size] = '\0';
+    fclose(fp);
+    if (len)
+        *len = size;
+    return buf;
+}
+
+static inline int check_done(const char *name) {
+    if (check_failures)
+        fprintf(stderr, "%s: %d of %d checks failed\n", name, check_failures, check_count);
+    else
+        printf("%s: %d checks passed\n", name, check_count);
+    return check_failures ? 1 : 0;
+}
+
+#endif // TESTS_CHECK_H
@@ -0,0 +1,86 @@
+/* MegaCli 출력 파서 검사: -PDList로 만든 드라이브 표와 -LdPdInfo의 VD/소속 반영 */
+
+#include "check.h"
+#include "megacli.h"
+
+static const RaidPd *find_pd(const RaidInfo *info, int adapter, int enclosure, int slot) {
+    for (int i = 0; i < info->pd_count; i++) {
+        const RaidPd *pd = &info->pds[i];
+        if (pd->adapter == adapter && pd->enclosure == enclosure && pd->slot == slot)
+            return pd;
+    }
+    return NULL;
+}
+
+/* -PDList + -LdPdInfo: VD에 속하지 않은 드라이브도 모두 표에 있어야 한다 */
+static void test_pdlist_and_members(void) {
+    RaidInfo info;
+    memset(&info, 0, sizeof(info));
+
+    CHECK_INT(megacli_parse_pdlist(read_fixture("megacli_pdlist.txt", NULL), &info), 7);
+    CHECK_INT(megacli_parse(read_fixture("megacli_ldpdinfo.txt", NULL), &info), 1);
+    CHECK_INT(info.adapter_count, 2);
+    CHECK_INT(info.pd_count, 7);
+
+    /* Span Depth 2인 RAID 1은 RAID 10 */
+    CHECK_INT(info.vds[0].adapter, 0);
+    CHECK_INT(info.vds[0].id, 0);
+    CHECK_STR(info.vds[0].level, "10");
+    CHECK_STR(info.vds[0].state, "Degraded");
+
+    const RaidPd *pd = find_pd(&info, 0, 32, 1);
+    CHECK(pd != NULL);
+    if (pd) {
+        CHECK_INT(pd->vd, 0);
+        CHECK_INT(pd->media_errors, 12);
+        CHECK_INT(pd->other_errors, 3);
+        CHECK_STR(pd->state, "Online, Spun Up");
+    }
+    pd = find_pd(&info, 0, 32, 2);
+    CHECK(pd != NULL && pd->vd == 0 && pd->predictive_failures == 2);
+
+    /* VD에서 빠진 드라이브들 */
+    pd = find_pd(&info, 0, 32, 3);
+    CHECK(pd != NULL && pd->vd == -1);
+    if (pd) {
+        CHECK_STR(pd->state, "Failed");
+        CHECK_INT(pd->media_errors, 41);
+    }
+    pd = find_pd(&info, 0, 32, 4);
+    CHECK(pd != NULL && pd->vd == -1);
+    if (pd)
+        CHECK_STR(pd->state, "Unconfigured(bad)");
+    pd = find_pd(&info, 0, 32, 5);
+    CHECK(pd != NULL && pd->vd == -1);
+    if (pd)
+        CHECK_STR(pd->state, "Hotspare, Spun down");
+
+    /* 직결 JBOD 드라이브: Enclosure Device ID가 N/A */
+    pd = find_pd(&info, 1, -1, 0);
+    CHECK(pd != NULL);
+    if (pd)
+        CHECK_STR(pd->state, "JBOD");
+}
+
+/* -PDList가 실패하면 -LdPdInfo의 멤버 드라이브만이라도 표에 넣는다 */
+static void test_ldpdinfo_only(void) {
+    RaidInfo info;
+    memset(&info, 0, sizeof(info));
+
+    CHECK_INT(megacli_parse(read_fixture("megacli_ldpdinfo.txt", NULL), &info), 1);
+    CHECK_INT(info.pd_count, 3);
+    for (int i = 0; i < info.pd_count; i++) {
+        CHECK_INT(info.pds[i].adapter, 0);
+        CHECK_INT(info.pds[i].vd, 0);
+        CHECK_INT(info.pds[i].enclosure, 32);
+        CHECK_INT(info.pds[i].slot, i);
+    }
+    CHECK_INT(info.pds[1].media_errors, 12);
+    CHECK_INT(info.pds[2].predictive_failures, 2);
+}
+
+int main(void) {
+    test_pdlist_and_members();
+    test_ldpdinfo_only();
+    return check_done("test_megacli");
+}
@@ -0,0 +1,129 @@
+/* procfile_read 검사: 한 페이지보다 큰 seq_file을 끝까지 읽는지, 다시 읽을 때 처음부터 읽는지 */
+
+#include "check.h"
+#include "procfile.h"
+#include <unistd.h>
+
+/* 비교용: read()를 0이 나올 때까지 부른다 */
+static char *read_all(const char *path, size_t *len) {
+    size_t cap = 4096, used = 0;
+    char *buf = malloc(cap);
+    FILE *fp = fopen(path, "r");
+    if (!fp || !buf) {
+        free(buf);
+        if (fp)
+            fclose(fp);
+        return NULL;
+    }
+    size_t n;
+    while ((n = fread(buf + used, 1, cap - used, fp)) > 0) {
+        used += n;
+        if (used == cap)
+            buf = realloc(buf, cap *= 2);
+    }
+    fclose(fp);
+    *len = used;
+    return buf;
+}
+
+/* 내용이 바뀌지 않고 보통 몇 페이지가 넘는 seq_file. 권한 없이 읽히는 첫 파일을 쓴다 */
+static const char *const seq_files[] = { "/proc/crypto", "/proc/kallsyms", "/proc/self/smaps" };
+
+static void test_large_seq_file(void) {
+    for (size_t i = 0; i < sizeof(seq_files) / sizeof(seq_files[0]); i++) {
+        size_t expected_len = 0, len = 0;
+        char *expected = read_all(seq_files[i], &expected_len);
+        if (!expected || expected_len <= 8192) {
+            free(expected);
+            continue;
+        }
+
+        procfile_t pf = PROCFILE_INIT("");
+        procfile_init(&pf, seq_files[i]);
+        char *buf = procfile_read(&pf, &len);
+        CHECK(buf != NULL);
+        if (!buf) {
+            free(expected);
+            return;
+        }
+        /* smaps는 읽는 사이에 숫자가 바뀔 수 있으므로 내용 비교는 건너뛴다 */
+        if (strcmp(seq_files[i], "/proc/self/smaps") != 0) {
+            CHECK_INT(len, expected_len);
+            CHECK(len == expected_len && memcmp(buf, expected, len) == 0);
+        }
+        CHECK(len > 8192);
+        CHECK_INT(strlen(buf), len);
+        CHECK(buf[len - 1] == '\n');
+
+        /* 두 번째 읽기도 offset 0부터 같은 길이 */
+        size_t again = 0;
+        CHECK(procfile_read(&pf, &again) != NULL);
+        if (strcmp(seq_files[i], "/proc/self/smaps") != 0)
+            CHECK_INT(again, expected_len);
+        procfile_close(&pf);
+        free(expected);
+        return;
+    }
+    fprintf(stderr, "test_procfile: no readable seq_file larger than two pages\n");
+    CHECK(0);
+}
+
+/* 보통 파일: 초기 버퍼보다 크면 키우고, 내용이 줄어도 다시 처음부터 읽는다 */
+static void test_regular_file(void) {
+    char path[] = "/tmp/test_procfile.XXXXXX";
+    int fd = mkstemp(path);
+    char line[64];
+    size_t len = 0, written = 0;
+    CHECK(fd >= 0);
+    if (fd < 0)
+        return;
+    for (int i = 0; i < 1000; i++) {
+        int n = snprintf(line, sizeof(line), "line %d\n", i);
+        if (write(fd, line, n) == n)
+            written += n;
+    }
+
+    procfile_t pf = PROCFILE_INIT("");
+    procfile_init(&pf, path);
+    char *buf = procfile_read(&pf, &len);
+    CHECK(buf != NULL);
+    CHECK_INT(len, written);
+    CHECK(buf && strncmp(buf, "line 0\n", 7) == 0);
+    CHECK(buf && strcmp(buf + len - 9, "line 999\n") == 0);
+
+    CHECK(ftruncate(fd, 0) == 0);
+    CHECK(pwrite(fd, "short\n", 6, 0) == 6);
+    buf = procfile_read(&pf, &len);
+    CHECK(buf != NULL);
+    CHECK_INT(len, 6);
+    CHECK_STR(buf ? buf : "", "short\n");
+
+    procfile_close(&pf);
+    close(fd);
+    unlink(path);
+}
+
+/* sysfs 속성: 한 번 읽어 끝난다 */
+static void test_sysfs_attribute(void) {
+    const char *path = "/sys/devices/system/cpu/online";
+    size_t expected_len = 0, len = 0;
+    char *expected = read_all(path, &expected_len);
+    if (!expected)
+        return;
+
+    procfile_t pf = PROCFILE_INIT("");
+    procfile_init(&pf, path);
+    char *buf = procfile_read(&pf, &len);
+    CHECK(buf != NULL);
+    CHECK_INT(len, expected_len);
+    CHECK(buf && len == expected_len && memcmp(buf, expected, len) == 0);
+    procfile_close(&pf);
+    free(expected);
+}
+
+int main(void) {
+    test_large_seq_file();
+    test_regular_file();
+    test_sysfs_attribute();
+    return check_done("test_procfile");
+}
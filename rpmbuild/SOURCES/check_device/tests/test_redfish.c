@@ -0,0 +1,339 @@
+/* Redfish 클라이언트 검사. 테스트 안에 띄운 HTTP 서버가 tests/fixtures/redfish/ 아래의
+   목업(DMTF mockup 배치: <경로>/index.json)을 ETag와 함께 돌려준다 */
+
+#include "check.h"
+#include "redfish.h"
+#include "config.h"
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define MOCK_MAX_CONNS 8
+#define MOCK_AUTH "Authorization: Basic cm9vdDpjYWx2aW4="    /* root:calvin */
+
+/* 통계는 경로 종류별: 0 Chassis (팬/전원 스레드), 1 Systems (RAID) */
+enum { KIND_CHASSIS, KIND_SYSTEMS, KINDS };
+
+typedef struct {
+    int fd;
+    int kind;
+    size_t len;
+    char buf[4096];
+} mock_conn_t;
+
+static struct {
+    int listen_fd;
+    int port;
+    int fail;                          /* 1이면 모든 요청에 503 */
+    int connections[KINDS];
+    int requests[KINDS];
+    int not_modified[KINDS];
+    int unauthorized;
+    mock_conn_t conns[MOCK_MAX_CONNS];
+} mock;
+
+static int stat_get(int *v) {
+    return __atomic_load_n(v, __ATOMIC_RELAXED);
+}
+
+static void stat_add(int *v) {
+    __atomic_add_fetch(v, 1, __ATOMIC_RELAXED);
+}
+
+static void send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0)
+            return;
+        data += n;
+        len -= n;
+    }
+}
+
+/* 목업 파일을 읽는다. 없으면 NULL */
+static char *load_mockup(const char *path, size_t *len) {
+    char file[600];
+    snprintf(file, sizeof(file), FIXTURE_DIR "redfish%s/index.json", path + strlen("/redfish"));
+    FILE *fp = fopen(file, "rb");
+    if (!fp)
+        return NULL;
+    char *body = malloc(65536);
+    *len = fread(body, 1, 65535, fp);
+    fclose(fp);
+    return body;
+}
+
+/* 본문의 FNV-1a 해시를 ETag로 쓴다 */
+static void make_etag(const char *body, size_t len, char *out, size_t size) {
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ (unsigned char)body[i]) * 16777619u;
+    snprintf(out, size, "\"%08x\"", h);
+}
+
+static const char *find_header(const char *req, const char *name) {
+    size_t n = strlen(name);
+    for (const char *p = strstr(req, "\r\n"); p && p[2] != '\r'; p = strstr(p + 2, "\r\n")) {
+        if (strncasecmp(p + 2, name, n) == 0)
+            return p + 2 + n;
+    }
+    return NULL;
+}
+
+static void handle_request(mock_conn_t *c, char *req) {
+    char path[512], reply[512], etag[32];
+    size_t len = 0;
+
+    if (sscanf(req, "GET %511s HTTP/1.1", path) != 1 || strncmp(path, "/redfish/v1", 11) != 0) {
+        snprintf(reply, sizeof(reply), "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n");
+        send_all(c->fd, reply, strlen(reply));
+        return;
+    }
+    int kind = strncmp(path, "/redfish/v1/Chassis", 19) == 0 ? KIND_CHASSIS : KIND_SYSTEMS;
+    if (c->kind < 0) {
+        c->kind = kind;
+        stat_add(&mock.connections[kind]);
+    }
+    stat_add(&mock.requests[kind]);
+
+    char *auth = strstr(req, MOCK_AUTH);
+    if (!auth || (auth[strlen(MOCK_AUTH)] != '\r')) {
+        stat_add(&mock.unauthorized);
+        snprintf(reply, sizeof(reply), "HTTP/1.1 401 Unauthorized\r\nContent-Length: 0\r\n\r\n");
+        send_all(c->fd, reply, strlen(reply));
+        return;
+    }
+    char *body = stat_get(&mock.fail) ? NULL : load_mockup(path, &len);
+    if (!body) {
+        snprintf(reply, sizeof(reply), "HTTP/1.1 %s\r\nContent-Length: 0\r\n\r\n",
+                 stat_get(&mock.fail) ? "503 Service Unavailable" : "404 Not Found");
+        send_all(c->fd, reply, strlen(reply));
+        return;
+    }
+    make_etag(body, len, etag, sizeof(etag));
+    const char *inm = find_header(req, "If-None-Match:");
+    while (inm && *inm == ' ')
+        inm++;
+    if (inm && strncmp(inm, etag, strlen(etag)) == 0) {
+        stat_add(&mock.not_modified[kind]);
+        snprintf(reply, sizeof(reply), "HTTP/1.1 304 Not Modified\r\nETag: %s\r\n\r\n", etag);
+        send_all(c->fd, reply, strlen(reply));
+    } else {
+        snprintf(reply, sizeof(reply),
+                 "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nETag: %s\r\n"
+                 "Content-Length: %zu\r\n\r\n", etag, len);
+        send_all(c->fd, reply, strlen(reply));
+        send_all(c->fd, body, len);
+    }
+    free(body);
+}
+
+/* 연결 여러 개를 poll로 돌본다 (팬/전원 스레드와 RAID 쪽이 동시에 붙는다) */
+static void *mock_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        struct pollfd pfd[MOCK_MAX_CONNS + 1];
+        pfd[0].fd = mock.listen_fd;
+        pfd[0].events = POLLIN;
+        for (int i = 0; i < MOCK_MAX_CONNS; i++) {
+            pfd[i + 1].fd = mock.conns[i].fd;
+            pfd[i + 1].events = POLLIN;
+        }
+        if (poll(pfd, MOCK_MAX_CONNS + 1, -1) < 0 && errno != EINTR)
+            return NULL;
+
+        if (pfd[0].revents & POLLIN) {
+            int fd = accept(mock.listen_fd, NULL, NULL);
+            for (int i = 0; fd >= 0 && i < MOCK_MAX_CONNS; i++) {
+                if (mock.conns[i].fd < 0) {
+                    mock.conns[i].fd = fd;
+                    mock.conns[i].kind = -1;
+                    mock.conns[i].len = 0;
+                    fd = -1;
+                }
+            }
+            if (fd >= 0)
+                close(fd);
+        }
+        for (int i = 0; i < MOCK_MAX_CONNS; i++) {
+            mock_conn_t *c = &mock.conns[i];
+            if (c->fd < 0 || !(pfd[i + 1].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+            ssize_t n = read(c->fd, c->buf + c->len, sizeof(c->buf) - 1 - c->len);
+            if (n <= 0) {
+                close(c->fd);
+                c->fd = -1;
+                continue;
+            }
+            c->len += n;
+            c->buf[c->len] = '\0';
+            char *end;
+            while ((end = strstr(c->buf, "\r\n\r\n")) != NULL) {
+                end[2] = '\0';
+                handle_request(c, c->buf);
+                size_t used = end + 4 - c->buf;
+                memmove(c->buf, end + 4, c->len - used + 1);
+                c->len -= used;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void mock_start(void) {
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t addr_len = sizeof(addr);
+    pthread_t tid;
+
+    for (int i = 0; i < MOCK_MAX_CONNS; i++)
+        mock.conns[i].fd = -1;
+    mock.listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (mock.listen_fd < 0 || bind(mock.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(mock.listen_fd, 8) != 0 ||
+        getsockname(mock.listen_fd, (struct sockaddr *)&addr, &addr_len) != 0) {
+        perror("mock server");
+        exit(2);
+    }
+    mock.port = ntohs(addr.sin_port);
+    pthread_create(&tid, NULL, mock_main, NULL);
+    pthread_detach(tid);
+}
+
+/* cond가 참이 될 때까지 최대 seconds초 기다린다 */
+#define WAIT_FOR(cond, seconds) do { \
+    for (int w_ = 0; w_ < (seconds) * 20 && !(cond); w_++) { \
+        struct timespec ts_ = { 0, 50 * 1000000 }; \
+        nanosleep(&ts_, NULL); \
+    } \
+} while (0)
+
+static const Sensor *find_sensor(const SensorInfo *info, const char *label) {
+    for (int i = 0; i < info->count; i++) {
+        if (strcmp(info->sensors[i].label, label) == 0)
+            return &info->sensors[i];
+    }
+    return NULL;
+}
+
+/* Chassis Power/Thermal: 첫 결과, 센서 표, 두 번째 주기의 304 */
+static void test_hw(void) {
+    HwStatus status;
+    SensorInfo sensors;
+
+    WAIT_FOR((redfish_get_hw(&status), status.updated), 5);
+    CHECK_INT(status.updated, 1);
+    CHECK_INT(status.stale, 0);
+    CHECK_STR(status.power.power1, "OK");
+    CHECK_STR(status.power.power2, "Fail");
+    CHECK_INT(status.fan.cpuFan, 5400);
+    CHECK_INT(status.fan.auxFan, 480);
+    CHECK_INT(status.fan.fan1, 5160);
+    CHECK_INT(status.fan.fan2, 0);
+
+    /* 빠진 팬과 값이 없는 온도 센서는 버린다 */
+    memset(&sensors, 0, sizeof(sensors));
+    redfish_append_sensors(&sensors);
+    CHECK_INT(sensors.count, 5);
+    const Sensor *s = find_sensor(&sensors, "System Board Fan1A");
+    CHECK(s != NULL && s->type == SENSOR_FAN && s->alarm == 0 && s->min == 600);
+    if (s)
+        CHECK_STR(s->chip, REDFISH_SENSOR_CHIP);
+    s = find_sensor(&sensors, "System Board Fan2A");
+    CHECK(s != NULL && s->alarm == 1);
+    s = find_sensor(&sensors, "System Board Fan4A");
+    CHECK(s != NULL && s->value == 5160);
+    s = find_sensor(&sensors, "CPU1 Temp");
+    CHECK(s != NULL && s->type == SENSOR_TEMP && s->value == 45 && s->max == 85 && s->crit == 95 && s->alarm == 0);
+    s = find_sensor(&sensors, "System Board Inlet Temp");
+    CHECK(s != NULL && s->alarm == 1);
+    CHECK(find_sensor(&sensors, "System Board Fan3A") == NULL);
+    CHECK(find_sensor(&sensors, "CPU2 Temp") == NULL);
+
+    /* 다음 주기: Chassis, 섀시, Power, Thermal 모두 304이고 연결은 그대로 */
+    WAIT_FOR(stat_get(&mock.not_modified[KIND_CHASSIS]) >= 4, 5);
+    CHECK(stat_get(&mock.not_modified[KIND_CHASSIS]) >= 4);
+    CHECK_INT(stat_get(&mock.connections[KIND_CHASSIS]), 1);
+}
+
+static void check_raid(const RaidInfo *info) {
+    CHECK_INT(info->adapter_count, 1);
+    CHECK_INT(info->vd_count, 2);
+    CHECK_STR(info->vds[0].level, "1");
+    CHECK_STR(info->vds[0].state, "Optimal");
+    CHECK_INT(info->vds[1].id, 1);
+    CHECK_STR(info->vds[1].level, "5");
+    CHECK_STR(info->vds[1].state, "Degraded");
+
+    /* Absent 드라이브는 빠진다 */
+    CHECK_INT(info->pd_count, 4);
+    if (info->pd_count != 4)
+        return;
+    CHECK_STR(info->pds[0].device, "Disk.Bay.0");
+    CHECK_STR(info->pds[0].state, "Online");
+    CHECK_INT(info->pds[1].slot, 1);
+    CHECK_INT(info->pds[1].predictive_failures, 1);
+    CHECK_STR(info->pds[2].state, "Failed");
+    CHECK_STR(info->pds[3].state, "Hotspare");
+    CHECK_INT(info->pds[3].slot, 3);
+}
+
+/* Systems/Storage: 드라이브와 볼륨. 두 번째 호출은 304를 받아 캐시된 본문으로 같은 결과를 낸다 */
+static void test_raid(void) {
+    RaidInfo info;
+
+    memset(&info, 0, sizeof(info));
+    CHECK_INT(redfish_get_raid_info(&info), 0);
+    check_raid(&info);
+    int requests = stat_get(&mock.requests[KIND_SYSTEMS]);
+    CHECK_INT(requests, 12);
+    CHECK_INT(stat_get(&mock.not_modified[KIND_SYSTEMS]), 0);
+
+    memset(&info, 0, sizeof(info));
+    CHECK_INT(redfish_get_raid_info(&info), 0);
+    check_raid(&info);
+    CHECK_INT(stat_get(&mock.requests[KIND_SYSTEMS]), 2 * requests);
+    CHECK_INT(stat_get(&mock.not_modified[KIND_SYSTEMS]), requests);
+    CHECK_INT(stat_get(&mock.connections[KIND_SYSTEMS]), 1);
+}
+
+/* BMC가 응답하지 않으면 마지막 결과를 유지한 채 hw_stale_limit() 뒤에 stale */
+static void test_stale(void) {
+    HwStatus status;
+
+    __atomic_store_n(&mock.fail, 1, __ATOMIC_RELAXED);
+    WAIT_FOR((redfish_get_hw(&status), status.stale), hw_stale_limit() + 3);
+    CHECK_INT(status.stale, 1);
+    CHECK(status.age >= hw_stale_limit());
+    CHECK_STR(status.power.power1, "OK");
+    CHECK_INT(status.fan.cpuFan, 5400);
+
+    __atomic_store_n(&mock.fail, 0, __ATOMIC_RELAXED);
+    WAIT_FOR((redfish_get_hw(&status), !status.stale), 5);
+    CHECK_INT(status.stale, 0);
+    CHECK(status.age <= 1);
+}
+
+int main(void) {
+    mock_start();
+    snprintf(global_config.redfish_url, sizeof(global_config.redfish_url), "http://127.0.0.1:%d", mock.port);
+    snprintf(global_config.redfish_user, sizeof(global_config.redfish_user), "root");
+    snprintf(global_config.redfish_password, sizeof(global_config.redfish_password), "calvin");
+    snprintf(global_config.hw_source, sizeof(global_config.hw_source), "redfish");
+    global_config.redfish_timeout = 5;
+    global_config.redfish_interval = 1;
+    global_config.interval_seconds = 1;
+    global_config.hw_helper_timeout = 1;
+
+    CHECK_INT(redfish_init(), 0);
+    test_hw();
+    test_raid();
+    test_stale();
+    CHECK_INT(stat_get(&mock.unauthorized), 0);
+    return check_done("test_redfish");
+}
@@ -0,0 +1,400 @@
+/* 내장 BER 인코더 검사. 인코더와 따로 만든 DER 디코더로 Trap2/Inform 메시지를 풀어 보고,
+   make USE_NETSNMP=1 check 이면 같은 메시지를 net-snmp 라이브러리로도 풀어 결과를 맞춘다 */
+
+#include "check.h"
+#include "snmpber.h"
+
+#ifdef USE_NETSNMP
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#endif
+
+#define MAX_VBS 16
+
+/* 디코더 두 개가 같은 모양으로 채우는 메시지 */
+typedef struct {
+    char oid[160];
+    unsigned char type;
+    unsigned long num;           /* INTEGER, Gauge32, TimeTicks */
+    char str[512];               /* OCTET STRING 내용, OID 값은 점 표기 */
+    size_t str_len;
+} vb_t;
+
+typedef struct {
+    long version;
+    char community[64];
+    int pdu;
+    long reqid, errstat, errindex;
+    int count;
+    vb_t vbs[MAX_VBS];
+} msg_t;
+
+static void oid_str(const unsigned long *ids, size_t n, char *out, size_t size) {
+    size_t pos = 0;
+    out[0] = '\0';
+    for (size_t i = 0; i < n && pos < size; i++)
+        pos += snprintf(out + pos, size - pos, ".%lu", ids[i]);
+}
+
+/* DER TLV 하나. 길이는 최소 표현이어야 한다 (X.690 10.1) */
+static int tlv(const unsigned char **p, const unsigned char *end, unsigned char *tag,
+               const unsigned char **val, size_t *len) {
+    if (end - *p < 2)
+        return -1;
+    *tag = *(*p)++;
+    size_t l = *(*p)++;
+    if (l == 0x80 || l == 0xff)
+        return -1;
+    if (l & 0x80) {
+        int n = l & 0x7f;
+        if (n > 2 || end - *p < n || **p == 0)
+            return -1;
+        for (l = 0; n > 0; n--)
+            l = (l << 8) | *(*p)++;
+        if (l < 0x80)
+            return -1;
+    }
+    if ((size_t)(end - *p) < l)
+        return -1;
+    *val = *p;
+    *len = l;
+    *p += l;
+    return 0;
+}
+
+/* 음이 아닌 정수만 받는다. 앞에 쓸데없는 0x00이 있으면 DER 위반 */
+static int der_unsigned(const unsigned char *v, size_t len, unsigned long *out) {
+    if (len == 0 || len > 5 || (v[0] & 0x80))
+        return -1;
+    if (len > 1 && v[0] == 0 && !(v[1] & 0x80))
+        return -1;
+    if (len == 5 && v[0] != 0)
+        return -1;
+    *out = 0;
+    for (size_t i = 0; i < len; i++)
+        *out = (*out << 8) | v[i];
+    return 0;
+}
+
+static int der_oid(const unsigned char *v, size_t len, char *out, size_t size) {
+    unsigned long ids[128];
+    size_t n = 0;
+    unsigned long cur = 0;
+    if (len == 0)
+        return -1;
+    for (size_t i = 0; i < len; i++) {
+        if (cur == 0 && v[i] == 0x80)
+            return -1;
+        cur = (cur << 7) | (v[i] & 0x7f);
+        if (v[i] & 0x80)
+            continue;
+        if (n == 0) {
+            ids[n++] = cur < 80 ? cur / 40 : 2;
+            ids[n++] = cur - ids[0] * 40;
+        } else if (n < 128) {
+            ids[n++] = cur;
+        } else {
+            return -1;
+        }
+        cur = 0;
+    }
+    if (v[len - 1] & 0x80)
+        return -1;
+    oid_str(ids, n, out, size);
+    return 0;
+}
+
+static int der_decode(const unsigned char *buf, size_t len, msg_t *m) {
+    const unsigned char *p = buf, *end = buf + len, *v, *pdu_end, *list_end;
+    unsigned char tag;
+    size_t l;
+    unsigned long num;
+
+    memset(m, 0, sizeof(*m));
+    if (tlv(&p, end, &tag, &v, &l) != 0 || tag != BER_SEQUENCE || p != end)
+        return -1;
+    p = v;
+    if (tlv(&p, end, &tag, &v, &l) != 0 || tag != BER_INTEGER || der_unsigned(v, l, &num) != 0)
+        return -1;
+    m->version = num;
+    if (tlv(&p, end, &tag, &v, &l) != 0 || tag != BER_OCTET_STR || l >= sizeof(m->community))
+        return -1;
+    memcpy(m->community, v, l);
+    if (tlv(&p, end, &tag, &v, &l) != 0 || p != end)
+        return -1;
+    m->pdu = tag;
+    p = v;
+    pdu_end = v + l;
+    long *fields[] = { &m->reqid, &m->errstat, &m->errindex };
+    for (int i = 0; i < 3; i++) {
+        if (tlv(&p, pdu_end, &tag, &v, &l) != 0 || tag != BER_INTEGER || der_unsigned(v, l, &num) != 0)
+            return -1;
+        *fields[i] = num;
+    }
+    if (tlv(&p, pdu_end, &tag, &v, &l) != 0 || tag != BER_SEQUENCE || p != pdu_end)
+        return -1;
+    p = v;
+    list_end = v + l;
+    while (p < list_end) {
+        const unsigned char *vb_end;
+        if (m->count >= MAX_VBS || tlv(&p, list_end, &tag, &v, &l) != 0 || tag != BER_SEQUENCE)
+            return -1;
+        vb_t *vb = &m->vbs[m->count++];
+        const unsigned char *q = v;
+        vb_end = v + l;
+        if (tlv(&q, vb_end, &tag, &v, &l) != 0 || tag != BER_OID ||
+            der_oid(v, l, vb->oid, sizeof(vb->oid)) != 0)
+            return -1;
+        if (tlv(&q, vb_end, &tag, &v, &l) != 0 || q != vb_end)
+            return -1;
+        vb->type = tag;
+        if (tag == BER_INTEGER || tag == BER_GAUGE32 || tag == BER_TIMETICKS) {
+            if (der_unsigned(v, l, &vb->num) != 0 || vb->num > 0xffffffffUL)
+                return -1;
+        } else if (tag == BER_OID) {
+            if (der_oid(v, l, vb->str, sizeof(vb->str)) != 0)
+                return -1;
+            vb->str_len = strlen(vb->str);
+        } else if (tag == BER_OCTET_STR) {
+            if (l >= sizeof(vb->str))
+                return -1;
+            memcpy(vb->str, v, l);
+            vb->str_len = l;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+#ifdef USE_NETSNMP
+static void netsnmp_oid_str(const oid *name, size_t n, char *out, size_t size) {
+    unsigned long ids[MAX_OID_LEN];
+    for (size_t i = 0; i < n && i < MAX_OID_LEN; i++)
+        ids[i] = name[i];
+    oid_str(ids, n < MAX_OID_LEN ? n : MAX_OID_LEN, out, size);
+}
+
+/* 같은 메시지를 net-snmp의 ASN.1/PDU 파서로 푼다 */
+static int netsnmp_decode(const unsigned char *buf, size_t len, msg_t *m) {
+    u_char copy[8192];
+    u_char *data = copy;
+    size_t left = len;
+    u_char type;
+
+    memset(m, 0, sizeof(*m));
+    if (len > sizeof(copy))
+        return -1;
+    memcpy(copy, buf, len);
+    data = asn_parse_sequence(data, &left, &type, ASN_SEQUENCE | ASN_CONSTRUCTOR, "message");
+    if (!data)
+        return -1;
+    data = asn_parse_int(data, &left, &type, &m->version, sizeof(m->version));
+    if (!data)
+        return -1;
+    size_t community_len = sizeof(m->community) - 1;
+    data = asn_parse_string(data, &left, &type, (u_char *)m->community, &community_len);
+    if (!data)
+        return -1;
+    m->community[community_len] = '\0';
+
+    netsnmp_pdu *pdu = snmp_pdu_create(0);
+    pdu->version = SNMP_VERSION_2c;
+    if (snmp_pdu_parse(pdu, data, &left) != 0) {
+        snmp_free_pdu(pdu);
+        return -1;
+    }
+    m->pdu = pdu->command;
+    m->reqid = pdu->reqid;
+    m->errstat = pdu->errstat;
+    m->errindex = pdu->errindex;
+    for (netsnmp_variable_list *var = pdu->variables; var && m->count < MAX_VBS; var = var->next_variable) {
+        vb_t *vb = &m->vbs[m->count++];
+        netsnmp_oid_str(var->name, var->name_length, vb->oid, sizeof(vb->oid));
+        vb->type = var->type;
+        if (var->type == ASN_OBJECT_ID) {
+            netsnmp_oid_str(var->val.objid, var->val_len / sizeof(oid), vb->str, sizeof(vb->str));
+            vb->str_len = strlen(vb->str);
+        } else if (var->type == ASN_OCTET_STR) {
+            vb->str_len = var->val_len < sizeof(vb->str) - 1 ? var->val_len : sizeof(vb->str) - 1;
+            memcpy(vb->str, var->val.string, vb->str_len);
+        } else {
+            vb->num = (unsigned long)*var->val.integer & 0xffffffffUL;
+        }
+    }
+    snmp_free_pdu(pdu);
+    return 0;
+}
+#endif
+
+/* 디코더마다 돌려 본다 */
+typedef int (*decoder_fn)(const unsigned char *buf, size_t len, msg_t *m);
+static const struct { const char *name; decoder_fn fn; } decoders[] = {
+    { "der", der_decode },
+#ifdef USE_NETSNMP
+    { "net-snmp", netsnmp_decode },
+#endif
+};
+#define DECODERS (int)(sizeof(decoders) / sizeof(decoders[0]))
+
+static void check_oid(const char *str, const unsigned char *ber, size_t len) {
+    BerOid oid;
+    CHECK_INT(ber_oid_encode(str, &oid), 0);
+    CHECK_INT(oid.len, len);
+    CHECK(memcmp(oid.ber, ber, len) == 0);
+}
+
+static void test_oid_encode(void) {
+    BerOid oid;
+    char back[160];
+
+    check_oid(".1.3.6.1.2.1.1.3.0", ber_oid_sysuptime.ber, ber_oid_sysuptime.len);
+    check_oid("1.3.6.1.6.3.1.1.4.1.0", ber_oid_snmptrapoid.ber, ber_oid_snmptrapoid.len);
+    check_oid(".1.3.4294967295", (const unsigned char []){ 0x2b, 0x8f, 0xff, 0xff, 0xff, 0x7f }, 6);
+    check_oid(".2.100.3", (const unsigned char []){ 0x81, 0x34, 0x03 }, 3);
+
+    /* 알람 OID 접두어는 미리 인코딩한 값을 쓴다. 일반 경로와 같은 결과여야 한다 */
+    const char *alarm_oids[] = { ".1.3.6.1.4.1.8072.2.3.0", ".1.3.6.1.4.1.8072.2.3.0.15.3",
+                                 ".1.3.6.1.4.1.8072.2.3.0.200000" };
+    for (size_t i = 0; i < sizeof(alarm_oids) / sizeof(alarm_oids[0]); i++) {
+        CHECK_INT(ber_oid_encode(alarm_oids[i], &oid), 0);
+        CHECK_INT(der_oid(oid.ber, oid.len, back, sizeof(back)), 0);
+        CHECK_STR(back, alarm_oids[i]);
+    }
+    CHECK_INT(ber_oid_encode(".1.3.6.1.4.1.8072.2.3.00", &oid), 0);
+    CHECK_INT(der_oid(oid.ber, oid.len, back, sizeof(back)), 0);
+    CHECK_STR(back, ".1.3.6.1.4.1.8072.2.3.0");
+
+    CHECK_INT(ber_oid_encode("", &oid), -1);
+    CHECK_INT(ber_oid_encode("sysUpTime.0", &oid), -1);
+    CHECK_INT(ber_oid_encode(".1.40", &oid), -1);
+    CHECK_INT(ber_oid_encode(".3.1", &oid), -1);
+    CHECK_INT(ber_oid_encode(".1.3..6", &oid), -1);
+    CHECK_INT(ber_oid_encode(".1.3.6x", &oid), -1);
+
+    /* 64바이트를 넘는 OID */
+    char longoid[256] = ".1.3";
+    for (int i = 0; i < 70; i++)
+        strcat(longoid, ".1");
+    CHECK_INT(ber_oid_encode(longoid, &oid), -1);
+}
+
+/* sysUpTime.0 = 0 하나만 담은 Trap2를 손으로 인코딩한 바이트와 비교한다 */
+static void test_golden_trap(void) {
+    static const unsigned char golden[] = {
+        0x30, 0x27, 0x02, 0x01, 0x01, 0x04, 0x06, 'p', 'u', 'b', 'l', 'i', 'c',
+        0xa7, 0x1a, 0x02, 0x01, 0x01, 0x02, 0x01, 0x00, 0x02, 0x01, 0x00,
+        0x30, 0x0f, 0x30, 0x0d, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x02, 0x01, 0x01, 0x03, 0x00,
+        0x43, 0x01, 0x00,
+    };
+    BerVarbind vb = { &ber_oid_sysuptime, BER_TIMETICKS, 0, NULL, 0 };
+    unsigned char buf[sizeof(golden)];
+    unsigned char *packet;
+
+    long n = snmp_encode_notification(buf, sizeof(buf), SNMP_PDU_TRAP2, "public", 1, &vb, 1, &packet);
+    CHECK_INT(n, sizeof(golden));
+    CHECK(n == sizeof(golden) && packet == buf && memcmp(packet, golden, n) == 0);
+
+    /* 한 바이트라도 모자라면 실패 */
+    CHECK_INT(snmp_encode_notification(buf, sizeof(buf) - 1, SNMP_PDU_TRAP2, "public", 1, &vb, 1, &packet), -1);
+}
+
+/* trapq가 만드는 모양의 알림: sysUpTime, snmpTrapOID, 알람 메시지와 측정값들 */
+static void test_notification(int pdu_type) {
+    BerOid trap_oid, msg_oid, value_oid, limit_oid, long_oid;
+    char long_msg[300];
+    unsigned char buf[4096];
+    unsigned char *packet;
+    msg_t m;
+
+    ber_oid_encode(".1.3.6.1.4.1.8072.2.3.0.30", &trap_oid);
+    ber_oid_encode(".1.3.6.1.4.1.8072.2.3.0.15", &msg_oid);
+    ber_oid_encode(".1.3.6.1.4.1.8072.2.3.0.15.1", &value_oid);
+    ber_oid_encode(".1.3.6.1.4.1.8072.2.3.0.15.2", &limit_oid);
+    ber_oid_encode(".1.3.6.1.4.1.8072.2.3.0.15.3", &long_oid);
+    memset(long_msg, 'x', sizeof(long_msg));
+
+    const char *msg = "Filesystem read-only alarm triggered";
+    BerVarbind vbs[] = {
+        { &ber_oid_sysuptime, BER_TIMETICKS, 4294967295UL, NULL, 0 },
+        { &ber_oid_snmptrapoid, BER_OID, 0, trap_oid.ber, trap_oid.len },
+        { &msg_oid, BER_OCTET_STR, 0, msg, strlen(msg) },
+        { &value_oid, BER_GAUGE32, 0x80000000UL, NULL, 0 },
+        { &limit_oid, BER_GAUGE32, 0, NULL, 0 },
+        { &long_oid, BER_OCTET_STR, 0, long_msg, sizeof(long_msg) },
+    };
+    int count = sizeof(vbs) / sizeof(vbs[0]);
+    long n = snmp_encode_notification(buf, sizeof(buf), pdu_type, "s3cret", 0x7fffffffL, vbs, count, &packet);
+    CHECK(n > 300);
+    if (n <= 0)
+        return;
+    CHECK(packet + n == buf + sizeof(buf));
+
+    for (int d = 0; d < DECODERS; d++) {
+        if (decoders[d].fn(packet, n, &m) != 0) {
+            fprintf(stderr, "%s decoder rejected the message\n", decoders[d].name);
+            CHECK(0);
+            continue;
+        }
+        CHECK_INT(m.version, 1);
+        CHECK_STR(m.community, "s3cret");
+        CHECK_INT(m.pdu, pdu_type);
+        CHECK_INT(m.reqid, 0x7fffffffL);
+        CHECK_INT(m.errstat, 0);
+        CHECK_INT(m.errindex, 0);
+        CHECK_INT(m.count, count);
+        if (m.count != count)
+            continue;
+        CHECK_STR(m.vbs[0].oid, ".1.3.6.1.2.1.1.3.0");
+        CHECK_INT(m.vbs[0].type, BER_TIMETICKS);
+        CHECK_INT(m.vbs[0].num, 4294967295UL);
+        CHECK_STR(m.vbs[1].oid, ".1.3.6.1.6.3.1.1.4.1.0");
+        CHECK_INT(m.vbs[1].type, BER_OID);
+        CHECK_STR(m.vbs[1].str, ".1.3.6.1.4.1.8072.2.3.0.30");
+        CHECK_STR(m.vbs[2].oid, ".1.3.6.1.4.1.8072.2.3.0.15");
+        CHECK_STR(m.vbs[2].str, msg);
+        CHECK_INT(m.vbs[3].type, BER_GAUGE32);
+        CHECK_INT(m.vbs[3].num, 0x80000000UL);
+        CHECK_INT(m.vbs[4].num, 0);
+        CHECK_STR(m.vbs[5].oid, ".1.3.6.1.4.1.8072.2.3.0.15.3");
+        CHECK_INT(m.vbs[5].str_len, sizeof(long_msg));
+    }
+}
+
+/* Inform 응답의 request-id. 인코더로 Response PDU를 만들어 되돌려 본다 */
+static void test_decode_response(void) {
+    static const long ids[] = { 0, 127, 128, 0x12345678L, 0x7fffffffL };
+    BerVarbind vb = { &ber_oid_sysuptime, BER_TIMETICKS, 1, NULL, 0 };
+    unsigned char buf[256];
+    unsigned char *packet;
+    long id;
+
+    for (size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+        long n = snmp_encode_notification(buf, sizeof(buf), SNMP_PDU_RESPONSE, "public", ids[i], &vb, 1, &packet);
+        id = -1;
+        CHECK_INT(snmp_decode_response(packet, n, &id), 0);
+        CHECK_INT(id, ids[i]);
+        CHECK_INT(snmp_decode_response(packet, 5, &id), -1);
+    }
+
+    /* 에이전트가 음수 request-id를 돌려줘도 부호를 지킨다 */
+    static const unsigned char negative[] = {
+        0x30, 0x17, 0x02, 0x01, 0x01, 0x04, 0x06, 'p', 'u', 'b', 'l', 'i', 'c',
+        0xa2, 0x0b, 0x02, 0x01, 0xff, 0x02, 0x01, 0x00, 0x02, 0x01, 0x00, 0x30, 0x00,
+    };
+    CHECK_INT(snmp_decode_response(negative, sizeof(negative), &id), 0);
+    CHECK_INT(id, -1);
+
+    /* Response가 아닌 PDU */
+    long n = snmp_encode_notification(buf, sizeof(buf), SNMP_PDU_TRAP2, "public", 7, &vb, 1, &packet);
+    CHECK_INT(snmp_decode_response(packet, n, &id), -1);
+}
+
+int main(void) {
+    test_oid_encode();
+    test_golden_trap();
+    test_notification(SNMP_PDU_TRAP2);
+    test_notification(SNMP_PDU_INFORM);
+    test_decode_response();
+    return check_done("test_snmpber");
+}
@@ -0,0 +1,111 @@
+/* storcli JSON 파서 검사: /call show all J의 VD/PD 표와 /call/eall/sall show all J의 오류 카운터 */
+
+#include "check.h"
+#include "storcli.h"
+
+static const RaidPd *find_pd(const RaidInfo *info, int adapter, int enclosure, int slot) {
+    for (int i = 0; i < info->pd_count; i++) {
+        const RaidPd *pd = &info->pds[i];
+        if (pd->adapter == adapter && pd->enclosure == enclosure && pd->slot == slot)
+            return pd;
+    }
+    return NULL;
+}
+
+/* 약어 상태를 MegaCli 표기로 바꾸고, DG 번호로 컨트롤러별 소속 VD를 찾는다 */
+static void test_show_all(void) {
+    RaidInfo info;
+    memset(&info, 0, sizeof(info));
+
+    CHECK_INT(storcli_parse(read_fixture("storcli_show_all.json", NULL), &info), 0);
+    CHECK_INT(info.adapter_count, 2);
+    CHECK_INT(info.vd_count, 3);
+    CHECK_INT(info.pd_count, 9);
+
+    CHECK_INT(info.vds[0].adapter, 0);
+    CHECK_INT(info.vds[0].id, 0);
+    CHECK_STR(info.vds[0].level, "1");
+    CHECK_STR(info.vds[0].state, "Optimal");
+    CHECK_INT(info.vds[1].id, 1);
+    CHECK_STR(info.vds[1].level, "5");
+    CHECK_STR(info.vds[1].state, "Degraded");
+    CHECK_INT(info.vds[2].adapter, 1);
+    CHECK_STR(info.vds[2].level, "0");
+
+    const RaidPd *pd = find_pd(&info, 0, 252, 1);
+    CHECK(pd != NULL);
+    if (pd) {
+        CHECK_INT(pd->vd, 0);
+        CHECK_STR(pd->state, "Online, Spun Up");
+    }
+    pd = find_pd(&info, 0, 252, 3);
+    CHECK(pd != NULL);
+    if (pd) {
+        CHECK_INT(pd->vd, 1);
+        CHECK_STR(pd->state, "Rebuild");
+    }
+    pd = find_pd(&info, 0, 252, 5);
+    CHECK(pd != NULL);
+    if (pd) {
+        CHECK_INT(pd->vd, -1);
+        CHECK_STR(pd->state, "Unconfigured(bad)");
+    }
+    pd = find_pd(&info, 0, 252, 6);
+    CHECK(pd != NULL);
+    if (pd) {
+        CHECK_INT(pd->vd, -1);
+        CHECK_STR(pd->state, "Hotspare, Spun Up");
+    }
+
+    /* 두 번째 컨트롤러의 DG 0은 그 컨트롤러의 VD에만 매핑된다 */
+    pd = find_pd(&info, 1, 8, 0);
+    CHECK(pd != NULL && pd->vd == 0);
+    /* 인클로저 없는 " :1" */
+    pd = find_pd(&info, 1, -1, 1);
+    CHECK(pd != NULL);
+    if (pd) {
+        CHECK_INT(pd->vd, -1);
+        CHECK_STR(pd->state, "JBOD");
+    }
+}
+
+/* 드라이브 상세는 이미 있는 PD의 오류 카운터만 채운다 ("State" 객체 밖의 같은 키는 무시) */
+static void test_drive_details(void) {
+    RaidInfo info;
+    memset(&info, 0, sizeof(info));
+
+    CHECK_INT(storcli_parse(read_fixture("storcli_show_all.json", NULL), &info), 0);
+    CHECK_INT(storcli_parse(read_fixture("storcli_drives_show_all.json", NULL), &info), 0);
+    CHECK_INT(info.pd_count, 9);
+    CHECK_INT(info.vd_count, 3);
+
+    const RaidPd *pd = find_pd(&info, 0, 252, 0);
+    CHECK(pd != NULL && pd->media_errors == 0 && pd->other_errors == 0);
+    pd = find_pd(&info, 0, 252, 1);
+    CHECK(pd != NULL);
+    if (pd) {
+        CHECK_INT(pd->media_errors, 12);
+        CHECK_INT(pd->other_errors, 3);
+        CHECK_INT(pd->predictive_failures, 0);
+    }
+    pd = find_pd(&info, 0, 252, 2);
+    CHECK(pd != NULL && pd->predictive_failures == 2);
+    pd = find_pd(&info, 0, 252, 3);
+    CHECK(pd != NULL && pd->media_errors == 41);
+    pd = find_pd(&info, 0, 252, 9);
+    CHECK(pd == NULL);
+}
+
+static void test_syntax_error(void) {
+    RaidInfo info;
+    char truncated[] = "{ \"Controllers\": [ { \"Command Status\": { \"Controller\": 0 ";
+    memset(&info, 0, sizeof(info));
+    CHECK_INT(storcli_parse(truncated, &info), -1);
+}
+
+int main(void) {
+    test_show_all();
+    test_drive_details();
+    test_syntax_error();
+    return check_done("test_storcli");
+}
@@ -0,0 +1,647 @@
+#include "trapq.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <syslog.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "snmpber.h"
+
+/* make USE_NETSNMP=1: PDU 인코딩을 net-snmp로 한다 (전송은 어느 쪽이든 직접 한다) */
+#ifdef USE_NETSNMP
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#endif
+
+/* 여러 알람을 한 PDU로 묶어 보낼 때의 snmpTrapOID (알람이 하나면 그 알람의 OID) */
+#define ALARM_BATCH_OID ".1.3.6.1.4.1.8072.2.3.0.30"
+
+#define TRAPQ_SIZE 32                 /* 2의 거듭제곱 */
+#define MAX_TRAP_DESTS 8
+#define MAX_RATE_OIDS 64
+#define TRAP_PACKET_MAX 8192
+/* 주소를 찾지 못한 대상은 이 간격(초)으로 다시 찾는다 */
+#define RESOLVE_RETRY 60
+/* Inform 응답 대기 (ms)와 재전송 횟수 */
+#define INFORM_TIMEOUT_MS 1000
+#define INFORM_RETRIES 2
+
+#ifdef USE_NETSNMP
+/* SNMPv2 트랩의 첫 두 varbind: sysUpTime.0, snmpTrapOID.0 */
+static oid sysuptime_oid[] = { 1, 3, 6, 1, 2, 1, 1, 3, 0 };
+static oid snmptrapoid_oid[] = { 1, 3, 6, 1, 6, 3, 1, 1, 4, 1, 0 };
+#endif
+
+/* 큐 항목 하나가 PDU 하나 (보고 주기 하나의 알람 묶음) */
+typedef struct {
+    int count;
+    long long queued_us;
+    TrapAlarm alarms[TRAP_BATCH_MAX];
+} trapq_item_t;
+
+/* 칸마다 순번을 두는 고정 크기 링 (여러 생산자/소비자, 잠금 없음).
+   seq == pos 이면 비어 있어 쓸 수 있고, seq == pos + 1 이면 읽을 수 있다 */
+typedef struct {
+    size_t seq;
+    trapq_item_t item;
+} trapq_cell_t;
+
+static trapq_cell_t ring[TRAPQ_SIZE];
+static size_t enqueue_pos;
+static size_t dequeue_pos;
+static sem_t ready;                   /* 넣은 항목 수 + 설정 변경 알림 */
+static int started;
+static unsigned reload_gen;
+
+/* 자체 지표. 여러 스레드에서 __atomic으로 갱신 */
+static unsigned long stat_queued, stat_sent, stat_dropped_full, stat_dropped_rate, stat_send_errors;
+static int stat_dests;
+static long long stat_latency_last_us, stat_latency_max_us;
+
+/* 송신 스레드가 쓰는 트랩 설정. 메인 스레드가 trapq_reload()로 바꾸고
+   송신 스레드는 reload_gen이 바뀌면 settings_lock 아래에서 자기 사본(settings)으로 옮긴다 */
+typedef struct {
+    int enable;
+    char dest[sizeof(global_config.snmp_trap_dest)];
+    int port;
+    char community[sizeof(global_config.snmp_trap_community)];
+    char type[sizeof(global_config.snmp_trap_type)];
+    int rate, burst;
+} trap_settings_t;
+
+static pthread_mutex_t settings_lock = PTHREAD_MUTEX_INITIALIZER;
+static trap_settings_t new_settings;
+
+/* 이하 송신 스레드 전용 */
+static trap_settings_t settings;
+
+typedef struct {
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+} trap_dest_t;
+
+static trap_dest_t dests[MAX_TRAP_DESTS];
+static int dest_count;
+static int unresolved;
+static time_t resolve_retry_at;
+static int sock4 = -1, sock6 = -1;
+static int pdu_type = SNMP_PDU_TRAP2;
+static long request_id;
+static unsigned char *packet_buf;
+static size_t packet_buf_size;
+static unsigned char response_buf[TRAP_PACKET_MAX];
+static long long start_us;
+#ifdef USE_NETSNMP
+static netsnmp_session encode_session;
+#endif
+
+/* OID별 토큰 버킷: 시간당 SNMP_TRAP_RATE개씩 채우고 SNMP_TRAP_BURST개까지 모은다.
+   발생/해제/단계 상승은 한 번만 보내므로 제한하지 않고 반복 알림과 이벤트 알람에만 쓴다 */
+typedef struct {
+    char oid[64];
+    double tokens;
+    long long last_us;
+} rate_bucket_t;
+
+static rate_bucket_t buckets[MAX_RATE_OIDS];
+static int bucket_count;
+
+static long long monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int ring_push(const TrapAlarm *alarms, int count) {
+    size_t pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        trapq_cell_t *cell = &ring[pos & (TRAPQ_SIZE - 1)];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        long diff = (long)seq - (long)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&enqueue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                cell->item.count = count;
+                cell->item.queued_us = monotonic_us();
+                memcpy(cell->item.alarms, alarms, count * sizeof(TrapAlarm));
+                __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1;                /* 가득 참 */
+        } else {
+            pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static int ring_pop(trapq_item_t *item) {
+    size_t pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        trapq_cell_t *cell = &ring[pos & (TRAPQ_SIZE - 1)];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        long diff = (long)seq - (long)(pos + 1);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&dequeue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *item = cell->item;
+                __atomic_store_n(&cell->seq, pos + TRAPQ_SIZE, __ATOMIC_RELEASE);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1;                /* 비어 있음 */
+        } else {
+            pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/* "host", "host:port", "[v6]:port" 하나의 주소를 찾는다 */
+static int resolve_one(char *entry, trap_dest_t *dest) {
+    char port[16];
+    char *host = entry;
+    char *colon;
+
+    snprintf(port, sizeof(port), "%d", settings.port);
+    if (host[0] == '[') {
+        host++;
+        char *end = strchr(host, ']');
+        if (!end)
+            return -1;
+        *end = '\0';
+        if (end[1] == ':')
+            snprintf(port, sizeof(port), "%s", end + 2);
+    } else if ((colon = strchr(host, ':')) != NULL && strchr(colon + 1, ':') == NULL) {
+        *colon = '\0';
+        snprintf(port, sizeof(port), "%s", colon + 1);
+    }
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    int err = getaddrinfo(host, port, &hints, &res);
+    if (err != 0) {
+        syslog(LOG_ERR, "SNMP trap destination %s: %s", host, gai_strerror(err));
+        return -1;
+    }
+    memcpy(&dest->addr, res->ai_addr, res->ai_addrlen);
+    dest->addr_len = res->ai_addrlen;
+    freeaddrinfo(res);
+    return 0;
+}
+
+/* SNMP_TRAP_DEST(쉼표 구분) 주소를 찾는다. 시작할 때와 설정을 다시 읽을 때만 한다 */
+static void resolve_destinations(void) {
+    char list[sizeof(settings.dest)];
+    char *save = NULL;
+
+    snprintf(list, sizeof(list), "%s", settings.dest);
+    dest_count = 0;
+    unresolved = 0;
+    if (settings.enable == 1) {
+        for (char *tok = strtok_r(list, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+            while (*tok == ' ')
+                tok++;
+            tok[strcspn(tok, " ")] = '\0';
+            if (*tok == '\0')
+                continue;
+            if (dest_count >= MAX_TRAP_DESTS) {
+                syslog(LOG_WARNING, "Too many SNMP trap destinations, ignoring %s", tok);
+                continue;
+            }
+            if (resolve_one(tok, &dests[dest_count]) == 0)
+                dest_count++;
+            else
+                unresolved++;
+        }
+    }
+    resolve_retry_at = time(NULL) + RESOLVE_RETRY;
+    __atomic_store_n(&stat_dests, dest_count, __ATOMIC_RELAXED);
+    pdu_type = (strcmp(settings.type, "inform") == 0) ? SNMP_PDU_INFORM : SNMP_PDU_TRAP2;
+
+#ifdef USE_NETSNMP
+    /* PDU 인코딩용 세션 정보. 열지 않고 snmp_build()에만 쓴다 */
+    snmp_sess_init(&encode_session);
+    encode_session.version = SNMP_VERSION_2c;
+    encode_session.community = (u_char *)settings.community;
+    encode_session.community_len = strlen(settings.community);
+#endif
+}
+
+static int family_socket(int family) {
+    int *sock = (family == AF_INET6) ? &sock6 : &sock4;
+    if (*sock < 0) {
+        *sock = socket(family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (*sock < 0)
+            syslog(LOG_ERR, "SNMP trap socket: %s", strerror(errno));
+    }
+    return *sock;
+}
+
+static int rate_allow(const char *trap_oid, long long now) {
+    double rate = settings.rate;
+    double burst = (settings.burst > 0) ? settings.burst : 1;
+    if (rate <= 0)
+        return 1;
+
+    rate_bucket_t *b = NULL;
+    for (int i = 0; i < bucket_count; i++) {
+        if (strcmp(buckets[i].oid, trap_oid) == 0) {
+            b = &buckets[i];
+            break;
+        }
+    }
+    if (!b) {
+        if (bucket_count >= MAX_RATE_OIDS)
+            return 1;
+        b = &buckets[bucket_count++];
+        snprintf(b->oid, sizeof(b->oid), "%s", trap_oid);
+        b->tokens = burst;
+        b->last_us = now;
+    }
+    b->tokens += (now - b->last_us) / 3600e6 * rate;
+    if (b->tokens > burst)
+        b->tokens = burst;
+    b->last_us = now;
+    if (b->tokens < 1)
+        return 0;
+    b->tokens -= 1;
+    return 1;
+}
+
+#ifdef USE_NETSNMP
+/* 알람들로 PDU를 만들어 net-snmp로 인코딩한다. 길이, 실패하면 -1 */
+static long encode_trap(const TrapAlarm *const *alarms, int count, long long now, unsigned char **packet) {
+    struct snmp_pdu *pdu = snmp_pdu_create(pdu_type == SNMP_PDU_INFORM ? SNMP_MSG_INFORM : SNMP_MSG_TRAP2);
+    pdu->reqid = request_id;
+    u_long uptime = (u_long)((now - start_us) / 10000);
+    snmp_pdu_add_variable(pdu, sysuptime_oid, sizeof(sysuptime_oid) / sizeof(oid),
+                          ASN_TIMETICKS, &uptime, sizeof(uptime));
+
+    oid objid[MAX_OID_LEN];
+    size_t objid_len = MAX_OID_LEN;
+    const char *trap_oid = (count == 1) ? alarms[0]->oid : ALARM_BATCH_OID;
+    if (!snmp_parse_oid(trap_oid, objid, &objid_len)) {
+        snmp_perror(trap_oid);
+        snmp_free_pdu(pdu);
+        return -1;
+    }
+    snmp_pdu_add_variable(pdu, snmptrapoid_oid, sizeof(snmptrapoid_oid) / sizeof(oid),
+                          ASN_OBJECT_ID, objid, objid_len * sizeof(oid));
+
+    /* 알람마다 <OID> = 메시지, <OID>.1 = 측정값, <OID>.2 = 넘은 임계치,
+       <OID>.3 = 알람 ID, <OID>.4 = 상태, <OID>.5 = 단계 */
+    for (int i = 0; i < count; i++) {
+        const TrapAlarm *t = alarms[i];
+        objid_len = MAX_OID_LEN - 1;
+        if (!snmp_parse_oid(t->oid, objid, &objid_len)) {
+            snmp_perror(t->oid);
+            continue;
+        }
+        snmp_pdu_add_variable(pdu, objid, objid_len, ASN_OCTET_STR, t->message, strlen(t->message));
+        if (t->type == TRAP_VALUE_GAUGE) {
+            objid[objid_len] = 1;
+            snmp_pdu_add_variable(pdu, objid, objid_len + 1, ASN_GAUGE, &t->value, sizeof(t->value));
+            objid[objid_len] = 2;
+            snmp_pdu_add_variable(pdu, objid, objid_len + 1, ASN_GAUGE, &t->threshold, sizeof(t->threshold));
+        } else if (t->type == TRAP_VALUE_STRING) {
+            objid[objid_len] = 1;
+            snmp_pdu_add_variable(pdu, objid, objid_len + 1, ASN_OCTET_STR, t->value_str, strlen(t->value_str));
+            objid[objid_len] = 2;
+            snmp_pdu_add_variable(pdu, objid, objid_len + 1, ASN_OCTET_STR, t->threshold_str, strlen(t->threshold_str));
+        }
+        if (t->alarm_id != 0) {
+            objid[objid_len] = 3;
+            snmp_pdu_add_variable(pdu, objid, objid_len + 1, ASN_GAUGE, &t->alarm_id, sizeof(t->alarm_id));
+            objid[objid_len] = 4;
+            snmp_pdu_add_variable(pdu, objid, objid_len + 1, ASN_OCTET_STR, t->alarm_state, strlen(t->alarm_state));
+            objid[objid_len] = 5;
+            snmp_pdu_add_variable(pdu, objid, objid_len + 1, ASN_OCTET_STR, t->severity, strlen(t->severity));
+        }
+    }
+
+    /* 앞에서부터 인코딩하면 패킷이 버퍼 처음에 놓이고 offset이 길이가 된다 */
+    size_t buf_len = packet_buf_size, offset = 0;
+    pdu->flags |= UCD_MSG_FLAG_FORWARD_ENCODE;
+    int rc = snmp_build(&packet_buf, &buf_len, &offset, &encode_session, pdu);
+    snmp_free_pdu(pdu);
+    if (rc != 0)
+        return -1;
+    *packet = packet_buf;
+    return (long)offset;
+}
+#else
+/* 알람들로 PDU를 만들어 내장 인코더로 BER 인코딩한다. 길이, 실패하면 -1 */
+static long encode_trap(const TrapAlarm *const *alarms, int count, long long now, unsigned char **packet) {
+    static BerOid trap_oid, names[TRAP_BATCH_MAX][6];
+    BerVarbind vbs[2 + TRAP_BATCH_MAX * 6];
+    int n = 0;
+
+    memset(vbs, 0, sizeof(vbs));
+    vbs[n].name = &ber_oid_sysuptime;
+    vbs[n].type = BER_TIMETICKS;
+    vbs[n++].num = (unsigned long)((now - start_us) / 10000);
+    if (ber_oid_encode((count == 1) ? alarms[0]->oid : ALARM_BATCH_OID, &trap_oid) != 0)
+        return -1;
+    vbs[n].name = &ber_oid_snmptrapoid;
+    vbs[n].type = BER_OID;
+    vbs[n].value = trap_oid.ber;
+    vbs[n++].value_len = trap_oid.len;
+
+    /* 알람마다 <OID> = 메시지, <OID>.1 = 측정값, <OID>.2 = 넘은 임계치,
+       <OID>.3 = 알람 ID, <OID>.4 = 상태, <OID>.5 = 단계 */
+    for (int i = 0; i < count; i++) {
+        const TrapAlarm *t = alarms[i];
+        if (ber_oid_encode(t->oid, &names[i][0]) != 0) {
+            syslog(LOG_ERR, "Invalid trap OID %s", t->oid);
+            continue;
+        }
+        vbs[n].name = &names[i][0];
+        vbs[n].type = BER_OCTET_STR;
+        vbs[n].value = t->message;
+        vbs[n++].value_len = strlen(t->message);
+        for (int k = 1; k <= 5; k++) {
+            if ((k <= 2 && t->type == TRAP_VALUE_NONE) || (k > 2 && t->alarm_id == 0))
+                continue;
+            names[i][k] = names[i][0];
+            ber_oid_append(&names[i][k], k);
+            vbs[n].name = &names[i][k];
+            if (k == 3) {
+                vbs[n].type = BER_GAUGE32;
+                vbs[n].num = t->alarm_id;
+            } else if (k >= 4) {
+                vbs[n].type = BER_OCTET_STR;
+                vbs[n].value = (k == 4) ? t->alarm_state : t->severity;
+                vbs[n].value_len = strlen(vbs[n].value);
+            } else if (t->type == TRAP_VALUE_GAUGE) {
+                vbs[n].type = BER_GAUGE32;
+                vbs[n].num = (k == 1) ? t->value : t->threshold;
+            } else {
+                vbs[n].type = BER_OCTET_STR;
+                vbs[n].value = (k == 1) ? t->value_str : t->threshold_str;
+                vbs[n].value_len = strlen(vbs[n].value);
+            }
+            n++;
+        }
+    }
+    return snmp_encode_notification(packet_buf, packet_buf_size, pdu_type, settings.community,
+                                    request_id, vbs, n, packet);
+}
+#endif
+
+/* want[i]가 설정된 대상에 주소 체계별로 sendmmsg() 한 번씩 보낸다. 보낸 대상 수 */
+static int send_to(const unsigned char *packet, long len, const int *want) {
+    struct mmsghdr msgs[MAX_TRAP_DESTS];
+    struct iovec iov = { (void *)packet, (size_t)len };
+    static const int families[] = { AF_INET, AF_INET6 };
+    int delivered = 0;
+
+    for (int f = 0; f < 2; f++) {
+        int n = 0;
+        for (int i = 0; i < dest_count; i++) {
+            if (!want[i] || dests[i].addr.ss_family != families[f])
+                continue;
+            memset(&msgs[n], 0, sizeof(msgs[n]));
+            msgs[n].msg_hdr.msg_name = &dests[i].addr;
+            msgs[n].msg_hdr.msg_namelen = dests[i].addr_len;
+            msgs[n].msg_hdr.msg_iov = &iov;
+            msgs[n].msg_hdr.msg_iovlen = 1;
+            n++;
+        }
+        if (n == 0)
+            continue;
+        int sock = family_socket(families[f]);
+        int sent = (sock < 0) ? -1 : sendmmsg(sock, msgs, n, 0);
+        if (sent < n) {
+            __atomic_add_fetch(&stat_send_errors, n - (sent > 0 ? sent : 0), __ATOMIC_RELAXED);
+            syslog(LOG_ERR, "SNMP trap send failed for %d of %d destinations: %s",
+                   n - (sent > 0 ? sent : 0), n, strerror(errno));
+        }
+        if (sent > 0)
+            delivered += sent;
+    }
+    return delivered;
+}
+
+static int same_addr(const struct sockaddr_storage *a, const struct sockaddr_storage *b) {
+    if (a->ss_family != b->ss_family)
+        return 0;
+    if (a->ss_family == AF_INET) {
+        const struct sockaddr_in *x = (const void *)a, *y = (const void *)b;
+        return x->sin_port == y->sin_port && x->sin_addr.s_addr == y->sin_addr.s_addr;
+    }
+    const struct sockaddr_in6 *x = (const void *)a, *y = (const void *)b;
+    return x->sin6_port == y->sin6_port && memcmp(&x->sin6_addr, &y->sin6_addr, sizeof(x->sin6_addr)) == 0;
+}
+
+/* 받은 Response 중 이번 request-id에 대한 응답을 want[]에서 지운다. 남은 대상 수 */
+static int read_responses(int *want, int left) {
+    struct sockaddr_storage from;
+    int socks[2] = { sock4, sock6 };
+
+    for (int f = 0; f < 2; f++) {
+        if (socks[f] < 0)
+            continue;
+        for (;;) {
+            socklen_t from_len = sizeof(from);
+            ssize_t n = recvfrom(socks[f], response_buf, sizeof(response_buf), MSG_DONTWAIT,
+                                 (struct sockaddr *)&from, &from_len);
+            if (n < 0)
+                break;
+            long id;
+            if (snmp_decode_response(response_buf, n, &id) != 0 || id != request_id)
+                continue;
+            for (int i = 0; i < dest_count; i++) {
+                if (want[i] && same_addr(&dests[i].addr, &from)) {
+                    want[i] = 0;
+                    left--;
+                }
+            }
+        }
+    }
+    return left;
+}
+
+/* Trap2는 한 번 보내고, Inform은 모든 대상이 응답할 때까지 INFORM_RETRIES번 다시 보낸다.
+   받은(Inform이면 응답한) 대상 수 */
+static int send_to_all(const unsigned char *packet, long len) {
+    int want[MAX_TRAP_DESTS];
+    for (int i = 0; i < dest_count; i++)
+        want[i] = 1;
+    if (pdu_type != SNMP_PDU_INFORM)
+        return send_to(packet, len, want);
+
+    int left = dest_count;
+    for (int attempt = 0; attempt <= INFORM_RETRIES && left > 0; attempt++) {
+        send_to(packet, len, want);
+        long long deadline = monotonic_us() + INFORM_TIMEOUT_MS * 1000LL;
+        while (left > 0) {
+            long long remain = deadline - monotonic_us();
+            if (remain <= 0)
+                break;
+            struct pollfd pfds[2];
+            int nfds = 0;
+            if (sock4 >= 0)
+                pfds[nfds++] = (struct pollfd){ .fd = sock4, .events = POLLIN };
+            if (sock6 >= 0)
+                pfds[nfds++] = (struct pollfd){ .fd = sock6, .events = POLLIN };
+            if (poll(pfds, nfds, (int)(remain / 1000) + 1) < 0 && errno != EINTR)
+                break;
+            left = read_responses(want, left);
+        }
+    }
+    if (left > 0) {
+        __atomic_add_fetch(&stat_send_errors, left, __ATOMIC_RELAXED);
+        syslog(LOG_ERR, "SNMP inform not acknowledged by %d of %d destinations", left, dest_count);
+    }
+    return dest_count - left;
+}
+
+static void send_item(const trapq_item_t *item) {
+    long long now = monotonic_us();
+    const TrapAlarm *kept[TRAP_BATCH_MAX];
+    int count = 0;
+
+    for (int i = 0; i < item->count; i++) {
+        const TrapAlarm *t = &item->alarms[i];
+        int limited = (t->alarm_state == NULL || strcmp(t->alarm_state, "repeat") == 0);
+        if (!limited || rate_allow(t->oid, now))
+            kept[count++] = &item->alarms[i];
+        else
+            __atomic_add_fetch(&stat_dropped_rate, 1, __ATOMIC_RELAXED);
+    }
+    if (count == 0 || dest_count == 0)
+        return;
+
+    unsigned char *packet;
+    request_id = (request_id + 1) & 0x7fffffff;
+    long len = encode_trap(kept, count, now, &packet);
+    if (len < 0) {
+        syslog(LOG_ERR, "Failed to encode SNMP trap (%d alarms)", count);
+        __atomic_add_fetch(&stat_send_errors, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    if (send_to_all(packet, len) > 0)
+        __atomic_add_fetch(&stat_sent, 1, __ATOMIC_RELAXED);
+
+    long long latency = monotonic_us() - item->queued_us;
+    __atomic_store_n(&stat_latency_last_us, latency, __ATOMIC_RELAXED);
+    long long max = __atomic_load_n(&stat_latency_max_us, __ATOMIC_RELAXED);
+    while (latency > max &&
+           !__atomic_compare_exchange_n(&stat_latency_max_us, &max, latency, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static void take_settings(void) {
+    pthread_mutex_lock(&settings_lock);
+    settings = new_settings;
+    pthread_mutex_unlock(&settings_lock);
+}
+
+/* 큐에서 꺼내 보내는 송신 스레드. 주소 조회와 전송이 느려도 수집 루프는 기다리지 않는다 */
+static void *trapq_main(void *arg) {
+    static trapq_item_t item;
+    unsigned gen = __atomic_load_n(&reload_gen, __ATOMIC_ACQUIRE);
+    (void)arg;
+
+    take_settings();
+    resolve_destinations();
+    for (;;) {
+        while (sem_wait(&ready) != 0 && errno == EINTR)
+            ;
+        unsigned now_gen = __atomic_load_n(&reload_gen, __ATOMIC_ACQUIRE);
+        if (now_gen != gen) {
+            gen = now_gen;
+            take_settings();
+            resolve_destinations();
+        } else if (unresolved > 0 && time(NULL) >= resolve_retry_at) {
+            resolve_destinations();
+        }
+        if (ring_pop(&item) == 0)
+            send_item(&item);
+    }
+    return NULL;
+}
+
+/* 송신 스레드를 띄운다. SNMP_TRAP_ENABLE이 꺼져 있어도 띄워 두고 SIGHUP으로 켤 수 있다 */
+int trapq_init(const config_t *config) {
+    trapq_reload(config);
+    for (size_t i = 0; i < TRAPQ_SIZE; i++)
+        ring[i].seq = i;
+    packet_buf_size = TRAP_PACKET_MAX;
+    packet_buf = malloc(packet_buf_size);
+    if (!packet_buf || sem_init(&ready, 0, 0) != 0) {
+        syslog(LOG_ERR, "Failed to initialize SNMP trap queue");
+        return -1;
+    }
+    start_us = monotonic_us();
+    request_id = (long)((getpid() ^ time(NULL)) & 0x7fffffff);
+
+    pthread_t tid;
+    int err = pthread_create(&tid, NULL, trapq_main, NULL);
+    if (err != 0) {
+        syslog(LOG_ERR, "Failed to start SNMP trap sender: %s", strerror(err));
+        return -1;
+    }
+    pthread_detach(tid);
+    started = 1;
+    return 0;
+}
+
+/* 설정을 다시 읽은 뒤 호출: 트랩 설정을 복사해 두면 송신 스레드가 받아 대상 주소를 다시 찾는다 */
+void trapq_reload(const config_t *config) {
+    pthread_mutex_lock(&settings_lock);
+    new_settings.enable = config->snmp_trap_enable;
+    memcpy(new_settings.dest, config->snmp_trap_dest, sizeof(new_settings.dest));
+    new_settings.port = config->snmp_trap_port;
+    memcpy(new_settings.community, config->snmp_trap_community, sizeof(new_settings.community));
+    memcpy(new_settings.type, config->snmp_trap_type, sizeof(new_settings.type));
+    new_settings.rate = config->snmp_trap_rate;
+    new_settings.burst = config->snmp_trap_burst;
+    pthread_mutex_unlock(&settings_lock);
+
+    if (!started)
+        return;
+    __atomic_add_fetch(&reload_gen, 1, __ATOMIC_RELEASE);
+    sem_post(&ready);
+}
+
+/* 알람 묶음 하나를 PDU 하나로 큐에 넣는다. 가득 차면 버리고 센다 (막히지 않음) */
+int trapq_send(const TrapAlarm *alarms, int count) {
+    if (!started || count <= 0)
+        return -1;
+    if (count > TRAP_BATCH_MAX)
+        count = TRAP_BATCH_MAX;
+    if (ring_push(alarms, count) != 0) {
+        __atomic_add_fetch(&stat_dropped_full, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+    __atomic_add_fetch(&stat_queued, 1, __ATOMIC_RELAXED);
+    sem_post(&ready);
+    return 0;
+}
+
+void trapq_get_stats(TrapQueueStats *stats) {
+    size_t head = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+    size_t tail = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+    memset(stats, 0, sizeof(*stats));
+    stats->depth = (tail > head) ? (unsigned)(tail - head) : 0;
+    stats->queued = __atomic_load_n(&stat_queued, __ATOMIC_RELAXED);
+    stats->sent = __atomic_load_n(&stat_sent, __ATOMIC_RELAXED);
+    stats->dropped_full = __atomic_load_n(&stat_dropped_full, __ATOMIC_RELAXED);
+    stats->dropped_rate = __atomic_load_n(&stat_dropped_rate, __ATOMIC_RELAXED);
+    stats->send_errors = __atomic_load_n(&stat_send_errors, __ATOMIC_RELAXED);
+    stats->destinations = __atomic_load_n(&stat_dests, __ATOMIC_RELAXED);
+    stats->latency_last_ms = __atomic_load_n(&stat_latency_last_us, __ATOMIC_RELAXED) / 1000.0;
+    stats->latency_max_ms = __atomic_exchange_n(&stat_latency_max_us, 0, __ATOMIC_RELAXED) / 1000.0;
+}
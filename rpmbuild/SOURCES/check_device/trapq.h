@@ -0,0 +1,42 @@
+#ifndef TRAPQ_H
+#define TRAPQ_H
+
+#include "config.h"
+
+/* PDU 하나에 담는 알람 수. 알람마다 varbind 6개까지 (메시지, 값, 임계치, 알람 ID, 상태, 단계) */
+#define TRAP_BATCH_MAX 10
+
+/* 측정값과 임계치 varbind 형식 */
+enum { TRAP_VALUE_NONE = 0, TRAP_VALUE_GAUGE, TRAP_VALUE_STRING };
+
+/* 트랩에 싣는 알람 하나 */
+typedef struct {
+    char oid[64];                 /* 알람 OID (ALARM_RULE OID는 설정을 다시 읽으면 바뀌므로 복사) */
+    char message[128];
+    int type;                     /* TRAP_VALUE_* */
+    unsigned long value, threshold;
+    char value_str[64], threshold_str[64];
+    unsigned long alarm_id;       /* 발생/해제 트랩이 같은 값을 가진다. 0이면 ID 없는 이벤트 알람 */
+    const char *alarm_state;      /* "raised", "cleared", "repeat", "escalated" */
+    const char *severity;         /* "warning", "critical" */
+} TrapAlarm;
+
+/* 트랩 큐 자체 지표 (보고 주기마다 CSV로 기록) */
+typedef struct {
+    unsigned depth;               /* 보내기를 기다리는 PDU 수 */
+    unsigned long queued;         /* 누적 (PDU) */
+    unsigned long sent;
+    unsigned long dropped_full;   /* 큐가 가득 차서 버린 PDU */
+    unsigned long dropped_rate;   /* OID별 제한으로 버린 반복 알림, 이벤트 알람 */
+    unsigned long send_errors;
+    int destinations;             /* 주소를 찾은 트랩 대상 수 */
+    double latency_last_ms;       /* 넣은 뒤 보낼 때까지 */
+    double latency_max_ms;        /* 직전 조회 이후 최대 */
+} TrapQueueStats;
+
+int trapq_init(const config_t *config);
+void trapq_reload(const config_t *config);
+int trapq_send(const TrapAlarm *alarms, int count);
+void trapq_get_stats(TrapQueueStats *stats);
+
+#endif // TRAPQ_H
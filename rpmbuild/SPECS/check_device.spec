@@ -8,8 +8,8 @@ Group:          System Environment/Base
 URL:            http://example.com
 Source0:        %{name}-%{version}.tar.gz
 
-BuildRequires:  gcc, make, net-snmp-devel
-Requires:  net-snmp
+BuildRequires:  gcc, make, libcurl-devel
+Requires:  libcurl
 
 Provides:       libaxio.so.0()(64bit)
 
@@ -24,6 +24,9 @@ check_device is a daemon that logs the current date, time, CPU usage, and memory
 %build
 make
 
+%check
+make check
+
 %install
 rm -rf %{buildroot}
 # Install binary
@@ -42,6 +45,9 @@ install -m 0644 check_device.conf %{buildroot}/etc/check_device/check_device.con
 mkdir -p %{buildroot}/var/log/check_device
 chmod 0755 %{buildroot}/var/log/check_device
 
+# 상태 파일 디렉터리 (커널 로그 읽은 위치 등)
+mkdir -p %{buildroot}/var/lib/check_device
+
 # Install rsyslog configuration file to /etc/rsyslog.d
 mkdir -p %{buildroot}/etc/rsyslog.d
 install -m 0644 check_device_rsyslog.conf %{buildroot}/etc/rsyslog.d/check_device_rsyslog.conf
@@ -69,6 +75,8 @@ chmod 0755 /var/log/check_device
 /etc/systemd/system/check_device.service
 # Log directory
 %dir %attr(0755,root,root) /var/log/check_device
+# State directory
+%dir %attr(0755,root,root) /var/lib/check_device
 # Configure file
 %config(noreplace) /etc/check_device/check_device.conf
 # Rsyslog configuration file